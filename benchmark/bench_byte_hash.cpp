@@ -0,0 +1,87 @@
+#include <iostream>
+#include <vector>
+
+#include <tdc/hash/crc32.hpp>
+#include <tdc/hash/fnv32.hpp>
+#include <tdc/hash/mum64.hpp>
+
+#include <tdc/random/vector.hpp>
+#include <tdc/stat/phase.hpp>
+#include <tdc/stat/time.hpp>
+
+#include <tlx/cmdline_parser.hpp>
+
+using namespace tdc;
+
+struct {
+    size_t len = 1'048'576;
+    size_t total = 1'073'741'824;
+    uint64_t seed = random::DEFAULT_SEED;
+    std::string algo = "";
+
+    std::vector<Byte> buffer;
+} options;
+
+// hashes the buffer in chunks of the given length until the total number of bytes has been processed
+template<typename hash_func_t>
+void bench(const std::string& name, hash_func_t hash_func) {
+    if(options.algo.length() > 0 && options.algo != name) return;
+
+    stat::Phase result("");
+    result.log("len", options.len);
+    result.log("total", options.total);
+
+    const size_t num_chunks = options.buffer.size() / options.len;
+    const size_t reps = std::max(size_t(1), options.total / options.len);
+
+    uint64_t chk = 0;
+    const uint64_t t0 = stat::time_nanos();
+    for(size_t i = 0; i < reps; i++) {
+        chk += hash_func(options.buffer.data() + (i % num_chunks) * options.len, options.len);
+    }
+    const uint64_t dt = std::max(stat::time_nanos() - t0, uint64_t(1));
+
+    result.log("chk", chk);
+    result.log("gbps", (double)(reps * options.len) / (double)dt);
+
+    std::cout << "RESULT algo=" << name << " " << result.to_keyval() << std::endl;
+}
+
+int main(int argc, char** argv) {
+    tlx::CmdlineParser cp;
+
+    cp.add_bytes('l', "len", options.len, "the length of the hashed byte strings (default: 1 MiB)");
+    cp.add_bytes('t', "total", options.total, "the total number of bytes to hash (default: 1 GiB)");
+    cp.add_bytes('s', "seed", options.seed, "the random seed");
+    cp.add_string("algo", options.algo, "the single hash function to test");
+
+    if (!cp.process(argc, argv)) {
+        return -1;
+    }
+
+    if(options.len == 0) {
+        std::cerr << "the length must be positive" << std::endl;
+        return -1;
+    }
+
+    // strings are taken from a buffer of about 16 MiB, so long strings exceed the cache
+    {
+        const size_t num_chunks = std::max(size_t(1), size_t(16'777'216) / options.len);
+        options.buffer = random::vector<Byte>(num_chunks * options.len, 255, options.seed);
+    }
+
+    bench("fnv32", hash::FNV32());
+    bench("crc32", hash::CRC32());
+    bench("crc32c.table", [](const Byte* s, const size_t n){ return hash::CRC32C::update_table(0xFFFFFFFF, s, n); });
+    #ifdef __SSE4_2__
+    bench("crc32c.sse42", [](const Byte* s, const size_t n){ return hash::CRC32C::update_sse42(0xFFFFFFFF, s, n); });
+    bench("crc32c.interleaved", [](const Byte* s, const size_t n){ return hash::CRC32C::update_interleaved(0xFFFFFFFF, s, n); });
+    #endif
+    #if defined(__SSE4_2__) && defined(__PCLMUL__)
+    bench("crc32c.pclmul", [](const Byte* s, const size_t n){ return hash::CRC32C::update_pclmul(0xFFFFFFFF, s, n); });
+    #endif
+    bench("crc32c", hash::CRC32C());
+    bench("mum64", hash::Mum64());
+
+    return 0;
+}
@@ -1,8 +1,20 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include <tdc/hash/batch.hpp>
+#include <tdc/hash/concurrent_table.hpp>
 #include <tdc/hash/table.hpp>
+#include <tdc/hash/quotient_set.hpp>
+#include <tdc/hash/swiss_table.hpp>
 
 #include <tdc/hash/function.hpp>
 #include <tdc/hash/linear_probing.hpp>
@@ -10,7 +22,9 @@
 
 #include <tdc/random/permutation.hpp>
 #include <tdc/stat/phase.hpp>
+#include <tdc/stat/time.hpp>
 
+#include <robin_hood.h>
 #include <tlx/cmdline_parser.hpp>
 
 using namespace tdc;
@@ -21,9 +35,11 @@ struct {
     double growth_factor = 2.0;
     size_t num = 1'000;
     size_t num_queries = 100'000;
+    size_t num_churn = 0; // the number of keys replaced in the churn workload, defaults to num
     uint64_t universe = UINT32_MAX;
     uint64_t seed = random::DEFAULT_SEED;
     std::string ds = "";
+    size_t max_threads = 0; // the maximum number of threads for concurrent tables, zero to skip them
 
     random::Permutation keys;
     random::Permutation queries;
@@ -34,6 +50,7 @@ stat::Phase benchmark_phase(std::string&& title) {
     phase.log("num", options.num);
     phase.log("universe", options.universe);
     phase.log("queries", options.num_queries);
+    phase.log("churn", options.num_churn);
     phase.log("seed", options.seed);
     phase.log("capacity", options.capacity);
     phase.log("load_factor", options.load_factor);
@@ -94,11 +111,55 @@ void bench(const std::string& name, ctor_t ctor, diag_func_t diag) {
         result.log("chk", chk);
     }
 
+    // lookup random keys in batches
+    {
+        constexpr size_t batch_size = 1024;
+        std::vector<uint64_t> keys(batch_size);
+        std::vector<decltype(std::as_const(set).find(0))> results(batch_size);
+        
+        size_t chk = 0;
+        {
+            stat::Phase phase("lookup_rnd_batch");
+            for(size_t i = 0; i < options.num_queries; i += batch_size) {
+                const size_t n = std::min(batch_size, options.num_queries - i);
+                for(size_t j = 0; j < n; j++) keys[j] = options.queries(i + j);
+                hash::find_batch(set, keys.data(), n, results.data());
+                for(size_t j = 0; j < n; j++) chk += (results[j] != set.end());
+            }
+        }
+        result.log("chk_batch", chk);
+    }
+
+    // churn: repeatedly erase the oldest key and insert a new one, so the size remains stable
+    {
+        stat::Phase phase("churn");
+        for(size_t i = 0; i < options.num_churn; i++) {
+            set.erase(options.keys(i));
+            set.insert(options.keys(options.num + i));
+        }
+        assert(set.size() == options.num);
+    }
+
+    // lookup random keys after churn, which are mostly misses
+    {
+        size_t chk = 0;
+        {
+            stat::Phase phase("lookup_rnd_churn");
+            for(size_t i = 0; i < options.num_queries; i++) {
+                auto key = options.queries(i);
+                auto x = set.find(key);
+
+                chk += (x != set.end());
+            }
+        }
+        result.log("chk_churn", chk);
+    }
+
     // erase keys
     {
         stat::Phase phase("erase");
         for(size_t i = options.num; i > 0; i--) {
-            auto key = options.keys(i-1);
+            auto key = options.keys(options.num_churn + i - 1);
             assert(set.erase(key));
             assert(set.size() == i-1);
         }
@@ -108,7 +169,8 @@ void bench(const std::string& name, ctor_t ctor, diag_func_t diag) {
     std::cout << "RESULT algo=" << name << " " << result.to_keyval() << " " << result.subphases_keyval() << std::endl;
 }
 
-void diag_tdc(stat::Phase& result, const hash::Table<uint64_t>& set) {
+template<typename table_t>
+void diag_tdc(stat::Phase& result, const table_t& set) {
     result.log("load", set.load());
     result.log("max_probe", set.max_probe());
     
@@ -120,9 +182,113 @@ void diag_tdc(stat::Phase& result, const hash::Table<uint64_t>& set) {
 
 template<typename hash_func_t, typename probe_func_t>
 void bench_tdc(const std::string& name, hash_func_t hash_func, probe_func_t probe_func) {
-    bench(name, [&](){ return hash::Table<uint64_t>(hash_func, options.capacity, options.load_factor, options.growth_factor, probe_func); }, diag_tdc);
+    bench(name, [&](){ return hash::Table<uint64_t>(hash_func, options.capacity, options.load_factor, options.growth_factor, probe_func); }, diag_tdc<hash::Table<uint64_t>>);
+}
+
+template<typename hash_func_t>
+void bench_robin_hood(const std::string& name, hash_func_t hash_func) {
+    using table_t = hash::Table<uint64_t, hash::KeyEntry<uint64_t>, true>;
+    bench(name, [&](){ return table_t(hash_func, options.capacity, options.load_factor, options.growth_factor); }, diag_tdc<table_t>);
+}
+
+template<size_t group_size, typename hash_func_t>
+void bench_swiss(const std::string& name, hash_func_t hash_func) {
+    using table_t = hash::SwissTable<uint64_t, hash::KeyEntry<uint64_t>, hash_func_t, hash::LinearProbing<>, group_size>;
+    bench(name, [&](){ return table_t(hash_func, options.capacity, options.load_factor); }, diag_tdc<table_t>);
+}
+
+template<size_t disp_bits>
+void bench_quotient(const std::string& name) {
+    // keys are drawn from the universe, so they fit into its bit width
+    const size_t key_bits = std::max(size_t(1), size_t(std::bit_width(options.universe - 1)));
+    bench(name, [&](){ return hash::QuotientSet<disp_bits>(key_bits, options.capacity, options.load_factor); }, [](stat::Phase& result, const hash::QuotientSet<disp_bits>& set){
+        result.log("load", set.load());
+        result.log("max_probe", set.max_probe());
+        result.log("slot_bits", set.slot_bits());
+    });
 }
 
+// runs the given function on the given number of threads, each of which receives its thread number
+template<typename func_t>
+void run_parallel(const size_t num_threads, func_t func) {
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t](){ func(t); });
+    }
+    for(auto& thread : threads) thread.join();
+}
+
+// measures the throughput of a concurrent set for 1, 2, 4, ... threads, which is timed directly because phases do not track other threads
+// keys and queries are split round robin among the threads
+template<typename ctor_t>
+void bench_mt(const std::string& name, ctor_t ctor) {
+    if(options.ds.length() > 0 && options.ds != name) return;
+
+    for(size_t num_threads = 1; num_threads <= options.max_threads; num_threads *= 2) {
+        auto result = benchmark_phase("");
+        result.log("threads", num_threads);
+
+        auto set = ctor();
+
+        uint64_t t0 = stat::time_nanos();
+        run_parallel(num_threads, [&](const size_t t){
+            for(size_t i = t; i < options.num; i += num_threads) {
+                set->insert(options.keys(i));
+            }
+        });
+        const uint64_t time_insert = stat::time_nanos() - t0;
+        assert(set->size() == options.num);
+
+        std::atomic<size_t> chk = 0;
+        t0 = stat::time_nanos();
+        run_parallel(num_threads, [&](const size_t t){
+            size_t c = 0;
+            for(size_t i = t; i < options.num_queries; i += num_threads) {
+                c += set->contains(options.queries(i));
+            }
+            chk += c;
+        });
+        const uint64_t time_lookup = stat::time_nanos() - t0;
+
+        result.log("time_insert", (double)(time_insert / 1000ULL) / 1000.0);
+        result.log("time_lookup", (double)(time_lookup / 1000ULL) / 1000.0);
+        result.log("insert_mops", (double)options.num / (double)std::max(time_insert, uint64_t(1)) * 1000.0);
+        result.log("lookup_mops", (double)options.num_queries / (double)std::max(time_lookup, uint64_t(1)) * 1000.0);
+        result.log("chk", chk.load());
+
+        std::cout << "RESULT algo=" << name << " " << result.to_keyval() << std::endl;
+    }
+}
+
+// a sequential table guarded by a mutex, as a baseline for concurrent tables
+template<typename table_t>
+class Locked {
+private:
+    mutable std::mutex m_mutex;
+    table_t m_table;
+
+public:
+    Locked(table_t&& table) : m_table(std::move(table)) {
+    }
+
+    bool insert(const uint64_t x) {
+        std::lock_guard lock(m_mutex);
+        if(m_table.contains(x)) return false;
+        m_table.insert(x);
+        return true;
+    }
+
+    bool contains(const uint64_t x) const {
+        std::lock_guard lock(m_mutex);
+        return m_table.contains(x);
+    }
+
+    size_t size() const {
+        std::lock_guard lock(m_mutex);
+        return m_table.size();
+    }
+};
+
 int main(int argc, char** argv) {
     tlx::CmdlineParser cp;
 
@@ -132,8 +298,10 @@ int main(int argc, char** argv) {
     cp.add_double('l', "load-factor", options.load_factor, "the maximum load factor (default: 0.95)");
     cp.add_double('g', "growth-factor", options.growth_factor, "the growth factor (default: 2)");
     cp.add_bytes('q', "queries", options.num_queries, "the number of membership queries to perform");
+    cp.add_bytes("churn", options.num_churn, "the number of keys to replace in the churn workload (default: num)");
     cp.add_bytes('s', "seed", options.seed, "the random seed");
     cp.add_string("ds", options.ds, "the single data structure to test");
+    cp.add_bytes('t', "threads", options.max_threads, "the maximum number of threads for concurrent tables, which are tested for 1, 2, 4, ... threads (default: 0 = skip)");
     
     if (!cp.process(argc, argv)) {
         return -1;
@@ -145,9 +313,19 @@ int main(int argc, char** argv) {
     if(options.capacity == 0) {
         options.capacity = options.num;
     }
+    if(options.num_churn == 0) {
+        options.num_churn = options.num;
+    }
 
     // unordered set
     bench("std::unordered_set", [](){ return std::unordered_set<uint64_t>(options.capacity); }, [](stat::Phase&, const std::unordered_set<uint64_t>&){});
+    
+    // robin hood
+    bench("robin_hood", [](){
+        robin_hood::unordered_flat_set<uint64_t> set;
+        set.reserve(options.capacity);
+        return set;
+    }, [](stat::Phase&, const robin_hood::unordered_flat_set<uint64_t>&){});
 
     bench_tdc("lp.id",         hash::Identity(),                                    hash::LinearProbing<>());
     bench_tdc("lp.knuth",      hash::Multiplicative(),                              hash::LinearProbing<>());
@@ -161,5 +339,28 @@ int main(int argc, char** argv) {
     bench_tdc("qp.mul_prime2", hash::Multiplicative(16'568'458'216'213'224'001ULL), hash::QuadraticProbing<>());
     bench_tdc("qp.mul_prime3", hash::Multiplicative(17'406'548'584'874'384'839ULL), hash::QuadraticProbing<>());
     
+    bench_robin_hood("rh.id",         hash::Identity());
+    bench_robin_hood("rh.knuth",      hash::Multiplicative());
+    bench_robin_hood("rh.mul_prime1", hash::Multiplicative(15'425'459'083'914'370'367ULL));
+    
+    bench_swiss<16>("swiss16.id",    hash::Identity());
+    bench_swiss<16>("swiss16.knuth", hash::Multiplicative());
+    bench_swiss<32>("swiss32.id",    hash::Identity());
+    bench_swiss<32>("swiss32.knuth", hash::Multiplicative());
+    
+    bench_quotient<4>("quotient4");
+    bench_quotient<6>("quotient6");
+
+    // concurrent tables
+    bench_mt("concurrent", [](){ return std::make_unique<hash::ConcurrentTable<>>(options.capacity, options.load_factor); });
+    bench_mt("concurrent.fixed", [](){
+        // the fixed capacity must suffice for all keys
+        return std::make_unique<hash::ConcurrentTable<void, false>>(std::max(options.capacity, options.num), options.load_factor);
+    });
+    bench_mt("locked.swiss16", [](){
+        using table_t = hash::SwissTable<uint64_t>;
+        return std::make_unique<Locked<table_t>>(table_t(hash::Multiplicative(), options.capacity, options.load_factor));
+    });
+    
     return 0;
 }
@@ -0,0 +1,136 @@
+#include <iostream>
+#include <vector>
+
+#include <tdc/hash/bbhash.hpp>
+#include <tdc/hash/function.hpp>
+#include <tdc/hash/swiss_table.hpp>
+#include <tdc/hash/table.hpp>
+
+#include <tdc/random/permutation.hpp>
+#include <tdc/stat/phase.hpp>
+
+#include <tlx/cmdline_parser.hpp>
+
+using namespace tdc;
+
+struct {
+    size_t num = 1'000'000;
+    size_t num_queries = 10'000'000;
+    uint64_t universe = UINT64_MAX;
+    uint64_t seed = random::DEFAULT_SEED;
+    size_t num_threads = 1;
+    std::string ds = "";
+
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> queries;
+} options;
+
+stat::Phase benchmark_phase(std::string&& title) {
+    stat::Phase phase(std::move(title));
+    phase.log("num", options.num);
+    phase.log("queries", options.num_queries);
+    phase.log("universe", options.universe);
+    phase.log("seed", options.seed);
+    return phase;
+}
+
+// builds a data structure that maps each key to a distinct number and evaluates it for random keys
+// the hash tables serve as a baseline by storing the key's rank in the input explicitly
+template<typename build_func_t, typename eval_func_t, typename diag_func_t>
+void bench(const std::string& name, build_func_t build, eval_func_t eval, diag_func_t diag) {
+    if(options.ds.length() > 0 && options.ds != name) return;
+
+    auto result = benchmark_phase("");
+    using ds_t = decltype(build());
+
+    stat::Phase::MemoryInfo mem;
+    ds_t ds = [&](){
+        stat::Phase phase("build");
+        auto ds = build();
+        mem = phase.memory_info();
+        return ds;
+    }();
+    result.log("memData", mem.current - mem.offset);
+    diag(result, ds);
+
+    uint64_t chk = 0;
+    {
+        stat::Phase phase("eval_rnd");
+        for(size_t i = 0; i < options.num_queries; i++) {
+            chk += eval(ds, options.queries[i]);
+        }
+    }
+    result.log("chk", chk);
+
+    std::cout << "RESULT algo=" << name << " " << result.to_keyval() << " " << result.subphases_keyval() << std::endl;
+}
+
+void bench_bbhash(const std::string& name, const double gamma) {
+    bench(name,
+        [&](){ return hash::BBHash(options.keys.data(), options.num, gamma, options.num_threads, options.seed); },
+        [](const hash::BBHash& f, const uint64_t x){ return f(x); },
+        [&](stat::Phase& result, const hash::BBHash& f){
+            result.log("gamma", gamma);
+            result.log("threads", options.num_threads);
+            result.log("levels", f.num_levels());
+            result.log("fallback", f.num_fallback());
+            result.log("bits_per_key", 8.0 * (double)f.size_bytes() / (double)options.num);
+        });
+}
+
+template<typename table_t>
+void bench_table(const std::string& name, auto ctor) {
+    bench(name,
+        [&](){
+            table_t table = ctor();
+            for(size_t i = 0; i < options.num; i++) table.insert(hash::KeyValueEntry<uint64_t, uint64_t>(options.keys[i], i));
+            return table;
+        },
+        [](const table_t& table, const uint64_t x){ return (*table.find(x)).value(); },
+        [](stat::Phase& result, const table_t& table){
+            result.log("load", table.load());
+        });
+}
+
+int main(int argc, char** argv) {
+    tlx::CmdlineParser cp;
+
+    cp.add_bytes('n', "num", options.num, "the number of keys (default: 1M)");
+    cp.add_bytes('q', "queries", options.num_queries, "the number of evaluations (default: 10M)");
+    cp.add_bytes('u', "universe", options.universe, "the universe to draw keys from (default: 64 bit numbers)");
+    cp.add_bytes('s', "seed", options.seed, "the random seed");
+    cp.add_bytes('t', "threads", options.num_threads, "the number of threads used to build the minimal perfect hash functions (default: 1)");
+    cp.add_string("ds", options.ds, "the single data structure to test");
+
+    if (!cp.process(argc, argv)) {
+        return -1;
+    }
+
+    if(options.num > options.universe) {
+        std::cerr << "the universe is too small" << std::endl;
+        return -1;
+    }
+
+    // draw distinct keys and queries among them
+    {
+        random::Permutation perm(options.universe, options.seed);
+        options.keys = perm.vector(options.num);
+
+        random::Permutation select(options.num, options.seed + 1);
+        options.queries.reserve(options.num_queries);
+        for(size_t i = 0; i < options.num_queries; i++) {
+            options.queries.push_back(options.keys[select(i % options.num)]);
+        }
+    }
+
+    using Entry = hash::KeyValueEntry<uint64_t, uint64_t>;
+    bench_table<hash::Table<uint64_t, Entry>>("table.lp", [](){ return hash::Table<uint64_t, Entry>(hash::Multiplicative(), options.num, 0.95); });
+    bench_table<hash::Table<uint64_t, Entry, true>>("table.rh", [](){ return hash::Table<uint64_t, Entry, true>(hash::Multiplicative(), options.num, 0.95); });
+    bench_table<hash::SwissTable<uint64_t, Entry>>("swiss16", [](){ return hash::SwissTable<uint64_t, Entry>(hash::Multiplicative(), options.num, 0.95); });
+
+    bench_bbhash("bbhash.g1", 1.0);
+    bench_bbhash("bbhash.g2", 2.0);
+    bench_bbhash("bbhash.g5", 5.0);
+
+    return 0;
+}
@@ -26,6 +26,8 @@ struct {
 
     uint64_t seed = random::DEFAULT_SEED;
 
+    size_t num_threads = 1;
+
     bool check = false;
 } options;
 
@@ -35,6 +37,7 @@ stat::Phase benchmark_phase(std::string&& title) {
     phase.log("universe", options.universe);
     phase.log("queries", options.num_queries);
     phase.log("seed", options.seed);
+    phase.log("threads", options.num_threads);
     return phase;
 }
 
@@ -97,6 +100,7 @@ int main(int argc, char** argv) {
     cp.add_bytes('u', "universe", options.universe, "The size of the universe to draw from (default: 10 * n)");
     cp.add_bytes('q', "queries", options.num_queries, "The number to draw from the universe (default: 10M).");
     cp.add_bytes('s', "seed", options.seed, "The random seed.");
+    cp.add_bytes('t', "threads", options.num_threads, "The number of threads used for parallel construction (default: 1).");
     cp.add_flag("check", options.check, "Check results for correctness.");
     if(!cp.process(argc, argv)) {
         return -1;
@@ -123,6 +127,12 @@ int main(int argc, char** argv) {
     bench("OctrieTop(2)", [](const std::vector<uint64_t>& data){ return pred::OctrieTop(data.data(), data.size(), 2); });
     bench("OctrieTop(3)", [](const std::vector<uint64_t>& data){ return pred::OctrieTop(data.data(), data.size(), 3); });
     bench("OctrieTop(4)", [](const std::vector<uint64_t>& data){ return pred::OctrieTop(data.data(), data.size(), 4); });
+    if(options.num_threads > 1) {
+        bench("Octrie-par", [](const std::vector<uint64_t>& data){ return pred::Octrie(data.data(), data.size(), options.num_threads); });
+        bench("OctrieTop(2)-par", [](const std::vector<uint64_t>& data){ return pred::OctrieTop(data.data(), data.size(), 2, options.num_threads); });
+        bench("OctrieTop(3)-par", [](const std::vector<uint64_t>& data){ return pred::OctrieTop(data.data(), data.size(), 3, options.num_threads); });
+        bench("OctrieTop(4)-par", [](const std::vector<uint64_t>& data){ return pred::OctrieTop(data.data(), data.size(), 4, options.num_threads); });
+    }
     bench("Index(4)", [](const std::vector<uint64_t>& data){ return pred::Index(data.data(), data.size(), 4); });
     bench("Index(5)", [](const std::vector<uint64_t>& data){ return pred::Index(data.data(), data.size(), 5); });
     bench("Index(6)", [](const std::vector<uint64_t>& data){ return pred::Index(data.data(), data.size(), 6); });
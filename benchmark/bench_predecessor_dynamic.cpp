@@ -1,7 +1,14 @@
 #include <algorithm>
+#include <atomic>
+#include <barrier>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
 #include <vector>
 
 #include <ips4o.hpp>
@@ -26,12 +33,18 @@
 #include <tdc/pred/dynamic/tiny_universe/unsorted_list.hpp>
 #include <tdc/pred/dynamic/tiny_universe/sorted_list.hpp>
 
+#include <tdc/pred/dynamic/adaptive.hpp>
+#include <tdc/pred/dynamic/bplus_tree.hpp>
 #include <tdc/pred/dynamic/btree.hpp>
 #include <tdc/pred/dynamic/btree/dynamic_fusion_node.hpp>
+#include <tdc/pred/dynamic/btree/node_allocator.hpp>
 #include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/pred/dynamic/concurrent_btree.hpp>
+#include <tdc/pred/dynamic/sharded.hpp>
 
 #include <tdc/util/literals.hpp>
 #include <tdc/util/benchmark/integer_operation.hpp>
+#include <tdc/util/benchmark/latency_histogram.hpp>
 
 #include <tlx/cmdline_parser.hpp>
 
@@ -78,6 +91,44 @@
         }
     };
 
+    // wrapper around a dynamic predecessor data structure that guards every operation with a single lock
+    // - with a std::shared_mutex, queries only acquire a shared lock
+    template<typename ds_t, typename mutex_t>
+    class Locked {
+    private:
+        mutable mutex_t m_mutex;
+        ds_t m_ds;
+        
+    public:
+        template<typename key_t>
+        void insert(const key_t& x) {
+            std::lock_guard lock(m_mutex);
+            m_ds.insert(x);
+        }
+        
+        template<typename key_t>
+        auto predecessor(const key_t& x) const {
+            if constexpr(std::is_same<mutex_t, std::shared_mutex>::value) {
+                std::shared_lock lock(m_mutex);
+                return m_ds.predecessor(x);
+            } else {
+                std::lock_guard lock(m_mutex);
+                return m_ds.predecessor(x);
+            }
+        }
+        
+        template<typename key_t>
+        void remove(const key_t& x) {
+            std::lock_guard lock(m_mutex);
+            m_ds.remove(x);
+        }
+        
+        size_t size() const {
+            std::lock_guard lock(m_mutex);
+            return m_ds.size();
+        }
+    };
+
 #if defined(LEDA_FOUND) && defined(STREE_FOUND)
     #define BENCH_STREE
     #include <veb/STree_orig.h>
@@ -96,6 +147,9 @@ struct {
     size_t num = 1_M;
     uint64_t universe = 0;
     size_t num_queries = 1_M;
+    size_t num_range_queries = 100_K;
+    size_t range_keys = 100;     // the expected number of keys covered by a range query
+    uint64_t range_width = 0;    // the width of range queries in the universe, derived from range_keys
     uint64_t seed = random::DEFAULT_SEED;
     
     std::string ds; // if non-empty, only benchmarks the selected data structure
@@ -126,6 +180,15 @@ struct {
     
     bool check;
     std::vector<uint64_t> data; // only used if check == true
+    
+    size_t max_threads = std::max(std::thread::hardware_concurrency(), 1U); // only used in mt mode
+    double update_ratio = 0.1;                                            // only used in mt mode
+    
+    size_t latency_sample = 0; // if non-zero, the latency of every n-th replayed operation is measured
+    
+    std::vector<std::string> traces; // only used in replay mode
+    bool shared = false;             // only used in replay mode
+    bool json = false;               // only used in replay mode
 } options;
 
 stat::Phase benchmark_phase(std::string&& title) {
@@ -133,6 +196,51 @@ stat::Phase benchmark_phase(std::string&& title) {
     return phase;
 }
 
+/// \brief Replays operations and measures the latency of every n-th operation, where n is the latency sample rate.
+///
+/// Measuring only a sample keeps the overhead of reading the clock small compared to the operations.
+/// Samplers are aligned to cache lines so that the samplers of different threads can be stored next to each other.
+struct alignas(64) LatencySampler {
+    benchmark::LatencyHistogram histogram;
+    size_t countdown = 1; // the number of operations until the next sample
+    
+    /// \brief Applies an operation to each of the given keys.
+    /// \param keys   the keys
+    /// \param num    the number of keys
+    /// \param op     the operation, must support signature <any>(const key_t& x)
+    template<typename key_t, typename op_func_t>
+    void replay(const key_t* keys, const size_t num, op_func_t op) {
+        const size_t n = options.latency_sample;
+        if(n == 0) {
+            for(size_t i = 0; i < num; i++) op(keys[i]);
+            return;
+        }
+        
+        for(size_t i = 0; i < num; i++) {
+            if(--countdown == 0) {
+                countdown = n;
+                const uint64_t t0 = benchmark::LatencyHistogram::now();
+                op(keys[i]);
+                histogram.add(benchmark::LatencyHistogram::now() - t0);
+            } else {
+                op(keys[i]);
+            }
+        }
+    }
+};
+
+/// \brief Logs the sample count, mean, median, 99th and 99.9th percentile and maximum of a latency histogram, in nanoseconds.
+void log_latency(stat::Phase& phase, const std::string& op, const benchmark::LatencyHistogram& histogram) {
+    if(histogram.count() == 0) return;
+    
+    phase.log("lat_" + op + "_samples", histogram.count());
+    phase.log("lat_" + op + "_mean", histogram.mean());
+    phase.log("lat_" + op + "_p50", histogram.percentile(0.5));
+    phase.log("lat_" + op + "_p99", histogram.percentile(0.99));
+    phase.log("lat_" + op + "_p999", histogram.percentile(0.999));
+    phase.log("lat_" + op + "_max", histogram.max());
+}
+
 /// \brief Performs a benchmark.
 /// \param name        the algorithm name
 /// \param ctor_func   constructor function, must support signature T(const uint64_t) and return an empty data structure,
@@ -261,6 +369,84 @@ void bench(
                 result.log("errors", num_errors);
             }
             
+            // successor and range queries, if supported
+            using ds_t = decltype(ds);
+            const key_t key_max = std::numeric_limits<key_t>::max() >> (std::numeric_limits<key_t>::digits - options.universe);
+            auto range_upper = [&](const key_t a){
+                return (key_t)std::min((uint64_t)a + options.range_width, (uint64_t)key_max);
+            };
+            
+            if constexpr(requires(const ds_t& d, const key_t x) { d.successor(x); }) {
+                uint64_t chk_s = 0;
+                {
+                    stat::Phase phase("successor_rnd");
+                    for(size_t i = 0; i < options.num_queries; i++) {
+                        const auto r = ds.successor(options.perm_queries(i));
+                        if(r.exists) chk_s += (uint64_t)r.key;
+                    }
+                }
+                result.log("chk_succ", chk_s);
+            }
+            
+            if(options.num_range_queries > 0) {
+                result.log("range_queries", options.num_range_queries);
+                result.log("range_keys", options.range_keys);
+            
+                if constexpr(requires(const ds_t& d, const key_t x) { d.count_range(x, x); }) {
+                    uint64_t chk_r = 0;
+                    {
+                        stat::Phase phase("count_rnd");
+                        for(size_t i = 0; i < options.num_range_queries; i++) {
+                            const key_t a = options.perm_queries(i);
+                            chk_r += ds.count_range(a, range_upper(a));
+                        }
+                    }
+                    result.log("chk_count", chk_r);
+                    
+                    if(options.check) {
+                        size_t num_errors = 0;
+                        for(size_t i = 0; i < options.num_range_queries; i++) {
+                            const key_t a = options.perm_queries(i);
+                            const key_t b = range_upper(a);
+                            
+                            // compare against the sorted input
+                            const size_t correct_count =
+                                std::upper_bound(options.data.begin(), options.data.end(), (uint64_t)b) -
+                                std::lower_bound(options.data.begin(), options.data.end(), (uint64_t)a);
+                            if(ds.count_range(a, b) != correct_count) ++num_errors;
+                        }
+                        result.log("errors_count", num_errors);
+                    }
+                }
+                
+                if constexpr(requires(const ds_t& d, const key_t x) { d.lower_bound(x) != d.end(); }) {
+                    uint64_t chk_r = 0;
+                    {
+                        stat::Phase phase("scan_rnd");
+                        for(size_t i = 0; i < options.num_range_queries; i++) {
+                            const key_t a = options.perm_queries(i);
+                            const key_t b = range_upper(a);
+                            for(auto it = ds.lower_bound(a); it != ds.end() && *it <= b; ++it) {
+                                chk_r += (uint64_t)*it;
+                            }
+                        }
+                    }
+                    result.log("chk_scan", chk_r);
+                }
+            }
+            
+            // sequential scan over all keys, if supported
+            if constexpr(requires(const ds_t& d) { d.begin() != d.end(); }) {
+                uint64_t chk_a = 0;
+                {
+                    stat::Phase phase("scan_all");
+                    for(auto it = ds.begin(); it != ds.end(); ++it) {
+                        chk_a += (uint64_t)*it;
+                    }
+                }
+                result.log("chk_scan_all", chk_a);
+            }
+            
             // delete
             {
                 stat::Phase del("delete");
@@ -272,6 +458,41 @@ void bench(
             // make sure size is back to normal (only zero is contained)
             assert(size_func(ds) == 1);
             
+            // bulk construction from sorted keys, if supported
+            if constexpr(requires(decltype(ds)& d, const key_t* keys) { d.bulk_load(keys, size_t(0)); }) {
+                std::vector<key_t> keys;
+                keys.reserve(options.num + 1);
+                keys.push_back(0);
+                for(size_t i = 0; i < options.num; i++) {
+                    keys.push_back(options.perm_values(i) + 1);
+                }
+                ips4o::sort(keys.begin(), keys.end());
+                
+                auto ds_bulk = ctor_func(0);
+                {
+                    stat::Phase bulk("bulk_load");
+                    ds_bulk.bulk_load(keys.data(), keys.size());
+                }
+                assert(size_func(ds_bulk) == options.num+1);
+                
+                // snapshot and restore, compare time_restore against time_insert for rebuilding from the key log
+                if constexpr(requires(ds_t& d, std::ostream& out, std::istream& in) { d.snapshot(out); d.restore(in); }) {
+                    std::stringstream snapshot;
+                    {
+                        stat::Phase phase("snapshot");
+                        ds_bulk.snapshot(snapshot);
+                    }
+                    result.log("snapshotBytes", snapshot.str().size());
+                    
+                    auto ds_restored = ctor_func(0);
+                    {
+                        stat::Phase phase("restore");
+                        ds_restored.restore(snapshot);
+                    }
+                    assert(size_func(ds_restored) == options.num+1);
+                }
+            }
+            
             // memory of empty data structure
             {
                 auto mem = result.memory_info();
@@ -295,10 +516,13 @@ void bench(
         size_t ops_ins = 0;
         size_t ops_del = 0;
         size_t ops_q = 0;
+        size_t ops_r = 0;
         size_t ops_max = 0;
         uint64_t time_ins = 0;
         uint64_t time_del = 0;
         uint64_t time_q = 0;
+        uint64_t time_r = 0;
+        LatencySampler lat_ins, lat_del, lat_q;
         {
             options.rewind_ops();
             stat::Phase ops_phase("ops");
@@ -306,14 +530,21 @@ void bench(
             benchmark::IntegerOperationBatch<key_t> batch;
             while(batch.read(options.ops)) {
                 // process next batch
-                ops_total += batch.size();
+                ops_total += (batch.opcode() == benchmark::OPCODE_RANGE) ? batch.size() / 2 : batch.size();
                 
                 uint64_t t0;
                 switch(batch.opcode()) {
                     case benchmark::OPCODE_INSERT:
                         t0 = stat::time_nanos();
-                        for(const auto& key : batch.keys()) {
-                            insert_func(ds, key);
+                        if constexpr(requires(decltype(ds)& d, const key_t* keys) { d.insert_batch(keys, size_t(0)); }) {
+                            // batches cannot be sampled for latencies
+                            if(options.latency_sample == 0) {
+                                ds.insert_batch(batch.keys().data(), batch.size());
+                            } else {
+                                lat_ins.replay(batch.keys().data(), batch.size(), [&](const key_t& key){ insert_func(ds, key); });
+                            }
+                        } else {
+                            lat_ins.replay(batch.keys().data(), batch.size(), [&](const key_t& key){ insert_func(ds, key); });
                         }
                         time_ins += stat::time_nanos() - t0;
                         ops_ins += batch.size();
@@ -322,8 +553,14 @@ void bench(
                         
                     case benchmark::OPCODE_DELETE:
                         t0 = stat::time_nanos();
-                        for(const auto& key : batch.keys()) {
-                            remove_func(ds, key);
+                        if constexpr(requires(decltype(ds)& d, const key_t* keys) { d.remove_batch(keys, size_t(0)); }) {
+                            if(options.latency_sample == 0) {
+                                ds.remove_batch(batch.keys().data(), batch.size());
+                            } else {
+                                lat_del.replay(batch.keys().data(), batch.size(), [&](const key_t& key){ remove_func(ds, key); });
+                            }
+                        } else {
+                            lat_del.replay(batch.keys().data(), batch.size(), [&](const key_t& key){ remove_func(ds, key); });
                         }
                         time_del += stat::time_nanos() - t0;
                         ops_del += batch.size();
@@ -331,12 +568,22 @@ void bench(
                         
                     case benchmark::OPCODE_QUERY:
                         t0 = stat::time_nanos();
-                        for(const auto& key : batch.keys()) {
-                            ops_chk += (uint64_t)pred_func(ds, key).key;
-                        }
+                        lat_q.replay(batch.keys().data(), batch.size(), [&](const key_t& key){ ops_chk += (uint64_t)pred_func(ds, key).key; });
                         time_q += stat::time_nanos() - t0;
                         ops_q += batch.size();
                         break;
+                        
+                    case benchmark::OPCODE_RANGE:
+                        // range queries are skipped for data structures that do not support them
+                        if constexpr(requires(const decltype(ds)& d, const key_t x) { d.count_range(x, x); }) {
+                            t0 = stat::time_nanos();
+                            for(size_t i = 0; i + 1 < batch.size(); i += 2) {
+                                ops_chk += ds.count_range(batch.keys()[i], batch.keys()[i+1]);
+                            }
+                            time_r += stat::time_nanos() - t0;
+                            ops_r += batch.size() / 2;
+                        }
+                        break;
                 }
             }
             
@@ -348,14 +595,464 @@ void bench(
         result.log("ops_ins", ops_ins);
         result.log("ops_del", ops_del);
         result.log("ops_q", ops_q);
+        result.log("ops_r", ops_r);
         result.log("ops_chk", ops_chk);
         result.log("ops_max", ops_max);
         result.log("time_ins", (double)(time_ins / 1000ULL) / 1000.0);
         result.log("time_del", (double)(time_del / 1000ULL) / 1000.0);
         result.log("time_q", (double)(time_q / 1000ULL) / 1000.0);
+        result.log("time_r", (double)(time_r / 1000ULL) / 1000.0);
+        log_latency(result, "ins", lat_ins.histogram);
+        log_latency(result, "del", lat_del.histogram);
+        log_latency(result, "q", lat_q.histogram);
     }
     
-    std::cout << "RESULT algo=" << name << " " << result.to_keyval() << " " << result.subphases_keyval() << std::endl;
+    std::cout << "RESULT algo=" << name << " " << result.to_keyval() << " " << result.subphases_keyval() << " " << result.subphases_keyval(stat::Phase::STAT_NUM_ALLOC) << std::endl;
+}
+
+/// \brief Replays the operation sequence of the ops file on a thread-safe data structure using multiple threads.
+///
+/// Consecutive batches with the same operation are merged into one step, since their operations are independent of each other.
+/// The operations of a step are distributed evenly over the threads, and all threads finish a step before the next one begins,
+/// so every query observes the same set of keys as in a sequential replay.
+/// This is repeated for 1, 2, 4, ... threads up to the maximum number of threads, reporting the throughput for each.
+///
+/// \param name        the algorithm name
+/// \param ctor_func   constructor function, must support signature T(const uint64_t) and return an empty data structure
+/// \param insert_func insertion function, must support signature <any>(T& ds, const uint64_t x) and be thread-safe
+/// \param pred_func   predecessor function, must support signature pred::Result(const T& ds, const uint64_t x) and be thread-safe
+/// \param remove_func key removal function, must support signature <any>(T& ds, const uint64_t x) and be thread-safe
+template<typename key_t, typename ctor_func_t, typename insert_func_t, typename pred_func_t, typename remove_func_t>
+void bench_mt_ops(
+    const std::string& name,
+    ctor_func_t ctor_func,
+    insert_func_t insert_func,
+    pred_func_t pred_func,
+    remove_func_t remove_func
+) {
+    // load the operation sequence
+    std::vector<benchmark::IntegerOperationBatch<key_t>> steps;
+    {
+        options.rewind_ops();
+        benchmark::IntegerOperationBatch<key_t> batch;
+        while(batch.read(options.ops)) {
+            if(steps.empty() || steps.back().opcode() != batch.opcode()) {
+                steps.emplace_back(batch.opcode(), batch.size());
+            }
+            for(auto key : batch.keys()) {
+                steps.back().add_key(std::move(key));
+            }
+        }
+    }
+
+    using ds_t = decltype(ctor_func(0));
+    constexpr bool supports_range = requires(const ds_t& d, const key_t x) { d.count_range(x, x); };
+    
+    for(size_t num_threads = 1;; num_threads = std::min(2 * num_threads, options.max_threads)) {
+        auto result = benchmark_phase("");
+        result.log("ops", options.ops_filename);
+        result.log("threads", num_threads);
+        
+        auto ds = ctor_func(0);
+        if(ds.size() == 1) remove_func(ds, 0);
+        
+        std::atomic<uint64_t> chk = 0;
+        size_t ops_total = 0;
+        uint64_t time_mt;
+        uint64_t time_op[4] = { 0, 0, 0, 0 }; // insert, delete, query, range
+        std::vector<LatencySampler> lat_ins(num_threads), lat_del(num_threads), lat_q(num_threads);
+        {
+            // the completion of a step is timed by the barrier
+            size_t cur_step = 0;
+            uint64_t t_step = 0;
+            auto on_step = [&]() noexcept {
+                const uint64_t t = stat::time_nanos();
+                switch(steps[cur_step].opcode()) {
+                    case benchmark::OPCODE_INSERT: time_op[0] += t - t_step; break;
+                    case benchmark::OPCODE_DELETE: time_op[1] += t - t_step; break;
+                    case benchmark::OPCODE_QUERY:  time_op[2] += t - t_step; break;
+                    case benchmark::OPCODE_RANGE:  time_op[3] += t - t_step; break;
+                }
+                t_step = t;
+                ++cur_step;
+            };
+            std::barrier sync(num_threads, on_step);
+            
+            auto run = [&](const size_t t){
+                uint64_t local_chk = 0;
+                for(const auto& step : steps) {
+                    const auto& keys = step.keys();
+                    const bool range = (step.opcode() == benchmark::OPCODE_RANGE);
+                    const size_t n = range ? keys.size() / 2 : keys.size();
+                    const size_t first = t * n / num_threads;
+                    const size_t last = (t + 1) * n / num_threads;
+                    
+                    switch(step.opcode()) {
+                        case benchmark::OPCODE_INSERT:
+                            lat_ins[t].replay(keys.data() + first, last - first, [&](const key_t& x){ insert_func(ds, x); });
+                            break;
+                        case benchmark::OPCODE_DELETE:
+                            lat_del[t].replay(keys.data() + first, last - first, [&](const key_t& x){ remove_func(ds, x); });
+                            break;
+                        case benchmark::OPCODE_QUERY:
+                            lat_q[t].replay(keys.data() + first, last - first, [&](const key_t& x){
+                                const auto r = pred_func(ds, x);
+                                if(r.exists) local_chk += (uint64_t)r.key;
+                            });
+                            break;
+                        case benchmark::OPCODE_RANGE:
+                            // range queries are skipped for data structures that do not support them
+                            if constexpr(supports_range) {
+                                for(size_t i = first; i < last; i++) local_chk += ds.count_range(keys[2 * i], keys[2 * i + 1]);
+                            }
+                            break;
+                    }
+                    sync.arrive_and_wait();
+                }
+                chk += local_chk;
+            };
+            
+            for(const auto& step : steps) {
+                if(step.opcode() != benchmark::OPCODE_RANGE) {
+                    ops_total += step.size();
+                } else if(supports_range) {
+                    ops_total += step.size() / 2;
+                }
+            }
+            
+            const uint64_t t0 = stat::time_nanos();
+            t_step = t0;
+            std::vector<std::thread> threads;
+            threads.reserve(num_threads - 1);
+            for(size_t t = 1; t < num_threads; t++) {
+                threads.emplace_back(run, t);
+            }
+            run(0);
+            for(auto& thread : threads) thread.join();
+            time_mt = stat::time_nanos() - t0;
+        }
+        
+        result.log("steps", steps.size());
+        result.log("ops_total", ops_total);
+        result.log("time_mt", (double)(time_mt / 1000ULL) / 1000.0);
+        result.log("time_ins", (double)(time_op[0] / 1000ULL) / 1000.0);
+        result.log("time_del", (double)(time_op[1] / 1000ULL) / 1000.0);
+        result.log("time_q", (double)(time_op[2] / 1000ULL) / 1000.0);
+        result.log("time_r", (double)(time_op[3] / 1000ULL) / 1000.0);
+        result.log("mops", (double)ops_total / (double)std::max(time_mt, uint64_t(1)) * 1000.0);
+        result.log("chk", chk.load());
+        for(size_t t = 1; t < num_threads; t++) {
+            lat_ins[0].histogram.merge(lat_ins[t].histogram);
+            lat_del[0].histogram.merge(lat_del[t].histogram);
+            lat_q[0].histogram.merge(lat_q[t].histogram);
+        }
+        log_latency(result, "ins", lat_ins[0].histogram);
+        log_latency(result, "del", lat_del[0].histogram);
+        log_latency(result, "q", lat_q[0].histogram);
+        
+        std::cout << "RESULT algo=" << name << " " << result.to_keyval() << " " << result.subphases_keyval() << std::endl;
+        
+        if(num_threads >= options.max_threads) break;
+    }
+}
+
+/// \brief Replays several operation sequences simultaneously, one per thread, and reports throughput and latency percentiles.
+///
+/// Every thread replays its own trace from start to end without synchronizing with the other threads.
+/// The threads either operate on separate instances of the data structure, or, in shared mode, on a single instance.
+/// In shared mode, the traces should operate on disjoint key sets (e.g., generated with different key seeds),
+/// because a key inserted by two threads or removed by a thread that did not insert it may violate the preconditions of the data structure.
+///
+/// The result contains the merged latency percentiles over all threads, and a sub phase per thread containing the results of that thread only.
+///
+/// \param name        the algorithm name
+/// \param ctor_func   constructor function, must support signature T(const uint64_t) and return an empty data structure
+/// \param insert_func insertion function, must support signature <any>(T& ds, const uint64_t x) and be thread-safe
+/// \param pred_func   predecessor function, must support signature pred::Result(const T& ds, const uint64_t x) and be thread-safe
+/// \param remove_func key removal function, must support signature <any>(T& ds, const uint64_t x) and be thread-safe
+template<typename key_t, typename ctor_func_t, typename insert_func_t, typename pred_func_t, typename remove_func_t>
+void bench_mt_replay(
+    const std::string& name,
+    ctor_func_t ctor_func,
+    insert_func_t insert_func,
+    pred_func_t pred_func,
+    remove_func_t remove_func
+) {
+    const size_t num_threads = options.traces.size();
+    
+    // load the traces
+    std::vector<std::vector<benchmark::IntegerOperationBatch<key_t>>> traces(num_threads);
+    for(size_t t = 0; t < num_threads; t++) {
+        std::ifstream in(options.traces[t]);
+        uint64_t universe;
+        in.read((char*)&universe, sizeof(universe));
+        
+        benchmark::IntegerOperationBatch<key_t> batch;
+        while(batch.read(in)) {
+            traces[t].push_back(batch);
+        }
+    }
+    
+    using ds_t = decltype(ctor_func(0));
+    constexpr bool supports_range = requires(const ds_t& d, const key_t x) { d.count_range(x, x); };
+    
+    auto result = benchmark_phase("");
+    result.log("threads", num_threads);
+    result.log("shared", options.shared);
+    result.log("latency_sample", options.latency_sample);
+    
+    std::vector<std::unique_ptr<ds_t>> ds(options.shared ? 1 : num_threads);
+    for(auto& p : ds) {
+        p = std::unique_ptr<ds_t>(new ds_t(ctor_func(0)));
+        if(p->size() == 1) remove_func(*p, 0);
+    }
+    
+    struct alignas(64) ThreadResult {
+        LatencySampler lat_ins, lat_del, lat_q;
+        size_t ops = 0;
+        uint64_t chk = 0;
+        uint64_t time = 0;
+    };
+    std::vector<ThreadResult> thread_results(num_threads);
+    {
+        // all threads start replaying at the same time
+        std::barrier sync(num_threads);
+        
+        auto run = [&](const size_t t){
+            auto& d = *ds[options.shared ? 0 : t];
+            auto& r = thread_results[t];
+            
+            sync.arrive_and_wait();
+            const uint64_t t0 = stat::time_nanos();
+            for(const auto& batch : traces[t]) {
+                const key_t* keys = batch.keys().data();
+                switch(batch.opcode()) {
+                    case benchmark::OPCODE_INSERT:
+                        r.lat_ins.replay(keys, batch.size(), [&](const key_t& x){ insert_func(d, x); });
+                        r.ops += batch.size();
+                        break;
+                    case benchmark::OPCODE_DELETE:
+                        r.lat_del.replay(keys, batch.size(), [&](const key_t& x){ remove_func(d, x); });
+                        r.ops += batch.size();
+                        break;
+                    case benchmark::OPCODE_QUERY:
+                        r.lat_q.replay(keys, batch.size(), [&](const key_t& x){
+                            const auto q = pred_func(d, x);
+                            if(q.exists) r.chk += (uint64_t)q.key;
+                        });
+                        r.ops += batch.size();
+                        break;
+                    case benchmark::OPCODE_RANGE:
+                        // range queries are skipped for data structures that do not support them
+                        if constexpr(supports_range) {
+                            for(size_t i = 0; i + 1 < batch.size(); i += 2) r.chk += d.count_range(keys[i], keys[i + 1]);
+                            r.ops += batch.size() / 2;
+                        }
+                        break;
+                }
+            }
+            r.time = stat::time_nanos() - t0;
+        };
+        
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for(size_t t = 1; t < num_threads; t++) {
+            threads.emplace_back(run, t);
+        }
+        run(0);
+        for(auto& thread : threads) thread.join();
+    }
+    
+    // report per thread and merge
+    size_t ops_total = 0;
+    uint64_t chk = 0;
+    uint64_t time_mt = 0;
+    benchmark::LatencyHistogram lat_ins, lat_del, lat_q;
+    for(size_t t = 0; t < num_threads; t++) {
+        const auto& r = thread_results[t];
+        {
+            stat::Phase thread_phase("thread" + std::to_string(t));
+            thread_phase.log("trace", options.traces[t]);
+            thread_phase.log("ops", r.ops);
+            thread_phase.log("time_replay", (double)(r.time / 1000ULL) / 1000.0);
+            thread_phase.log("mops", (double)r.ops / (double)std::max(r.time, uint64_t(1)) * 1000.0);
+            log_latency(thread_phase, "ins", r.lat_ins.histogram);
+            log_latency(thread_phase, "del", r.lat_del.histogram);
+            log_latency(thread_phase, "q", r.lat_q.histogram);
+        }
+        
+        ops_total += r.ops;
+        chk += r.chk;
+        time_mt = std::max(time_mt, r.time);
+        lat_ins.merge(r.lat_ins.histogram);
+        lat_del.merge(r.lat_del.histogram);
+        lat_q.merge(r.lat_q.histogram);
+    }
+    
+    result.log("ops_total", ops_total);
+    result.log("time_mt", (double)(time_mt / 1000ULL) / 1000.0);
+    result.log("mops", (double)ops_total / (double)std::max(time_mt, uint64_t(1)) * 1000.0);
+    result.log("chk", chk);
+    log_latency(result, "ins", lat_ins);
+    log_latency(result, "del", lat_del);
+    log_latency(result, "q", lat_q);
+    
+    std::cout << "RESULT algo=" << name << " " << result.to_keyval() << std::endl;
+    if(options.json) {
+        std::cout << result.to_json() << std::endl;
+    }
+}
+
+/// \brief Performs a multi-threaded benchmark on a thread-safe data structure.
+///
+/// The data structure is filled with the input keys, then the queries are distributed evenly over the threads.
+/// A fraction of the operations are updates, which alternately insert a new key and remove it again, so that the size remains stable.
+/// This is repeated for 1, 2, 4, ... threads up to the maximum number of threads, reporting the throughput for each.
+/// If an ops file is given, its operation sequence is replayed instead (see \ref bench_mt_ops).
+/// In replay mode, the given traces are replayed simultaneously instead (see \ref bench_mt_replay).
+///
+/// \param name        the algorithm name
+/// \param ctor_func   constructor function, must support signature T(const uint64_t) and return an empty data structure
+/// \param insert_func insertion function, must support signature <any>(T& ds, const uint64_t x) and be thread-safe
+/// \param pred_func   predecessor function, must support signature pred::Result(const T& ds, const uint64_t x) and be thread-safe
+/// \param remove_func key removal function, must support signature <any>(T& ds, const uint64_t x) and be thread-safe
+template<typename key_t, typename ctor_func_t, typename insert_func_t, typename pred_func_t, typename remove_func_t>
+void bench_mt(
+    const std::string& name,
+    ctor_func_t ctor_func,
+    insert_func_t insert_func,
+    pred_func_t pred_func,
+    remove_func_t remove_func
+) {
+    if(!options.do_bench(name)) return;
+    
+    if(!options.traces.empty()) {
+        bench_mt_replay<key_t>(name, ctor_func, insert_func, pred_func, remove_func);
+        return;
+    }
+    
+    if(options.has_opsfile()) {
+        bench_mt_ops<key_t>(name, ctor_func, insert_func, pred_func, remove_func);
+        return;
+    }
+    
+    // operation i is an update if the fractional part of i times the golden ratio is less than the update ratio
+    const uint64_t update_threshold = (options.update_ratio >= 1.0) ? UINT64_MAX : (uint64_t)(options.update_ratio * 18446744073709551616.0);
+    auto is_update = [&](const uint64_t i){ return i * 0x9E3779B97F4A7C15ULL < update_threshold; };
+    
+    for(size_t num_threads = 1;; num_threads = std::min(2 * num_threads, options.max_threads)) {
+        auto result = benchmark_phase("");
+        result.log("num", options.num);
+        result.log("universe", options.universe);
+        result.log("seed", options.seed);
+        result.log("queries", options.num_queries);
+        result.log("update_ratio", options.update_ratio);
+        result.log("threads", num_threads);
+        
+        auto ds = ctor_func(0);
+        {
+            stat::Phase insert("insert");
+            for(size_t i = 0; i < options.num; i++) {
+                insert_func(ds, options.perm_values(i) + 1);
+            }
+        }
+        
+        const size_t ops_per_thread = options.num_queries / num_threads;
+        std::atomic<uint64_t> chk = 0;
+        uint64_t time_mt;
+        {
+            auto run = [&](const size_t t){
+                uint64_t local_chk = 0;
+                bool inserted = false;
+                key_t pending;
+                
+                const size_t first = t * ops_per_thread;
+                for(size_t i = first; i < first + ops_per_thread; i++) {
+                    if(is_update(i)) {
+                        if(inserted) {
+                            remove_func(ds, pending);
+                        } else {
+                            // keys beyond the input are unique per operation
+                            pending = options.perm_values(options.num + i) + 1;
+                            insert_func(ds, pending);
+                        }
+                        inserted = !inserted;
+                    } else {
+                        const auto r = pred_func(ds, options.perm_queries(i));
+                        if(r.exists) local_chk += (uint64_t)r.key;
+                    }
+                }
+                if(inserted) remove_func(ds, pending);
+                chk += local_chk;
+            };
+            
+            const uint64_t t0 = stat::time_nanos();
+            std::vector<std::thread> threads;
+            threads.reserve(num_threads - 1);
+            for(size_t t = 1; t < num_threads; t++) {
+                threads.emplace_back(run, t);
+            }
+            run(0);
+            for(auto& thread : threads) thread.join();
+            time_mt = stat::time_nanos() - t0;
+        }
+        
+        const size_t ops_total = ops_per_thread * num_threads;
+        result.log("ops_total", ops_total);
+        result.log("time_mt", (double)(time_mt / 1000ULL) / 1000.0);
+        result.log("mops", (double)ops_total / (double)std::max(time_mt, uint64_t(1)) * 1000.0);
+        result.log("chk", chk.load());
+        
+        std::cout << "RESULT algo=" << name << " " << result.to_keyval() << " " << result.subphases_keyval() << std::endl;
+        
+        if(num_threads >= options.max_threads) break;
+    }
+}
+
+template<typename key_t>
+void benchmark_mt() {
+    bench_mt<key_t>("btree_mutex_64",
+        [](const key_t){ return Locked<pred::dynamic::BTree<key_t, 65, pred::dynamic::SortedArrayNode<key_t, 64, false>>, std::mutex>(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench_mt<key_t>("btree_rwlock_64",
+        [](const key_t){ return Locked<pred::dynamic::BTree<key_t, 65, pred::dynamic::SortedArrayNode<key_t, 64, false>>, std::shared_mutex>(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench_mt<key_t>("concurrent_btree_16",
+        [](const key_t){ return pred::dynamic::ConcurrentBTree<key_t, 17>(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench_mt<key_t>("concurrent_btree_64",
+        [](const key_t){ return pred::dynamic::ConcurrentBTree<key_t, 65>(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench_mt<key_t>("sharded_btree_64",
+        [](const key_t){ return pred::dynamic::Sharded<key_t, pred::dynamic::BTree<key_t, 65, pred::dynamic::SortedArrayNode<key_t, 64, false>>, 6>(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench_mt<key_t>("sharded_index_hybrid_16",
+        [](const key_t){ return pred::dynamic::Sharded<key_t, pred::dynamic::DynIndex<key_t, 16, pred::dynamic::bucket_hybrid<key_t, 16, 1023>, pred::dynamic::paged_top<pred::dynamic::bucket_hybrid<key_t, 16, 1023>, 4>>, 6>(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench_mt<key_t>("sharded_yfast_trie-08",
+        [](const key_t){ return pred::dynamic::Sharded<key_t, pred::dynamic::YFastTrie<pred::dynamic::yfast_bucket<key_t, 8>, std::numeric_limits<key_t>::digits>, 6>(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
 }
 
 template<typename key_t, typename sort_func_t>
@@ -395,6 +1092,13 @@ void benchmark_arbitrary_universe() {
         [](const auto& ds, const key_t x){ return ds.predecessor(x); },
         [](auto& ds, const key_t x){ ds.remove(x); }
     );
+    bench<key_t>("fusion_btree_32",
+        [](const key_t){ return pred::dynamic::BTree<key_t, 33, pred::dynamic::DynamicFusionNode<key_t, 32, false>>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
     bench<key_t>("fusion_btree_lin_8",
         [](const key_t){ return pred::dynamic::BTree<key_t, 9, pred::dynamic::DynamicFusionNode<key_t, 8, true>>(); },
         [](const auto& ds){ return ds.size(); },
@@ -409,6 +1113,20 @@ void benchmark_arbitrary_universe() {
         [](const auto& ds, const key_t x){ return ds.predecessor(x); },
         [](auto& ds, const key_t x){ ds.remove(x); }
     );
+    bench<key_t>("fusion_btree_lin_32",
+        [](const key_t){ return pred::dynamic::BTree<key_t, 33, pred::dynamic::DynamicFusionNode<key_t, 32, true>>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench<key_t>("fusion_btree_pool_8",
+        [](const key_t){ return pred::dynamic::BTree<key_t, 9, pred::dynamic::DynamicFusionNode<key_t, 8, false>, pred::dynamic::PoolNodeAllocator>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
     bench<key_t>("btree_8",
         [](const key_t){ return pred::dynamic::BTree<key_t, 9, pred::dynamic::SortedArrayNode<key_t, 8, false>>(); },
         [](const auto& ds){ return ds.size(); },
@@ -416,6 +1134,13 @@ void benchmark_arbitrary_universe() {
         [](const auto& ds, const key_t x){ return ds.predecessor(x); },
         [](auto& ds, const key_t x){ ds.remove(x); }
     );
+    bench<key_t>("btree_pool_8",
+        [](const key_t){ return pred::dynamic::BTree<key_t, 9, pred::dynamic::SortedArrayNode<key_t, 8, false>, pred::dynamic::PoolNodeAllocator>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
     bench<key_t>("btree_16",
         [](const key_t){ return pred::dynamic::BTree<key_t, 17, pred::dynamic::SortedArrayNode<key_t, 17, false>>(); },
         [](const auto& ds){ return ds.size(); },
@@ -430,6 +1155,13 @@ void benchmark_arbitrary_universe() {
         [](const auto& ds, const key_t x){ return ds.predecessor(x); },
         [](auto& ds, const key_t x){ ds.remove(x); }
     );
+    bench<key_t>("btree_pool_64",
+        [](const key_t){ return pred::dynamic::BTree<key_t, 65, pred::dynamic::SortedArrayNode<key_t, 64, false>, pred::dynamic::PoolNodeAllocator>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
     bench<key_t>("btree_128",
         [](const key_t){ return pred::dynamic::BTree<key_t, 129, pred::dynamic::SortedArrayNode<key_t, 128, false>>(); },
         [](const auto& ds){ return ds.size(); },
@@ -479,6 +1211,34 @@ void benchmark_arbitrary_universe() {
         [](const auto& ds, const key_t x){ return ds.predecessor(x); },
         [](auto& ds, const key_t x){ ds.remove(x); }
     );
+    bench<key_t>("bplus_fusion_8",
+        [](const key_t){ return pred::dynamic::BPlusTree<key_t, 9, pred::dynamic::DynamicFusionNode<key_t, 8, false>, 64>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench<key_t>("bplus_64",
+        [](const key_t){ return pred::dynamic::BPlusTree<key_t, 65, pred::dynamic::SortedArrayNode<key_t, 64, false>, 64>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench<key_t>("bplus_pool_64",
+        [](const key_t){ return pred::dynamic::BPlusTree<key_t, 65, pred::dynamic::SortedArrayNode<key_t, 64, false>, 64, pred::dynamic::PoolNodeAllocator>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
+    bench<key_t>("bplus_bs_64_256",
+        [](const key_t){ return pred::dynamic::BPlusTree<key_t, 65, pred::dynamic::SortedArrayNode<key_t, 64, true>, 256>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert(x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor(x); },
+        [](auto& ds, const key_t x){ ds.remove(x); }
+    );
     bench<key_t>("set",
         [](const key_t){ return std::set<key_t>(); },
         [](const auto& set){ return set.size(); },
@@ -556,6 +1316,60 @@ void benchmark_large_universe() {
         [](const auto& ds, const key_t x){ return ds.predecessor((uint64_t)x); },
         [](auto& ds, const key_t x){ ds.remove((uint64_t)x); }
     );
+    bench<key_t>("yfast_trie_compact-07",
+        [](const key_t){ return pred::dynamic::YFastTrie<pred::dynamic::yfast_bucket<key_t, 7>, std::numeric_limits<key_t>::digits, pred::dynamic::xfast_compact_table>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert((uint64_t)x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor((uint64_t)x); },
+        [](auto& ds, const key_t x){ ds.remove((uint64_t)x); }
+    );
+    bench<key_t>("yfast_trie_compact-08",
+        [](const key_t){ return pred::dynamic::YFastTrie<pred::dynamic::yfast_bucket<key_t, 8>, std::numeric_limits<key_t>::digits, pred::dynamic::xfast_compact_table>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert((uint64_t)x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor((uint64_t)x); },
+        [](auto& ds, const key_t x){ ds.remove((uint64_t)x); }
+    );
+    bench<key_t>("yfast_trie_sl_compact-08",
+        [](const key_t){ return pred::dynamic::YFastTrie<pred::dynamic::yfast_bucket_sl<key_t, 8>, std::numeric_limits<key_t>::digits, pred::dynamic::xfast_compact_table>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert((uint64_t)x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor((uint64_t)x); },
+        [](auto& ds, const key_t x){ ds.remove((uint64_t)x); }
+    );
+    bench<key_t>("index_paged_list_16",
+        [](const key_t){ return pred::dynamic::DynIndex<key_t, 16, tdc::pred::dynamic::bucket_list<key_t, 16>, pred::dynamic::paged_top<tdc::pred::dynamic::bucket_list<key_t, 16>, 4>>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert((uint64_t)x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor((uint64_t)x); },
+        [](auto& ds, const key_t x){ ds.remove((uint64_t)x); }
+    );
+    bench<key_t>("index_paged_hybrid_16",
+        [](const key_t){ return pred::dynamic::DynIndex<key_t, 16, tdc::pred::dynamic::bucket_hybrid<key_t, 16, 1023>, pred::dynamic::paged_top<tdc::pred::dynamic::bucket_hybrid<key_t, 16, 1023>, 4>>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert((uint64_t)x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor((uint64_t)x); },
+        [](auto& ds, const key_t x){ ds.remove((uint64_t)x); }
+    );
+    bench<key_t>("index_paged_hybrid_24",
+        [](const key_t){ return pred::dynamic::DynIndex<key_t, 24, tdc::pred::dynamic::bucket_hybrid<key_t, 24, 1023>, pred::dynamic::paged_top<tdc::pred::dynamic::bucket_hybrid<key_t, 24, 1023>, 4>>(); },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert((uint64_t)x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor((uint64_t)x); },
+        [](auto& ds, const key_t x){ ds.remove((uint64_t)x); }
+    );
+    bench<key_t>("adaptive_btree_index_hybrid_16",
+        [](const key_t){
+            using sparse_t = pred::dynamic::BTree<uint64_t, 65, pred::dynamic::SortedArrayNode<uint64_t, 64>>;
+            using bucket_t = tdc::pred::dynamic::bucket_hybrid<uint64_t, 16, 1023>;
+            using dense_t = pred::dynamic::DynIndex<uint64_t, 16, bucket_t, pred::dynamic::paged_top<bucket_t, 4>>;
+            return pred::dynamic::Adaptive<sparse_t, dense_t>();
+        },
+        [](const auto& ds){ return ds.size(); },
+        [](auto& ds, const key_t x){ ds.insert((uint64_t)x); },
+        [](const auto& ds, const key_t x){ return ds.predecessor((uint64_t)x); },
+        [](auto& ds, const key_t x){ ds.remove((uint64_t)x); }
+    );
     bench<key_t>("burst_trie",
         [](const key_t){ return LPCBTrieWrapper<key_t>(); },
         [](const auto& trie){ return trie.size(); },
@@ -694,6 +1508,8 @@ void benchmark_tiny_num() {
 const std::string MODE_BASIC = "basic";
 const std::string MODE_OPS = "ops";
 const std::string MODE_SORT = "sort";
+const std::string MODE_MT = "mt";
+const std::string MODE_REPLAY = "replay";
 
 int main(int argc, char** argv) {
 #ifdef TDC_RAPL_AVAILABLE
@@ -702,14 +1518,14 @@ int main(int argc, char** argv) {
 
     std::string mode;
     tlx::CmdlineParser cp_mode;
-    cp_mode.add_param_string("mode", mode, "The benchmark mode (basic, ops, sort)");
+    cp_mode.add_param_string("mode", mode, "The benchmark mode (basic, ops, sort, mt, replay)");
     if(argc < 2) {
         cp_mode.print_usage();
         return -1;
     }
 
     mode = argv[1];
-    if(mode != MODE_BASIC && mode != MODE_OPS && mode != MODE_SORT) {
+    if(mode != MODE_BASIC && mode != MODE_OPS && mode != MODE_SORT && mode != MODE_MT && mode != MODE_REPLAY) {
         cp_mode.print_usage();
         return -1;
     }
@@ -719,6 +1535,14 @@ int main(int argc, char** argv) {
     if(mode == MODE_OPS) {
         // ops
         cp.add_param_string("ops", options.ops_filename, "The file containing the operation sequence to benchmark, if any.");
+        cp.add_size_t("latency-sample", options.latency_sample, "Measure the latency of every n-th operation (default: 0, disabled).");
+    } else if(mode == MODE_REPLAY) {
+        // replay traces simultaneously
+        options.latency_sample = 64;
+        cp.add_param_stringlist("traces", options.traces, "The files containing the operation sequences, each replayed by its own thread.");
+        cp.add_flag("shared", options.shared, "Replay all traces on a single shared data structure rather than one per thread.");
+        cp.add_size_t("latency-sample", options.latency_sample, "Measure the latency of every n-th operation (default: 64).");
+        cp.add_flag("json", options.json, "Additionally print the results, including those of each thread, as JSON.");
     } else {
         cp.add_bytes('n', "num", options.num, "The length of the sequence (default: 1M).");
         cp.add_bytes('u', "universe", options.universe, "The base-2 logarithm of the universe to draw from (default: 2x num)");
@@ -727,7 +1551,16 @@ int main(int argc, char** argv) {
         if(mode == MODE_BASIC) {
             // basic
             cp.add_bytes('q', "queries", options.num_queries, "The number to draw from the universe (default: 1M).");
+            cp.add_bytes("range-queries", options.num_range_queries, "The number of range queries (default: 100K).");
+            cp.add_bytes("range-keys", options.range_keys, "The expected number of keys covered by a range query (default: 100).");
             cp.add_flag("check", options.check, "Check results for correctness.");
+        } else if(mode == MODE_MT) {
+            // multi-threaded
+            cp.add_bytes('q', "queries", options.num_queries, "The total number of operations, distributed over the threads (default: 1M).");
+            cp.add_bytes('t', "threads", options.max_threads, "The maximum number of threads (default: number of hardware threads).");
+            cp.add_double("update-ratio", options.update_ratio, "The fraction of operations that are updates (default: 0.1).");
+            cp.add_string("ops", options.ops_filename, "Replay the operation sequence in the given file instead of random operations.");
+            cp.add_size_t("latency-sample", options.latency_sample, "When replaying, measure the latency of every n-th operation (default: 0, disabled).");
         } else {
             // sort
             options.num_queries = 0;
@@ -738,7 +1571,28 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    if(options.has_opsfile()) {
+    if(mode == MODE_REPLAY) {
+        if(options.traces.empty()) {
+            std::cout << "nothing to do!" << std::endl;
+            return 0;
+        }
+        
+        // read the universes of all traces, which must use the same key type
+        auto key_bits = [](const uint64_t u){ return u <= 32 ? 32 : u <= 40 ? 40 : 64; };
+        for(size_t t = 0; t < options.traces.size(); t++) {
+            std::ifstream in(options.traces[t]);
+            uint64_t universe;
+            if(!in.read((char*)&universe, sizeof(universe))) {
+                std::cerr << "cannot read trace: " << options.traces[t] << std::endl;
+                return -1;
+            }
+            if(t > 0 && key_bits(universe) != key_bits(options.universe)) {
+                std::cerr << "traces must use the same key type" << std::endl;
+                return -1;
+            }
+            options.universe = std::max(options.universe, universe);
+        }
+    } else if(options.has_opsfile()) {
         // process ops only
         options.num = 0;
         
@@ -756,7 +1610,7 @@ int main(int argc, char** argv) {
         }
         
         const uint64_t u = UINT64_MAX >> (64 - options.universe);
-        if(u < options.num + 1) {
+        if(u < options.num + 1 || (mode == MODE_MT && u - 1 < options.num + options.num_queries)) {
             std::cerr << "universe not large enough" << std::endl;
             return -1;
         }
@@ -778,11 +1632,30 @@ int main(int argc, char** argv) {
         }
         
         options.perm_queries = random::Permutation(u, options.seed ^ 0x1234ABCD);
+        
+        // keys are spread uniformly, so a range query is expected to cover range_keys keys if it spans that many average gaps
+        const uint64_t gap = u / (options.num + 1);
+        options.range_width = (options.range_keys <= u / std::max(gap, uint64_t(1))) ? gap * options.range_keys : u;
     } else {
         std::cout << "nothing to do!" << std::endl;
         return 0;
     }
     
+    if(mode == MODE_MT || mode == MODE_REPLAY) {
+        options.max_threads = std::max(options.max_threads, size_t(1));
+        if(options.universe <= 32) {
+            benchmark_mt<uint32_t>();
+        } else if(options.universe <= 40) {
+            benchmark_mt<uint40_t>();
+        } else if(options.universe <= 64) {
+            benchmark_mt<uint64_t>();
+        } else {
+            std::cerr << "multi-threaded benchmark currently only supports universes up to 64 bits" << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+    
     if(options.num <= 1024) {
         if(options.universe <= 32) {
             benchmark_tiny_num<uint32_t>();
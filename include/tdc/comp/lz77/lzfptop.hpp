@@ -21,7 +21,7 @@ class LZFingerprintingTop {
     static constexpr bool verbose_ = true;
     
     using RollingFP = hash::RollingKarpRabinFingerprint;
-    using Sketch = AugmentedSketch<uint64_t, index_t>;
+    using Sketch = AugmentedSketch<uint64_t, index_t, CountMinSketch<uint64_t, uint32_t>>;
 
     struct Layer {
         index_t   tau_exp;
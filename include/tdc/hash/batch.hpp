@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+namespace tdc {
+namespace hash {
+
+/// \brief Finds multiple keys in a hash table and stores the result of each lookup.
+///
+/// This is a uniform interface to batched lookups. Tables that provide a \c find_batch member function,
+/// like \ref Table and \ref SwissTable, prefetch the home slots of the keys before resolving the probes.
+/// Other tables, like the \c robin_hood maps, do not expose their slots, so the keys are looked up one after another.
+/// Since the lookups do not depend on each other, the processor may still overlap some of them.
+///
+/// \tparam table_t the table type
+/// \tparam K the key type
+/// \tparam result_t the lookup result type, i.e., the \c Accessor of a tdc table or the \c const_iterator of a standard library-style table
+/// \param table the table
+/// \param keys the keys in question
+/// \param n the number of keys
+/// \param out receives the lookup result for each key, must have space for \c n results
+template<typename table_t, typename K, typename result_t>
+void find_batch(const table_t& table, const K* keys, const size_t n, result_t* out) {
+    if constexpr(requires { table.find_batch(keys, n, out); }) {
+        table.find_batch(keys, n, out);
+    } else {
+        for(size_t i = 0; i < n; i++) {
+            out[i] = table.find(keys[i]);
+        }
+    }
+}
+
+}} // namespace tdc::hash
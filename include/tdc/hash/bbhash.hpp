@@ -0,0 +1,373 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace tdc {
+namespace hash {
+
+/// \brief A minimal perfect hash function for a static set of integer keys, following the BBHash design.
+///
+/// The function maps the \c n keys of the set bijectively to the range <tt>[0, n)</tt>.
+/// It consists of a sequence of levels, each of which is a bit vector of \c gamma times as many bits as keys remain for that level.
+/// Every key is hashed to a position in the bit vector of the first level, and the bit is set if no other key is hashed to it.
+/// Keys that collide are passed on to the next level. The value of a key is the rank of its bit across all levels.
+/// Keys that still collide after the last level are stored explicitly.
+///
+/// For <tt>gamma = 2</tt>, the function takes about 3.7 bits per key including the rank support, and is evaluated in constant expected time.
+/// Each level is built in parallel, because the keys only need to be partitioned among threads.
+///
+/// The function is stored in a single array of 64-bit words, which can be written to a file and used from a memory mapping without copying (see \ref view).
+/// For keys that are not in the set, the function returns an arbitrary value.
+class BBHash {
+public:
+    /// \brief The current version of the serialized format.
+    static constexpr uint16_t VERSION = 1;
+
+    /// \brief The maximum number of levels.
+    static constexpr size_t MAX_LEVELS = 32;
+
+    /// \brief The header of a serialized function, followed by its data.
+    struct Header {
+        char     magic[4];     ///< always \c TDCH
+        uint16_t version;      ///< the format version
+        uint16_t num_levels;   ///< the number of levels
+        uint64_t num;          ///< the number of keys
+        uint64_t num_words;    ///< the total number of words in the bit vectors of all levels
+        uint64_t num_fallback; ///< the number of explicitly stored keys
+    } __attribute__((__packed__));
+
+    static_assert(sizeof(Header) == 32);
+
+private:
+    static constexpr size_t RANK_BLOCK = 8; // the number of words per rank sample
+
+    static uint64_t mix(uint64_t x) {
+        // the finalizer of MurmurHash3
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDULL;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    static uint64_t level_seed(const uint64_t seed, const size_t level) {
+        return mix(seed + 0x9E3779B97F4A7C15ULL * (level + 1));
+    }
+
+    // maps a key to a position in a bit vector of the given size
+    static uint64_t position(const uint64_t x, const uint64_t seed, const uint64_t bits) {
+        return uint64_t(((unsigned __int128)mix(x ^ seed) * bits) >> 64);
+    }
+
+    static size_t num_rank_samples(const size_t num_words) {
+        return num_words / RANK_BLOCK + 1;
+    }
+
+    // layout of the data words after the header: level seeds, level word offsets, bit vectors, rank samples, fallback keys, fallback values
+    static size_t data_words(const Header& h) {
+        return sizeof(Header) / sizeof(uint64_t)
+            + h.num_levels + (h.num_levels + 1)
+            + h.num_words + num_rank_samples(h.num_words)
+            + 2 * h.num_fallback;
+    }
+
+    // computes the number of data words for an untrusted header, throwing if it exceeds the given number of available words
+    static size_t checked_data_words(const Header& h, size_t available) {
+        auto take = [&](const uint64_t words){
+            if(words > available) throw std::runtime_error("truncated minimal perfect hash function");
+            available -= words;
+        };
+        take(sizeof(Header) / sizeof(uint64_t));
+        take(2 * uint64_t(h.num_levels) + 1);
+        take(h.num_words);
+        take(num_rank_samples(h.num_words));
+        take(h.num_fallback);
+        take(h.num_fallback);
+        return data_words(h);
+    }
+
+    std::vector<uint64_t> m_storage; // empty if the function is a view
+    const uint64_t* m_data;
+
+    Header m_header;
+    const uint64_t* m_seeds;
+    const uint64_t* m_offsets;
+    const uint64_t* m_bits;
+    const uint64_t* m_ranks;
+    const uint64_t* m_fallback_keys;
+    const uint64_t* m_fallback_values;
+
+    void attach(const uint64_t* data) {
+        m_data = data;
+        std::memcpy(&m_header, data, sizeof(Header));
+
+        m_seeds = data + sizeof(Header) / sizeof(uint64_t);
+        m_offsets = m_seeds + m_header.num_levels;
+        m_bits = m_offsets + m_header.num_levels + 1;
+        m_ranks = m_bits + m_header.num_words;
+        m_fallback_keys = m_ranks + num_rank_samples(m_header.num_words);
+        m_fallback_values = m_fallback_keys + m_header.num_fallback;
+    }
+
+    static void check_header(const Header& header) {
+        if(std::memcmp(header.magic, "TDCH", 4) != 0) {
+            throw std::runtime_error("not a minimal perfect hash function");
+        }
+        if(header.version != VERSION) {
+            throw std::runtime_error("unsupported minimal perfect hash function version");
+        }
+        if(header.num_levels > MAX_LEVELS) {
+            throw std::runtime_error("corrupt minimal perfect hash function");
+        }
+    }
+
+    uint64_t rank(const uint64_t pos) const {
+        const uint64_t w = pos / 64;
+        const uint64_t block = w / RANK_BLOCK;
+        uint64_t r = m_ranks[block];
+        for(uint64_t i = block * RANK_BLOCK; i < w; i++) r += __builtin_popcountll(m_bits[i]);
+        return r + __builtin_popcountll(m_bits[w] & ((1ULL << (pos % 64)) - 1));
+    }
+
+    // runs the given function for each range of a partition of [0, n) into the given number of ranges, which may be empty
+    template<typename func_t>
+    static void parallel(const size_t n, const size_t num_threads, func_t func) {
+        if(num_threads <= 1) {
+            func(0, 0, n);
+        } else if(n < num_threads) {
+            // not worth spawning threads, but every range must be processed
+            for(size_t t = 0; t < num_threads; t++) func(t, n * t / num_threads, n * (t + 1) / num_threads);
+        } else {
+            std::vector<std::thread> threads;
+            for(size_t t = 0; t < num_threads; t++) {
+                threads.emplace_back([&, t](){ func(t, n * t / num_threads, n * (t + 1) / num_threads); });
+            }
+            for(auto& thread : threads) thread.join();
+        }
+    }
+
+public:
+    /// \brief Constructs the function for an empty set.
+    BBHash() : BBHash(nullptr, 0) {
+    }
+
+    /// \brief Builds the function for a set of keys.
+    /// \param keys the keys, which must be distinct
+    /// \param n the number of keys
+    /// \param gamma the ratio of bits per remaining key in each level, trading space for build and evaluation speed; must be at least one
+    /// \param num_threads the number of threads used for the build
+    /// \param seed the seed for the hash functions
+    BBHash(const uint64_t* keys, const size_t n, const double gamma = 2.0, const size_t num_threads = 1, const uint64_t seed = 0) {
+        if(gamma < 1.0) throw std::invalid_argument("gamma must be at least one");
+
+        std::vector<uint64_t> seeds;
+        std::vector<uint64_t> offsets = { 0 };
+        std::vector<uint64_t> bits;
+
+        // the keys remaining for the current level, initially all of them
+        std::vector<uint64_t> remaining;
+        const uint64_t* level_keys = keys;
+        size_t num_remaining = n;
+
+        std::vector<std::vector<uint64_t>> next(std::max(num_threads, size_t(1)));
+        while(num_remaining > 0 && seeds.size() < MAX_LEVELS) {
+            const size_t level = seeds.size();
+            const uint64_t s = level_seed(seed, level);
+            const size_t num_words = std::max(size_t(1), size_t((gamma * (double)num_remaining + 63.0) / 64.0));
+            const uint64_t num_bits = 64 * num_words;
+
+            // mark the positions hit by exactly one key
+            std::vector<std::atomic<uint64_t>> hit(num_words), collision(num_words);
+            for(size_t i = 0; i < num_words; i++) {
+                hit[i].store(0, std::memory_order_relaxed);
+                collision[i].store(0, std::memory_order_relaxed);
+            }
+            parallel(num_remaining, num_threads, [&](size_t, const size_t begin, const size_t end){
+                for(size_t i = begin; i < end; i++) {
+                    const uint64_t p = position(level_keys[i], s, num_bits);
+                    const uint64_t mask = 1ULL << (p % 64);
+                    if(hit[p / 64].fetch_or(mask, std::memory_order_relaxed) & mask) {
+                        collision[p / 64].fetch_or(mask, std::memory_order_relaxed);
+                    }
+                }
+            });
+
+            const size_t level_offset = bits.size();
+            bits.resize(level_offset + num_words);
+            for(size_t i = 0; i < num_words; i++) {
+                bits[level_offset + i] = hit[i].load(std::memory_order_relaxed) & ~collision[i].load(std::memory_order_relaxed);
+            }
+
+            // pass the colliding keys on to the next level
+            parallel(num_remaining, num_threads, [&](const size_t t, const size_t begin, const size_t end){
+                next[t].clear();
+                for(size_t i = begin; i < end; i++) {
+                    const uint64_t p = position(level_keys[i], s, num_bits);
+                    if(!((bits[level_offset + p / 64] >> (p % 64)) & 1)) next[t].push_back(level_keys[i]);
+                }
+            });
+
+            std::vector<uint64_t> colliding;
+            for(const auto& v : next) colliding.insert(colliding.end(), v.begin(), v.end());
+            remaining = std::move(colliding);
+            level_keys = remaining.data();
+            num_remaining = remaining.size();
+
+            seeds.push_back(s);
+            offsets.push_back(bits.size());
+        }
+
+        // store the remaining keys explicitly, sorted for binary search
+        std::sort(remaining.begin(), remaining.end());
+        if(std::adjacent_find(remaining.begin(), remaining.end()) != remaining.end()) {
+            throw std::invalid_argument("keys are not distinct");
+        }
+
+        Header header;
+        std::memcpy(header.magic, "TDCH", 4);
+        header.version = VERSION;
+        header.num_levels = seeds.size();
+        header.num = n;
+        header.num_words = bits.size();
+        header.num_fallback = remaining.size();
+
+        m_storage.reserve(data_words(header));
+        m_storage.resize(sizeof(Header) / sizeof(uint64_t));
+        std::memcpy(m_storage.data(), &header, sizeof(Header));
+        m_storage.insert(m_storage.end(), seeds.begin(), seeds.end());
+        m_storage.insert(m_storage.end(), offsets.begin(), offsets.end());
+        m_storage.insert(m_storage.end(), bits.begin(), bits.end());
+
+        uint64_t r = 0;
+        for(size_t i = 0; i < bits.size(); i++) {
+            if(i % RANK_BLOCK == 0) m_storage.push_back(r);
+            r += __builtin_popcountll(bits[i]);
+        }
+        if(bits.size() % RANK_BLOCK == 0) m_storage.push_back(r);
+
+        m_storage.insert(m_storage.end(), remaining.begin(), remaining.end());
+        for(size_t i = 0; i < remaining.size(); i++) m_storage.push_back(r + i);
+
+        assert(m_storage.size() == data_words(header));
+        attach(m_storage.data());
+    }
+
+    /// \brief Constructs a function that uses serialized data without copying it, e.g., from a memory mapped file.
+    ///
+    /// The data must remain valid and unchanged for as long as the function is used.
+    ///
+    /// \param data the serialized data, must be aligned to eight bytes
+    /// \param size the size of the serialized data in bytes
+    static BBHash view(const void* data, const size_t size) {
+        if(size < sizeof(Header)) {
+            throw std::runtime_error("truncated minimal perfect hash function");
+        }
+        if((uintptr_t)data % alignof(uint64_t) != 0) {
+            throw std::invalid_argument("minimal perfect hash function data is not aligned");
+        }
+
+        Header header;
+        std::memcpy(&header, data, sizeof(Header));
+        check_header(header);
+        checked_data_words(header, size / sizeof(uint64_t));
+
+        BBHash f;
+        f.m_storage.clear();
+        f.attach((const uint64_t*)data);
+        return f;
+    }
+
+    /// \brief Reads a serialized function from a stream.
+    /// \param in the input stream
+    static BBHash read(std::istream& in) {
+        Header header;
+        if(!in.read((char*)&header, sizeof(Header))) {
+            throw std::runtime_error("truncated minimal perfect hash function");
+        }
+        check_header(header);
+
+        // the header is untrusted, so the data is read in chunks rather than allocating its claimed size up front
+        const size_t total = checked_data_words(header, std::numeric_limits<size_t>::max() / sizeof(uint64_t));
+        constexpr size_t CHUNK = 1ULL << 20;
+
+        BBHash f;
+        f.m_storage.resize(sizeof(Header) / sizeof(uint64_t));
+        std::memcpy(f.m_storage.data(), &header, sizeof(Header));
+        while(f.m_storage.size() < total) {
+            const size_t offset = f.m_storage.size();
+            const size_t num = std::min(CHUNK, total - offset);
+            f.m_storage.resize(offset + num);
+            if(!in.read((char*)(f.m_storage.data() + offset), num * sizeof(uint64_t))) {
+                throw std::runtime_error("truncated minimal perfect hash function");
+            }
+        }
+        f.attach(f.m_storage.data());
+        return f;
+    }
+
+    BBHash(const BBHash&) = delete;
+    BBHash(BBHash&&) = default;
+    BBHash& operator=(const BBHash&) = delete;
+    BBHash& operator=(BBHash&&) = default;
+
+    /// \brief Writes the function to a stream in a form that can be used with \ref view.
+    /// \param out the output stream
+    void write(std::ostream& out) const {
+        out.write((const char*)m_data, size_bytes());
+    }
+
+    /// \brief Returns a pointer to the serialized function.
+    const void* data() const {
+        return m_data;
+    }
+
+    /// \brief Reports the size of the serialized function in bytes.
+    size_t size_bytes() const {
+        return data_words(m_header) * sizeof(uint64_t);
+    }
+
+    /// \brief Reports the number of keys in the set, which is also the size of the range of the function.
+    size_t size() const {
+        return m_header.num;
+    }
+
+    /// \brief Reports the number of levels.
+    size_t num_levels() const {
+        return m_header.num_levels;
+    }
+
+    /// \brief Reports the number of keys that are stored explicitly, because they collided on all levels.
+    size_t num_fallback() const {
+        return m_header.num_fallback;
+    }
+
+    /// \brief Computes the value of a key.
+    /// \param x the key
+    /// \return a value in <tt>[0, n)</tt> that is distinct for all keys in the set, or an arbitrary value if the key is not in the set
+    uint64_t operator()(const uint64_t x) const {
+        for(size_t level = 0; level < m_header.num_levels; level++) {
+            const uint64_t offset = m_offsets[level];
+            const uint64_t p = position(x, m_seeds[level], 64 * (m_offsets[level + 1] - offset));
+            const uint64_t pos = 64 * offset + p;
+            if((m_bits[pos / 64] >> (pos % 64)) & 1) return rank(pos);
+        }
+
+        const uint64_t* end = m_fallback_keys + m_header.num_fallback;
+        const uint64_t* it = std::lower_bound(m_fallback_keys, end, x);
+        return (it != end && *it == x) ? m_fallback_values[it - m_fallback_keys] : 0;
+    }
+};
+
+}} // namespace tdc::hash
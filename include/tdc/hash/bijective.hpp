@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <tdc/math/bit_mask.hpp>
+
+namespace tdc {
+namespace hash {
+
+/// \brief A bijective hash function on integers of a fixed bit width.
+///
+/// The hash function alternates xorshifts and multiplications with odd constants modulo <tt>2^bits</tt>, both of which are invertible.
+/// Because it is a permutation of the universe, a hash table can store only a part of the hash value and restore the key from it (see \ref QuotientSet).
+class MultiplyXorShift {
+private:
+    // computes the multiplicative inverse of an odd number modulo 2^64 using Newton's method
+    static constexpr uint64_t mul_inverse(const uint64_t a) {
+        uint64_t x = a; // correct to three bits
+        for(size_t i = 0; i < 5; i++) x *= 2 - a * x; // doubles the number of correct bits
+        return x;
+    }
+
+    size_t   m_bits;
+    uint64_t m_mask;
+    size_t   m_shift;
+    uint64_t m_mul1, m_mul2;
+    uint64_t m_inv1, m_inv2;
+
+    uint64_t xorshift(const uint64_t x) const {
+        return m_shift ? x ^ (x >> m_shift) : x;
+    }
+
+    uint64_t inverse_xorshift(const uint64_t y) const {
+        if(!m_shift) return y;
+
+        uint64_t x = y;
+        for(size_t s = m_shift; s < m_bits; s += m_shift) {
+            x = y ^ (x >> m_shift);
+        }
+        return x;
+    }
+
+public:
+    /// \brief Constructs the hash function for one-bit integers.
+    MultiplyXorShift() : MultiplyXorShift(1) {
+    }
+
+    /// \brief Main constructor.
+    /// \param bits the bit width of the hashed integers
+    /// \param seed the seed for the multipliers
+    MultiplyXorShift(const size_t bits, const uint64_t seed = 0) : m_bits(bits), m_mask(math::bit_mask<uint64_t>(bits)), m_shift(bits / 2) {
+        assert(bits > 0 && bits <= 64);
+        m_mul1 = (0xBF58476D1CE4E5B9ULL ^ (seed * 0x9E3779B97F4A7C15ULL)) | 1ULL;
+        m_mul2 = (0x94D049BB133111EBULL ^ (seed * 0xC2B2AE3D27D4EB4FULL)) | 1ULL;
+        m_inv1 = mul_inverse(m_mul1);
+        m_inv2 = mul_inverse(m_mul2);
+    }
+
+    MultiplyXorShift(const MultiplyXorShift&) = default;
+    MultiplyXorShift(MultiplyXorShift&&) = default;
+    MultiplyXorShift& operator=(const MultiplyXorShift&) = default;
+    MultiplyXorShift& operator=(MultiplyXorShift&&) = default;
+
+    /// \brief Computes the hash value for a key.
+    /// \param x the key, must be less than <tt>2^bits</tt>
+    uint64_t operator()(const uint64_t x) const {
+        assert((x & ~m_mask) == 0);
+        uint64_t h = xorshift(x);
+        h = (h * m_mul1) & m_mask;
+        h = xorshift(h);
+        h = (h * m_mul2) & m_mask;
+        return xorshift(h);
+    }
+
+    /// \brief Restores the key from its hash value.
+    /// \param h the hash value
+    uint64_t inverse(const uint64_t h) const {
+        uint64_t x = inverse_xorshift(h);
+        x = (x * m_inv2) & m_mask;
+        x = inverse_xorshift(x);
+        x = (x * m_inv1) & m_mask;
+        return inverse_xorshift(x);
+    }
+
+    /// \brief Reports the bit width of the hashed integers.
+    size_t bits() const {
+        return m_bits;
+    }
+};
+
+}} // namespace tdc::hash
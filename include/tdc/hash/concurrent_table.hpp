@@ -0,0 +1,357 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#include "function.hpp"
+
+namespace tdc {
+namespace hash {
+
+/// \brief A lock-free concurrent hash set or map for integer keys.
+///
+/// The table uses open addressing with linear probing, and keys are claimed by a compare-and-swap on their slot.
+/// Keys can only be inserted, not erased; the values of a map are written once, when the key is inserted.
+///
+/// Once the load exceeds the load factor, the table grows by migrating all keys into a table of twice the capacity.
+/// Every thread that encounters the migration helps with it: the slots of the old table are frozen and moved chunk by chunk,
+/// and the new table is used as soon as all chunks are done. Old tables are only released when the whole data structure is destroyed,
+/// because other threads may still be reading them; this takes at most as much space as the current table.
+/// If the table is constructed with a fixed capacity, there is no migration, and the checks for it are skipped.
+///
+/// \tparam value_t the value type, or \c void for a set
+/// \tparam t_growable whether the table grows when its load factor is exceeded; otherwise, inserting into a full table throws an exception
+/// \tparam hash_func_t the hash function type
+template<typename value_t = void, bool t_growable = true, typename hash_func_t = Multiplicative>
+class ConcurrentTable {
+private:
+    static constexpr bool is_map = !std::is_void<value_t>::value;
+
+    // keys are stored incremented by one so that zero marks an empty slot, the two highest bits are used for synchronization
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr uint64_t MOVED = 1ULL << 63; // the slot has been frozen for migration
+    static constexpr uint64_t BUSY = 1ULL << 62;  // the key has been claimed, but its value is not yet written
+    static constexpr uint64_t KEY_MASK = BUSY - 1;
+
+    static constexpr size_t MIGRATION_CHUNK = 4096;
+    static constexpr size_t NUM_COUNTERS = 16;
+
+    struct SetSlot {
+        std::atomic<uint64_t> key;
+    };
+
+    struct MapSlot {
+        std::atomic<uint64_t> key;
+        std::conditional_t<is_map, value_t, char> value;
+    };
+
+    using Slot = std::conditional_t<is_map, MapSlot, SetSlot>;
+
+    // insertions are counted in several counters to reduce contention
+    struct alignas(64) Counter {
+        std::atomic<size_t> value = 0;
+    };
+
+    struct Array {
+        size_t cap_bits;
+        size_t cap;
+        size_t size_max;
+        std::unique_ptr<Slot[]> slots;
+        Counter counters[NUM_COUNTERS];
+
+        std::atomic<Array*> next = nullptr; // the table being migrated into
+        std::atomic<size_t> next_chunk = 0;
+        std::atomic<size_t> chunks_done = 0;
+        size_t num_chunks;
+
+        Array(const size_t capacity, const double load_factor) {
+            cap_bits = 4;
+            while((1ULL << cap_bits) < capacity) ++cap_bits;
+            cap = 1ULL << cap_bits;
+            size_max = std::min(cap - 1, size_t(load_factor * (double)cap));
+            slots = std::unique_ptr<Slot[]>(new Slot[cap]);
+            for(size_t i = 0; i < cap; i++) slots[i].key.store(EMPTY, std::memory_order_relaxed);
+            num_chunks = (cap + MIGRATION_CHUNK - 1) / MIGRATION_CHUNK;
+        }
+
+        size_t size() const {
+            size_t sum = 0;
+            for(const auto& c : counters) sum += c.value.load(std::memory_order_relaxed);
+            return sum;
+        }
+    };
+
+    enum class Status { INSERTED, FOUND, MIGRATING };
+
+    hash_func_t m_hash_func;
+    double m_load_factor;
+    Array* m_first;                      // the first table, which owns the chain of tables that followed it
+    mutable std::atomic<Array*> m_table; // the current table
+
+    size_t home(const Array& a, const uint64_t x) const {
+        return size_t((uint64_t(m_hash_func(x)) * 0x9E3779B97F4A7C15ULL) >> (64 - a.cap_bits));
+    }
+
+    // waits until the value of the given slot has been written and returns the key
+    static uint64_t wait_ready(const Slot& slot) {
+        uint64_t k = slot.key.load(std::memory_order_acquire);
+        while(k & BUSY) {
+            std::this_thread::yield();
+            k = slot.key.load(std::memory_order_acquire);
+        }
+        return k;
+    }
+
+    template<typename... value_args_t>
+    Status insert_into(Array& a, const uint64_t enc, const value_args_t&... value) {
+        if constexpr(t_growable) {
+            if(a.next.load(std::memory_order_acquire)) return Status::MIGRATING;
+        }
+
+        size_t pos = home(a, enc - 1);
+        for(size_t probe = 0; probe < a.cap; probe++) {
+            Slot& slot = a.slots[pos];
+            uint64_t k = slot.key.load(std::memory_order_acquire);
+            while(k == EMPTY) {
+                if constexpr(is_map) {
+                    if(slot.key.compare_exchange_weak(k, enc | BUSY, std::memory_order_acq_rel)) {
+                        slot.value = (value, ...); // there is exactly one value
+                        slot.key.store(enc, std::memory_order_release);
+                        count(a, pos);
+                        return Status::INSERTED;
+                    }
+                } else {
+                    if(slot.key.compare_exchange_weak(k, enc, std::memory_order_acq_rel)) {
+                        count(a, pos);
+                        return Status::INSERTED;
+                    }
+                }
+            }
+
+            if constexpr(t_growable) {
+                if(k & MOVED) return Status::MIGRATING;
+            }
+            if((k & KEY_MASK) == enc) return Status::FOUND;
+
+            pos = (pos + 1) & (a.cap - 1);
+        }
+
+        // the table is full
+        if constexpr(t_growable) {
+            start_migration(a);
+            return Status::MIGRATING;
+        } else {
+            throw std::runtime_error("concurrent hash table is full");
+        }
+    }
+
+    void count(Array& a, const size_t pos) {
+        const size_t c = a.counters[pos % NUM_COUNTERS].value.fetch_add(1, std::memory_order_relaxed);
+        if constexpr(t_growable) {
+            // the total is only checked occasionally, so the load factor may be exceeded slightly
+            if((c % 64) == 63 && a.size() > a.size_max) {
+                start_migration(a);
+            }
+        }
+    }
+
+    void start_migration(Array& a) const {
+        if(a.next.load(std::memory_order_acquire) == nullptr) {
+            Array* n = new Array(2 * a.cap, m_load_factor);
+            Array* expected = nullptr;
+            if(!a.next.compare_exchange_strong(expected, n, std::memory_order_acq_rel)) {
+                delete n; // another thread started the migration first
+            }
+        }
+    }
+
+    // places a key frozen in an old table into the new table, in which no other thread can insert the same key
+    static void migrate_key(Array& n, const size_t h, const Slot& src) {
+        size_t pos = h;
+        while(true) {
+            Slot& slot = n.slots[pos];
+            uint64_t k = EMPTY;
+            if(slot.key.load(std::memory_order_relaxed) == EMPTY) {
+                if constexpr(is_map) {
+                    if(slot.key.compare_exchange_strong(k, BUSY, std::memory_order_acq_rel)) {
+                        slot.value = src.value;
+                        slot.key.store(src.key.load(std::memory_order_relaxed) & KEY_MASK, std::memory_order_release);
+                        break;
+                    }
+                } else {
+                    if(slot.key.compare_exchange_strong(k, src.key.load(std::memory_order_relaxed) & KEY_MASK, std::memory_order_acq_rel)) {
+                        break;
+                    }
+                }
+            }
+            pos = (pos + 1) & (n.cap - 1);
+        }
+        n.counters[pos % NUM_COUNTERS].value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // helps migrating the given table into its successor, and returns once the successor has replaced it
+    void help_migration(Array& a) const {
+        Array& n = *a.next.load(std::memory_order_acquire);
+
+        size_t c;
+        while((c = a.next_chunk.fetch_add(1, std::memory_order_acq_rel)) < a.num_chunks) {
+            const size_t end = std::min(a.cap, (c + 1) * MIGRATION_CHUNK);
+            for(size_t pos = c * MIGRATION_CHUNK; pos < end; pos++) {
+                Slot& slot = a.slots[pos];
+
+                // freeze the slot, after waiting for a pending value to be written
+                uint64_t k = wait_ready(slot);
+                while(!slot.key.compare_exchange_weak(k, k | MOVED, std::memory_order_acq_rel)) {
+                    k = wait_ready(slot);
+                }
+
+                if(k != EMPTY) migrate_key(n, home(n, k - 1), slot);
+            }
+            a.chunks_done.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        // wait until all chunks are done before the successor is used
+        while(a.chunks_done.load(std::memory_order_acquire) < a.num_chunks) {
+            std::this_thread::yield();
+        }
+
+        Array* expected = &a;
+        m_table.compare_exchange_strong(expected, &n, std::memory_order_acq_rel);
+    }
+
+    // waits until the table has been replaced if it is being migrated, and returns whether that was the case
+    bool check_migration(Array& a) const {
+        if constexpr(t_growable) {
+            if(a.next.load(std::memory_order_acquire)) {
+                help_migration(a);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static uint64_t encode(const uint64_t x) {
+        assert(x < KEY_MASK);
+        return x + 1;
+    }
+
+    // finds the slot containing the given key, or returns nullptr if it is not contained
+    const Slot* find_slot(const uint64_t x) const {
+        const uint64_t enc = encode(x);
+        while(true) {
+            Array& a = *m_table.load(std::memory_order_acquire);
+
+            bool retry = false;
+            size_t pos = home(a, x);
+            for(size_t probe = 0; probe < a.cap; probe++) {
+                const Slot& slot = a.slots[pos];
+                const uint64_t k = slot.key.load(std::memory_order_acquire);
+                if((k & KEY_MASK) == enc) {
+                    // frozen keys remain valid
+                    if constexpr(is_map) wait_ready(slot);
+                    return &slot;
+                }
+                if((k & ~MOVED) == EMPTY) {
+                    // a frozen empty slot means that the key may already be in the successor
+                    retry = (k & MOVED) && check_migration(a);
+                    break;
+                }
+                pos = (pos + 1) & (a.cap - 1);
+            }
+
+            if(!retry) return nullptr;
+        }
+    }
+
+public:
+    /// \brief Constructs an empty table.
+    /// \param capacity the initial capacity of the table, which is rounded up to a power of two; for a fixed-capacity table, the maximum number of keys is the capacity times the load factor
+    /// \param load_factor the maximum load factor - once reached, the capacity is doubled
+    /// \param hash_func the hash function
+    ConcurrentTable(const size_t capacity = 0, const double load_factor = 0.5, hash_func_t hash_func = hash_func_t())
+        : m_hash_func(hash_func),
+          m_load_factor(load_factor) {
+
+        // a fixed-capacity table is only full if there are no empty slots left
+        m_first = new Array(t_growable ? capacity : size_t(capacity / load_factor), load_factor);
+        m_table.store(m_first);
+    }
+
+    ~ConcurrentTable() {
+        Array* a = m_first;
+        while(a) {
+            Array* next = a->next.load();
+            delete a;
+            a = next;
+        }
+    }
+
+    ConcurrentTable(const ConcurrentTable&) = delete;
+    ConcurrentTable& operator=(const ConcurrentTable&) = delete;
+
+    /// \brief Inserts the given key into the set, unless it is already contained.
+    /// \param x the key, must be less than <tt>2^62 - 1</tt>
+    /// \return whether the key was inserted
+    bool insert(const uint64_t x) requires(!is_map) {
+        const uint64_t enc = encode(x);
+        while(true) {
+            Array& a = *m_table.load(std::memory_order_acquire);
+            const Status s = insert_into(a, enc);
+            if(s != Status::MIGRATING) return s == Status::INSERTED;
+            check_migration(a);
+        }
+    }
+
+    /// \brief Inserts the given key with the given value into the map, unless the key is already contained.
+    /// \param x the key, must be less than <tt>2^62 - 1</tt>
+    /// \param value the value
+    /// \return whether the key was inserted; if not, the value associated to the key remains unchanged
+    template<typename V = value_t>
+    bool insert(const uint64_t x, const V& value) requires(is_map) {
+        const uint64_t enc = encode(x);
+        while(true) {
+            Array& a = *m_table.load(std::memory_order_acquire);
+            const Status s = insert_into(a, enc, value);
+            if(s != Status::MIGRATING) return s == Status::INSERTED;
+            check_migration(a);
+        }
+    }
+
+    /// \brief Tests whether a key exists in the table.
+    /// \param x the key in question
+    bool contains(const uint64_t x) const {
+        return find_slot(x) != nullptr;
+    }
+
+    /// \brief Looks up the value associated to the given key.
+    /// \param x the key in question
+    /// \param value receives the value, if the key is contained
+    /// \return whether the key is contained
+    template<typename V = value_t>
+    bool find(const uint64_t x, V& value) const requires(is_map) {
+        const Slot* slot = find_slot(x);
+        if(slot) value = slot->value;
+        return slot != nullptr;
+    }
+
+    /// \brief Reports the number of contained keys.
+    ///
+    /// The result may not reflect concurrent insertions.
+    size_t size() const {
+        return m_table.load(std::memory_order_acquire)->size();
+    }
+
+    /// \brief The current capacity of the table.
+    size_t capacity() const {
+        return m_table.load(std::memory_order_acquire)->cap;
+    }
+};
+
+}} // namespace tdc::hash
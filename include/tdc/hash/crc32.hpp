@@ -2,6 +2,11 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
+
+#if defined(__SSE4_2__) || defined(__PCLMUL__)
+#include <immintrin.h>
+#endif
 
 #include <tdc/hash/byte.hpp>
 
@@ -10,7 +15,7 @@ namespace hash {
 
 using CRC32Table = std::array<uint32_t, 256>;
 
-constexpr CRC32Table build_crc32_table() {
+constexpr CRC32Table build_crc32_table(const uint32_t poly = 0xEDB88320) {
     CRC32Table table;
     for(uint32_t i = 0; i < 256; i++) {
         uint32_t byte = i;
@@ -18,7 +23,7 @@ constexpr CRC32Table build_crc32_table() {
         for(size_t j=0; j < 8; j++) {
             const uint32_t b = (byte ^ crc) & 1;
             crc >>= 1;
-            if(b) crc = crc ^ 0xEDB88320;
+            if(b) crc = crc ^ poly;
             byte >>= 1;
         }
         table[i] = crc;
@@ -42,4 +47,175 @@ public:
     }
 };
 
+/// \brief CRC-32C, which uses the Castagnoli polynomial and is supported by the \c crc32 instruction of SSE 4.2.
+///
+/// The checksum is computed using the fastest method available on the target architecture:
+/// - with PCLMULQDQ, buffers of at least 64 bytes are folded in four 128-bit lanes using carry-less multiplication,
+/// - with SSE 4.2, the buffer is split into three streams that are processed in an interleaved fashion to hide the latency of the \c crc32 instruction,
+///   and the resulting checksums are combined,
+/// - otherwise, a lookup table is used.
+///
+/// The individual methods are available as static functions that update a CRC register.
+/// The register is the bitwise complement of the checksum, i.e., <tt>~update(~crc, s, n)</tt> extends the checksum \c crc of a buffer by \c n more bytes.
+class CRC32C {
+public:
+    /// \brief The reversed Castagnoli polynomial.
+    static constexpr uint32_t POLY = 0x82F63B78;
+
+private:
+    static constexpr CRC32Table table_ = build_crc32_table(POLY);
+
+    static constexpr size_t INTERLEAVE_BLOCK = 1024; // the number of bytes per stream and block of the interleaved method
+
+    // multiplies two polynomials modulo the polynomial, in reversed representation where the most significant bit is the coefficient of x^0
+    static constexpr uint32_t multiply(const uint32_t a, uint32_t b) {
+        uint32_t p = 0;
+        for(uint32_t m = 1U << 31; m; m >>= 1) {
+            if(a & m) p ^= b;
+            b = (b & 1) ? (b >> 1) ^ POLY : b >> 1;
+        }
+        return p;
+    }
+
+    // computes x^n modulo the polynomial
+    static constexpr uint32_t x_pow(uint64_t n) {
+        uint32_t r = 1U << 31; // x^0
+        uint32_t p = 1U << 30; // x^1
+        while(n) {
+            if(n & 1) r = multiply(r, p);
+            p = multiply(p, p);
+            n >>= 1;
+        }
+        return r;
+    }
+
+    // a folding constant for a distance of d bits, which accounts for the extra factor x introduced by multiplying reversed polynomials
+    static constexpr uint64_t fold_constant(const uint64_t d) {
+        return uint64_t(x_pow(d - 1)) << 32;
+    }
+
+    static uint64_t load64(const Byte* s) {
+        uint64_t w;
+        std::memcpy(&w, s, sizeof(w));
+        return w;
+    }
+
+    #ifdef __PCLMUL__
+    // folds a 128-bit lane over the given distance onto the next lane
+    static __m128i fold(const __m128i x, const __m128i k, const __m128i next) {
+        return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)), next);
+    }
+    #endif
+
+public:
+    /// \brief Updates a CRC register byte by byte using a lookup table.
+    /// \param crc the CRC register
+    /// \param s the bytes
+    /// \param n the number of bytes
+    static uint32_t update_table(uint32_t crc, const Byte* s, const size_t n) {
+        for(size_t i = 0; i < n; i++) {
+            crc = (crc >> 8) ^ table_[(s[i] ^ crc) & 0xFF];
+        }
+        return crc;
+    }
+
+    #ifdef __SSE4_2__
+    /// \brief Updates a CRC register eight bytes at a time using the \c crc32 instruction.
+    /// \param crc the CRC register
+    /// \param s the bytes
+    /// \param n the number of bytes
+    static uint32_t update_sse42(const uint32_t crc, const Byte* s, size_t n) {
+        uint64_t c = crc;
+        for(; n >= 8; s += 8, n -= 8) c = _mm_crc32_u64(c, load64(s));
+
+        uint32_t c32 = uint32_t(c);
+        for(; n; ++s, --n) c32 = _mm_crc32_u8(c32, *s);
+        return c32;
+    }
+
+    /// \brief Updates a CRC register using the \c crc32 instruction on three interleaved streams.
+    ///
+    /// The \c crc32 instruction has a latency of three cycles, but a new one can be issued every cycle.
+    /// Therefore, blocks of the buffer are split into three parts that are processed simultaneously,
+    /// and the checksums of the parts are combined by shifting them over the following parts using polynomial multiplication.
+    ///
+    /// \param crc the CRC register
+    /// \param s the bytes
+    /// \param n the number of bytes
+    static uint32_t update_interleaved(uint32_t crc, const Byte* s, size_t n) {
+        constexpr uint32_t shift = x_pow(8 * INTERLEAVE_BLOCK); // shifts a register over a block of zeroes
+        for(; n >= 3 * INTERLEAVE_BLOCK; s += 3 * INTERLEAVE_BLOCK, n -= 3 * INTERLEAVE_BLOCK) {
+            uint64_t c0 = crc, c1 = 0, c2 = 0;
+            for(size_t i = 0; i < INTERLEAVE_BLOCK; i += 8) {
+                c0 = _mm_crc32_u64(c0, load64(s + i));
+                c1 = _mm_crc32_u64(c1, load64(s + INTERLEAVE_BLOCK + i));
+                c2 = _mm_crc32_u64(c2, load64(s + 2 * INTERLEAVE_BLOCK + i));
+            }
+            crc = multiply(multiply(uint32_t(c0), shift) ^ uint32_t(c1), shift) ^ uint32_t(c2);
+        }
+        return update_sse42(crc, s, n);
+    }
+    #endif
+
+    #if defined(__SSE4_2__) && defined(__PCLMUL__)
+    /// \brief Updates a CRC register by folding the buffer using carry-less multiplication.
+    ///
+    /// Four 128-bit lanes are folded over the following 64 bytes at a time, then the lanes are folded into one.
+    /// Instead of a Barrett reduction, the remaining lane is reduced using the \c crc32 instruction.
+    ///
+    /// \param crc the CRC register
+    /// \param s the bytes
+    /// \param n the number of bytes
+    static uint32_t update_pclmul(const uint32_t crc, const Byte* s, size_t n) {
+        if(n < 64) return update_sse42(crc, s, n);
+
+        // the register is equivalent to adding it to the first four bytes
+        __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)s), _mm_cvtsi32_si128(int(crc)));
+        __m128i x1 = _mm_loadu_si128((const __m128i*)(s + 16));
+        __m128i x2 = _mm_loadu_si128((const __m128i*)(s + 32));
+        __m128i x3 = _mm_loadu_si128((const __m128i*)(s + 48));
+        s += 64;
+        n -= 64;
+
+        // the low half of a lane holds the coefficients of higher degree
+        constexpr uint64_t k512_lo = fold_constant(512 + 64), k512_hi = fold_constant(512);
+        const __m128i k512 = _mm_set_epi64x(k512_hi, k512_lo);
+        for(; n >= 64; s += 64, n -= 64) {
+            x0 = fold(x0, k512, _mm_loadu_si128((const __m128i*)s));
+            x1 = fold(x1, k512, _mm_loadu_si128((const __m128i*)(s + 16)));
+            x2 = fold(x2, k512, _mm_loadu_si128((const __m128i*)(s + 32)));
+            x3 = fold(x3, k512, _mm_loadu_si128((const __m128i*)(s + 48)));
+        }
+
+        constexpr uint64_t k128_lo = fold_constant(128 + 64), k128_hi = fold_constant(128);
+        const __m128i k128 = _mm_set_epi64x(k128_hi, k128_lo);
+        x1 = fold(x0, k128, x1);
+        x2 = fold(x1, k128, x2);
+        x3 = fold(x2, k128, x3);
+
+        uint64_t c = _mm_crc32_u64(0, uint64_t(_mm_cvtsi128_si64(x3)));
+        c = _mm_crc32_u64(c, uint64_t(_mm_extract_epi64(x3, 1)));
+        return update_sse42(uint32_t(c), s, n);
+    }
+    #endif
+
+    /// \brief Updates a CRC register using the fastest method available.
+    /// \param crc the CRC register
+    /// \param s the bytes
+    /// \param n the number of bytes
+    static uint32_t update(const uint32_t crc, const Byte* s, const size_t n) {
+        #if defined(__SSE4_2__) && defined(__PCLMUL__)
+        return update_pclmul(crc, s, n);
+        #elif defined(__SSE4_2__)
+        return update_interleaved(crc, s, n);
+        #else
+        return update_table(crc, s, n);
+        #endif
+    }
+
+    inline uint32_t operator()(const Byte* s, const size_t n) const {
+        return ~update(0xFFFFFFFF, s, n);
+    }
+};
+
 }}
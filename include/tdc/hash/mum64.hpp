@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <tdc/hash/byte.hpp>
+
+namespace tdc {
+namespace hash {
+
+/// \brief A fast non-cryptographic 64-bit hash function for byte strings.
+///
+/// The hash function reads the input in words of eight bytes and mixes them using the MUM ("multiply and mix") primitive,
+/// which multiplies two words to a 128-bit product and XORs its halves. Long inputs are processed in three independent lanes of 16 bytes,
+/// so that the multiplications overlap. Unlike \ref FNV32, which processes one byte at a time, this is limited by memory bandwidth rather than latency.
+///
+/// The constants, the input loading and the finalization follow wyhash by Wang Yi (https://github.com/wangyi-fudan/wyhash).
+class Mum64 {
+private:
+    static constexpr uint64_t P0 = 0xA0761D6478BD642FULL;
+    static constexpr uint64_t P1 = 0xE7037ED1A0B428DBULL;
+    static constexpr uint64_t P2 = 0x8EBC6AF09C88C6E3ULL;
+    static constexpr uint64_t P3 = 0x589965CC75374CC3ULL;
+
+    static uint64_t mum(const uint64_t a, const uint64_t b) {
+        const unsigned __int128 r = (unsigned __int128)a * b;
+        return uint64_t(r) ^ uint64_t(r >> 64);
+    }
+
+    static uint64_t load64(const Byte* s) {
+        uint64_t w;
+        std::memcpy(&w, s, sizeof(w));
+        return w;
+    }
+
+    static uint64_t load32(const Byte* s) {
+        uint32_t w;
+        std::memcpy(&w, s, sizeof(w));
+        return w;
+    }
+
+    uint64_t m_seed;
+
+public:
+    /// \brief Initializes the hash function.
+    /// \param seed the seed
+    inline Mum64(const uint64_t seed = 0) : m_seed(seed ^ mum(seed ^ P0, P1)) {
+    }
+
+    inline uint64_t operator()(const Byte* s, const size_t n) const {
+        uint64_t h = m_seed;
+        uint64_t a, b;
+        size_t i = n;
+        if(i <= 16) {
+            // short inputs are read using overlapping loads
+            if(i >= 4) {
+                a = (load32(s) << 32) | load32(s + ((i >> 3) << 2));
+                b = (load32(s + i - 4) << 32) | load32(s + i - 4 - ((i >> 3) << 2));
+            } else if(i > 0) {
+                a = (uint64_t(s[0]) << 16) | (uint64_t(s[i >> 1]) << 8) | s[i - 1];
+                b = 0;
+            } else {
+                a = b = 0;
+            }
+        } else {
+            if(i > 48) {
+                uint64_t h1 = h, h2 = h;
+                do {
+                    h  = mum(load64(s)      ^ P1, load64(s + 8)  ^ h);
+                    h1 = mum(load64(s + 16) ^ P2, load64(s + 24) ^ h1);
+                    h2 = mum(load64(s + 32) ^ P3, load64(s + 40) ^ h2);
+                    s += 48;
+                    i -= 48;
+                } while(i > 48);
+                h ^= h1 ^ h2;
+            }
+            while(i > 16) {
+                h = mum(load64(s) ^ P1, load64(s + 8) ^ h);
+                s += 16;
+                i -= 16;
+            }
+            // the last 16 bytes may overlap with bytes already processed
+            a = load64(s + i - 16);
+            b = load64(s + i - 8);
+        }
+        return mum(P1 ^ n, mum(a ^ P1, b ^ h));
+    }
+};
+
+}}
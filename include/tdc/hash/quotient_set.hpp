@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include <tdc/math/bit_mask.hpp>
+#include <tdc/vec/int_vector.hpp>
+
+#include "bijective.hpp"
+
+namespace tdc {
+namespace hash {
+
+/// \brief A compact hash set for integer keys using quotienting.
+///
+/// Keys are hashed using a bijective hash function (\ref MultiplyXorShift). The lowest bits of the hash value select the home slot,
+/// and only the remaining bits, the quotient, are stored. Together with the displacement of a slot from the home slot, they suffice to restore the hash value,
+/// and thus the key. For a table of \c 2^c slots and \c w -bit keys, every slot therefore takes only <tt>w - c</tt> bits plus a few displacement bits,
+/// rather than a full machine word.
+///
+/// Collisions are resolved using linear probing with Robin Hood insertion, which keeps displacements small, and erasing shifts the following entries back.
+/// Displacements that do not fit into the displacement bits are stored in a small overflow map.
+///
+/// \tparam t_disp_bits the number of bits used to store the displacement of a slot
+template<size_t t_disp_bits = 4>
+class QuotientSet {
+    static_assert(t_disp_bits >= 2 && t_disp_bits <= 16);
+
+public:
+    /// \brief Used to access an entry.
+    ///
+    /// Note that accessors may become invalid when the underlying table is modified after retrieval.
+    class Accessor {
+        friend class QuotientSet;
+
+    private:
+        const QuotientSet* m_set;
+        size_t             m_pos;
+
+        inline Accessor(const QuotientSet& set, const size_t pos) : m_set(&set), m_pos(pos) {
+        }
+
+    public:
+        /// \brief Constructs an invalid accessor.
+        inline Accessor() : m_set(nullptr), m_pos(0) {
+        }
+
+        Accessor(const Accessor&) = default;
+        Accessor(Accessor&&) = default;
+        Accessor& operator=(const Accessor&) = default;
+        Accessor& operator=(Accessor&&) = default;
+
+        /// \brief Tells whether the item exists.
+        inline bool exists() const {
+            return m_set != nullptr;
+        }
+
+        /// \brief Shortcut for \ref exists.
+        inline operator bool() const {
+            return exists();
+        }
+
+        /// \brief Restores the key.
+        uint64_t key() const {
+            assert(exists());
+            return m_set->key_at(m_pos);
+        }
+
+        uint64_t operator*() const {
+            return key();
+        }
+
+        /// \brief Comparison for standard library use pattern.
+        inline bool operator==(const Accessor& other) {
+            return m_set == other.m_set && m_pos == other.m_pos;
+        }
+
+        /// \brief Comparison for standard library use pattern.
+        inline bool operator!=(const Accessor& other) {
+            return !(*this == other);
+        }
+    };
+
+private:
+    static constexpr uint64_t DISP_MASK = (1ULL << t_disp_bits) - 1;
+    static constexpr uint64_t DISP_ESCAPE = DISP_MASK; // the displacement is stored in the overflow map
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+    MultiplyXorShift m_hash;
+    double m_load_factor;
+
+    size_t m_key_bits;
+    size_t m_cap_bits;
+    size_t m_cap;
+    size_t m_size;
+    size_t m_size_max;
+    size_t m_probe_max;
+
+    // every slot stores the quotient followed by the displacement plus one, or zero if the slot is empty
+    vec::IntVector m_slots;
+    std::unordered_map<size_t, uint64_t> m_overflow;
+
+    void init(const size_t capacity) {
+        // the displacement bits must not exceed the capacity bits so that a slot fits into 63 bits
+        m_cap_bits = t_disp_bits + 1;
+        while((1ULL << m_cap_bits) < capacity) ++m_cap_bits;
+        m_cap = 1ULL << m_cap_bits;
+        m_size = 0;
+        m_size_max = std::min(m_cap - 1, size_t(m_load_factor * (double)m_cap));
+        m_probe_max = 0;
+
+        const size_t quot_bits = (m_key_bits > m_cap_bits) ? m_key_bits - m_cap_bits : 0;
+        m_slots = vec::IntVector(m_cap, quot_bits + t_disp_bits);
+        m_overflow.clear();
+    }
+
+    size_t next(const size_t pos) const {
+        return (pos + 1) & (m_cap - 1);
+    }
+
+    uint64_t disp(const size_t pos, const uint64_t code) const {
+        return (code == DISP_ESCAPE) ? m_overflow.at(pos) : code - 1;
+    }
+
+    void write(const size_t pos, const uint64_t quot, const uint64_t d) {
+        if((uint64_t(m_slots[pos]) & DISP_MASK) == DISP_ESCAPE) m_overflow.erase(pos);
+
+        if(d + 1 < DISP_ESCAPE) {
+            m_slots[pos] = (quot << t_disp_bits) | (d + 1);
+        } else {
+            m_slots[pos] = (quot << t_disp_bits) | DISP_ESCAPE;
+            m_overflow[pos] = d;
+        }
+    }
+
+    void clear(const size_t pos) {
+        if((uint64_t(m_slots[pos]) & DISP_MASK) == DISP_ESCAPE) m_overflow.erase(pos);
+        m_slots[pos] = 0;
+    }
+
+    // restores the hash value of the entry in the given slot
+    uint64_t hash_at(const size_t pos) const {
+        const uint64_t v = m_slots[pos];
+        const size_t home = (pos - disp(pos, v & DISP_MASK)) & (m_cap - 1);
+        return ((v >> t_disp_bits) << m_cap_bits) | home;
+    }
+
+    uint64_t key_at(const size_t pos) const {
+        return m_hash.inverse(hash_at(pos));
+    }
+
+    size_t find_pos(const uint64_t x) const {
+        const uint64_t h = m_hash(x);
+        const uint64_t quot = h >> m_cap_bits;
+
+        size_t pos = h & (m_cap - 1);
+        for(uint64_t d = 0;; d++) {
+            const uint64_t v = m_slots[pos];
+            const uint64_t code = v & DISP_MASK;
+            if(code == 0) return NOT_FOUND;
+
+            // stop as soon as we meet an entry that is closer to its home slot than the key in question would be
+            const uint64_t dv = disp(pos, code);
+            if(dv < d) return NOT_FOUND;
+            if(dv == d && (v >> t_disp_bits) == quot) return pos;
+
+            pos = next(pos);
+        }
+    }
+
+    void insert_hashed(const uint64_t h) {
+        uint64_t quot = h >> m_cap_bits;
+        uint64_t d = 0;
+        size_t pos = h & (m_cap - 1);
+        while(true) {
+            const uint64_t v = m_slots[pos];
+            const uint64_t code = v & DISP_MASK;
+            if(code == 0) {
+                write(pos, quot, d);
+                break;
+            }
+
+            const uint64_t dv = disp(pos, code);
+            if(dv < d) {
+                // the resident is closer to its home slot, displace it
+                write(pos, quot, d);
+                quot = v >> t_disp_bits;
+                d = dv;
+            }
+            pos = next(pos);
+            ++d;
+        }
+
+        m_probe_max = std::max(m_probe_max, size_t(d));
+        ++m_size;
+    }
+
+    void grow() {
+        auto slots = std::move(m_slots);
+        auto overflow = std::move(m_overflow);
+        const size_t old_cap = m_cap;
+        const size_t old_cap_bits = m_cap_bits;
+
+        init(2 * m_cap);
+
+        for(size_t pos = 0; pos < old_cap; pos++) {
+            const uint64_t v = slots[pos];
+            const uint64_t code = v & DISP_MASK;
+            if(code) {
+                const uint64_t d = (code == DISP_ESCAPE) ? overflow.at(pos) : code - 1;
+                const size_t home = (pos - d) & (old_cap - 1);
+                insert_hashed(((v >> t_disp_bits) << old_cap_bits) | home);
+            }
+        }
+    }
+
+public:
+    /// \brief Constructs an empty set for 64-bit keys.
+    QuotientSet() : QuotientSet(64, 0) {
+    }
+
+    /// \brief Main constructor.
+    /// \param key_bits the bit width of the keys
+    /// \param capacity the initial capacity of the table, which is rounded up to a power of two
+    /// \param load_factor the maximum load factor - once reached, the capacity is doubled
+    /// \param seed the seed for the hash function
+    QuotientSet(const size_t key_bits, const size_t capacity, const double load_factor = 0.9, const uint64_t seed = 0)
+        : m_hash(key_bits, seed),
+          m_load_factor(load_factor),
+          m_key_bits(key_bits) {
+
+        init(capacity);
+    }
+
+    QuotientSet(const QuotientSet&) = default;
+    QuotientSet(QuotientSet&&) = default;
+    QuotientSet& operator=(const QuotientSet&) = default;
+    QuotientSet& operator=(QuotientSet&&) = default;
+
+    /// \brief Returns the number of keys stored in the set.
+    inline size_t size() const {
+        return m_size;
+    }
+
+    /// \brief The current capacity of the table.
+    inline size_t capacity() const {
+        return m_cap;
+    }
+
+    /// \brief The current load of the table.
+    inline double load() const {
+        return (double)m_size / (double)m_cap;
+    }
+
+    /// \brief The maximum displacement of any key ever inserted.
+    inline size_t max_probe() const {
+        return m_probe_max;
+    }
+
+    /// \brief The number of bits used per slot.
+    inline size_t slot_bits() const {
+        return m_slots.width();
+    }
+
+    /// \brief Inserts the given key, unless it is already contained.
+    /// \param x the key, must be less than <tt>2^key_bits</tt>
+    /// \return whether the key was inserted
+    bool insert(const uint64_t x) {
+        if(find_pos(x) != NOT_FOUND) return false;
+
+        // first, check if growing is necessary
+        if(m_size + 1 > m_size_max) {
+            grow();
+        }
+
+        insert_hashed(m_hash(x));
+        return true;
+    }
+
+    /// \brief Attempts to find the given key and returns an \ref Accessor to it, if any.
+    /// \param x the key in question
+    Accessor find(const uint64_t x) const {
+        const size_t pos = find_pos(x);
+        return pos != NOT_FOUND ? Accessor(*this, pos) : Accessor();
+    }
+
+    /// \brief Returns an arbitrary valid accessor, or \ref end if the set is empty.
+    ///
+    /// This is merely for standard library-style usage.
+    Accessor begin() const {
+        for(size_t pos = 0; pos < m_cap && m_size > 0; pos++) {
+            if(uint64_t(m_slots[pos]) & DISP_MASK) return Accessor(*this, pos);
+        }
+        return end();
+    }
+
+    /// \brief Returns an invalid accessor.
+    ///
+    /// This is merely for standard library-style usage.
+    Accessor end() const {
+        return Accessor();
+    }
+
+    /// \brief Tests whether a key exists in the set.
+    /// \param x the key in question
+    bool contains(const uint64_t x) const {
+        return find_pos(x) != NOT_FOUND;
+    }
+
+    /// \brief Calls the given function for each contained key, in no particular order.
+    /// \param func the function, must support signature <any>(uint64_t x)
+    template<typename func_t>
+    void for_each(func_t func) const {
+        for(size_t pos = 0; pos < m_cap; pos++) {
+            if(uint64_t(m_slots[pos]) & DISP_MASK) func(key_at(pos));
+        }
+    }
+
+    /// \brief Erases a key and shifts the following entries back until one is found that is in its home slot.
+    /// \param a the accessor
+    bool erase(const Accessor& a) {
+        if(a) {
+            size_t pos = a.m_pos;
+            for(size_t nxt = next(pos);; nxt = next(nxt)) {
+                const uint64_t v = m_slots[nxt];
+                const uint64_t code = v & DISP_MASK;
+                if(code == 0) break;
+
+                const uint64_t d = disp(nxt, code);
+                if(d == 0) break;
+
+                write(pos, v >> t_disp_bits, d - 1);
+                pos = nxt;
+            }
+            clear(pos);
+            --m_size;
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    /// \brief Erases a key.
+    /// \param x the key
+    bool erase(const uint64_t x) {
+        return erase(find(x));
+    }
+};
+
+}} // namespace tdc::hash
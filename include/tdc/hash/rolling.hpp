@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <bit>
 #include <concepts>
 #include <limits>
 #include <random>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #include <tdc/uint/uint128.hpp>
 
@@ -13,6 +16,8 @@ namespace hash {
 
 class RollingKarpRabinFingerprint {
 private:
+    friend class MultiWindowKarpRabinFingerprint;
+
     // implementation by Jonas Ellert, stripped down to what we need here
 
     static constexpr uint64_t MERSENNE61 = (((uint64_t)1ULL) << 61) - 1;
@@ -52,11 +57,19 @@ private:
         return result;
     }
 
+    // reduces a value less than (2^61 - 1)^2, which takes fewer dependent operations than modulo
+    inline static uint64_t reduce(const uint128_t value) {
+        const uint64_t r = uint64_t(value & MERSENNE61) + uint64_t(value >> MERSENNE61_SHIFT);
+        return r >= MERSENNE61 ? r - MERSENNE61 : r;
+    }
+
     uint64_t const base_;
     uint64_t const max_exponent_exclusive_; // base ^ window_size
+    uint64_t const base_squared_;
+    std::vector<uint64_t> pop_byte_; // the reduced contribution of each byte leaving the window, built by the first call of roll_block on bytes
 
 public:
-    RollingKarpRabinFingerprint(const uint64_t window, const uint64_t base) : base_(modulo(base)), max_exponent_exclusive_(power(base_, window)) {
+    RollingKarpRabinFingerprint(const uint64_t window, const uint64_t base) : base_(modulo(base)), max_exponent_exclusive_(power(base_, window)), base_squared_(modulo(square(base_))) {
     }
 
     RollingKarpRabinFingerprint(const uint64_t window) : RollingKarpRabinFingerprint(window, random_base()) {
@@ -72,6 +85,142 @@ public:
         const uint128_t pop = MERSENNE61_SQUARE - mult(max_exponent_exclusive_, pop_left);
         return modulo(shifted_fingerprint + pop + push_right);
     }
+
+    /// \brief Rolls the fingerprint over a block of characters, which is equivalent to calling \ref roll for each of them.
+    ///
+    /// In \ref roll, each fingerprint depends on the previous one via a multiplication and a full reduction, so rolling is bound by latency.
+    /// Here, the contribution of each character pair is computed independently of the fingerprint first,
+    /// and the chain of dependent operations advances by two characters at a time using the squared base, with the intermediate fingerprints branching off the chain.
+    /// For bytes, the contribution of the character leaving the window is looked up in a table, which is built on the first call.
+    /// Since all operands in the chain are reduced, the products are less than <tt>2^122</tt> and can be reduced with a single fold and a conditional subtraction.
+    ///
+    /// \tparam char_t the character type
+    /// \param fp the current fingerprint
+    /// \param out the characters leaving the window
+    /// \param in the characters entering the window
+    /// \param n the number of characters
+    /// \param fps_out receives the fingerprint after each character, must have space for \c n fingerprints
+    /// \return the fingerprint after the last character
+    template<typename char_t>
+    uint64_t roll_block(uint64_t fp, const char_t* out, const char_t* in, const size_t n, uint64_t* fps_out) {
+        if constexpr(sizeof(char_t) == 1 && std::is_unsigned_v<char_t>) {
+            if(pop_byte_.empty()) {
+                pop_byte_.resize(256);
+                for(uint64_t c = 0; c < 256; c++) {
+                    pop_byte_[c] = modulo(MERSENNE61_SQUARE - mult(max_exponent_exclusive_, c));
+                }
+            }
+        }
+
+        auto contribution = [&](const size_t i){
+            if constexpr(sizeof(char_t) == 1 && std::is_unsigned_v<char_t>) {
+                const uint64_t d = pop_byte_[out[i]] + uint64_t(in[i]);
+                return d >= MERSENNE61 ? d - MERSENNE61 : d;
+            } else {
+                return modulo(MERSENNE61_SQUARE - mult(max_exponent_exclusive_, uint64_t(out[i])) + uint64_t(in[i]));
+            }
+        };
+
+        size_t i = 0;
+        for(; i + 1 < n; i += 2) {
+            const uint64_t d0 = contribution(i);
+            const uint64_t d1 = contribution(i + 1);
+            const uint64_t d01 = reduce(mult(base_, d0) + d1);
+
+            fps_out[i] = reduce(mult(base_, fp) + d0);
+            fp = reduce(mult(base_squared_, fp) + d01);
+            fps_out[i + 1] = fp;
+        }
+        if(i < n) {
+            fp = reduce(mult(base_, fp) + contribution(i));
+            fps_out[i] = fp;
+        }
+        return fp;
+    }
+
+    /// \brief Reports the base.
+    inline uint64_t base() const {
+        return base_;
+    }
+};
+
+/// \brief Rolling Karp-Rabin fingerprints of several window sizes over the same text, computed in one pass.
+///
+/// All windows share the same base. Rather than rolling each window separately, the fingerprint of every prefix of the text is maintained,
+/// and the fingerprint of a window is the difference of two prefix fingerprints, the earlier one multiplied by the base raised to the window size.
+/// Thus, the prefix fingerprints are shared by all windows, and each window only takes one independent multiplication per character.
+///
+/// The fingerprints equal those of \ref RollingKarpRabinFingerprint instances with the same base and window sizes,
+/// starting from a zero fingerprint with the text preceded by zeroes.
+class MultiWindowKarpRabinFingerprint {
+private:
+    using KR = RollingKarpRabinFingerprint;
+
+    uint64_t m_base;
+    std::vector<uint64_t> m_windows;
+    std::vector<uint64_t> m_powers; // base ^ window for each window
+
+    uint64_t m_pos;
+    std::vector<uint64_t> m_history; // the most recent prefix fingerprints, indexed by position
+    uint64_t m_mask;
+
+    uint64_t prefix(const uint64_t pos) const {
+        return m_history[pos & m_mask];
+    }
+
+public:
+    /// \brief Initializes the fingerprints.
+    /// \param windows the window sizes
+    /// \param base the base
+    MultiWindowKarpRabinFingerprint(const std::vector<uint64_t>& windows, const uint64_t base) : m_base(KR::modulo(base)), m_windows(windows), m_pos(0) {
+        const uint64_t max_window = windows.empty() ? 0 : *std::max_element(windows.begin(), windows.end());
+        const uint64_t history = std::bit_ceil(max_window + 1);
+        m_history = std::vector<uint64_t>(history, 0);
+        m_mask = history - 1;
+
+        for(const uint64_t w : windows) m_powers.push_back(KR::power(m_base, w));
+    }
+
+    /// \brief Initializes the fingerprints with a random base.
+    /// \param windows the window sizes
+    MultiWindowKarpRabinFingerprint(const std::vector<uint64_t>& windows) : MultiWindowKarpRabinFingerprint(windows, KR::random_base()) {
+    }
+
+    /// \brief Reports the number of windows.
+    inline size_t num_windows() const {
+        return m_windows.size();
+    }
+
+    /// \brief Reports the base.
+    inline uint64_t base() const {
+        return m_base;
+    }
+
+    /// \brief Reports the current fingerprint of a window.
+    /// \param l the number of the window
+    uint64_t fingerprint(const size_t l) const {
+        return KR::modulo(prefix(m_pos) + KR::MERSENNE61_SQUARE - KR::mult(m_powers[l], prefix(m_pos - m_windows[l])));
+    }
+
+    /// \brief Appends characters to the text and computes the fingerprints of all windows after each character.
+    /// \tparam char_t the character type
+    /// \param in the characters
+    /// \param n the number of characters
+    /// \param fps_out for each window, receives the fingerprint after each character, must have space for \c n fingerprints per window
+    template<typename char_t>
+    void roll_block(const char_t* in, const size_t n, uint64_t* const* fps_out) {
+        const size_t num = m_windows.size();
+        uint64_t h = prefix(m_pos);
+        for(size_t i = 0; i < n; i++) {
+            h = KR::modulo(KR::mult(m_base, h) + uint64_t(in[i]));
+            ++m_pos;
+            m_history[m_pos & m_mask] = h;
+
+            for(size_t l = 0; l < num; l++) {
+                fps_out[l][i] = KR::modulo(h + KR::MERSENNE61_SQUARE - KR::mult(m_powers[l], prefix(m_pos - m_windows[l])));
+            }
+        }
+    }
 };
 
 }} // namespace tdc::hash
@@ -0,0 +1,453 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include "entry.hpp"
+#include "function.hpp"
+#include "linear_probing.hpp"
+
+namespace tdc {
+namespace hash {
+
+/// \brief A hash table that probes whole groups of slots at once using control bytes (SwissTable style).
+///
+/// In addition to the entries, the table stores one control byte per slot, which marks the slot as empty or deleted,
+/// or contains seven bits of the hash value of the contained key.
+/// A lookup compares the control bytes of a group of 16 or 32 consecutive slots against the hash bits of the key in question using SSE2 or AVX2,
+/// and only compares the keys of matching slots. It terminates as soon as a group contains an empty slot.
+///
+/// The capacity is always a power of two, so that slots are found by bit shifts rather than divisions.
+/// Hash values are spread using Fibonacci hashing, so that weak hash functions like \ref Identity do not cause clustering.
+/// The hash function and the probing policy are compile-time parameters; the probing policy is applied to groups rather than slots.
+///
+/// The interface matches that of \ref Table.
+///
+/// \tparam K the key type, must support default construction, copy assignment and equality
+/// \tparam E the entry type
+/// \tparam hash_func_t the hash function type
+/// \tparam probe_func_t the probing policy, which must visit every group eventually (e.g., \ref LinearProbing)
+/// \tparam t_group_size the number of slots in a group, either 16 (SSE2) or 32 (AVX2)
+template<std::semiregular K, TableEntry<K> E = KeyEntry<K>, typename hash_func_t = Multiplicative, typename probe_func_t = LinearProbing<>, size_t t_group_size = 16>
+class SwissTable {
+    static_assert(t_group_size == 16 || t_group_size == 32);
+
+public:
+    /// \brief Used to access an entry.
+    ///
+    /// Note that accessors may become invalid when the underlying table is modified after retrieval.
+    class Accessor {
+        friend class SwissTable;
+
+    private:
+        const SwissTable* m_set;
+        size_t            m_pos;
+
+        inline Accessor(const SwissTable& table, const size_t pos) : m_set(&table), m_pos(pos) {
+        }
+
+    public:
+        /// \brief Constructs an invalid accessor.
+        inline Accessor() : m_set(nullptr), m_pos(0) {
+        }
+
+        Accessor(const Accessor&) = default;
+        Accessor(Accessor&&) = default;
+        Accessor& operator=(const Accessor&) = default;
+        Accessor& operator=(Accessor&&) = default;
+
+        /// \brief Tells whether the item exists.
+        inline bool exists() const {
+            return m_set != nullptr;
+        }
+
+        /// \brief Shortcut for \ref exists.
+        inline operator bool() const {
+            return exists();
+        }
+
+        /// \brief Retrieves the entry.
+        const E& key() const {
+            assert(exists());
+            return m_set->m_entries[m_pos];
+        }
+
+        const E& operator*() const {
+            return key();
+        }
+
+        /// \brief Comparison for standard library use pattern.
+        inline bool operator==(const Accessor& other) {
+            return m_set == other.m_set && m_pos == other.m_pos;
+        }
+
+        /// \brief Comparison for standard library use pattern.
+        inline bool operator!=(const Accessor& other) {
+            return !(*this == other);
+        }
+    };
+
+private:
+    using mask_t = uint32_t;
+
+    static constexpr int8_t CTRL_EMPTY = -128;
+    static constexpr int8_t CTRL_DELETED = -2;
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+    static constexpr size_t BATCH_SIZE = 16; // the number of keys whose home groups are prefetched together in a batched lookup
+
+    // finds the slots in a group whose control byte equals c
+    static mask_t match(const int8_t* group, const int8_t c) {
+        #ifdef __AVX2__
+        if constexpr(t_group_size == 32) {
+            const __m256i ctrl = _mm256_loadu_si256((const __m256i*)group);
+            return (mask_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8(c)));
+        }
+        #endif
+        #ifdef __SSE2__
+        mask_t m = 0;
+        for(size_t i = 0; i < t_group_size; i += 16) {
+            const __m128i ctrl = _mm_loadu_si128((const __m128i*)(group + i));
+            m |= (mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(c))) << i;
+        }
+        return m;
+        #else
+        mask_t m = 0;
+        for(size_t i = 0; i < t_group_size; i++) {
+            m |= mask_t(group[i] == c) << i;
+        }
+        return m;
+        #endif
+    }
+
+    // finds the slots in a group that are empty or deleted, which are exactly those whose control byte has the sign bit set
+    static mask_t match_free(const int8_t* group) {
+        #ifdef __AVX2__
+        if constexpr(t_group_size == 32) {
+            return (mask_t)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)group));
+        }
+        #endif
+        #ifdef __SSE2__
+        mask_t m = 0;
+        for(size_t i = 0; i < t_group_size; i += 16) {
+            m |= (mask_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(group + i))) << i;
+        }
+        return m;
+        #else
+        mask_t m = 0;
+        for(size_t i = 0; i < t_group_size; i++) {
+            m |= mask_t(group[i] < 0) << i;
+        }
+        return m;
+        #endif
+    }
+
+    hash_func_t  m_hash_func;
+    probe_func_t m_probe_func;
+    double       m_load_factor;
+
+    size_t m_group_bits;
+    size_t m_num_groups;
+    size_t m_cap;
+    size_t m_size;
+    size_t m_deleted;
+    size_t m_probe_max;
+
+    std::vector<int8_t> m_ctrl;
+    std::vector<E>      m_entries;
+
+    // cache to avoid floating point computations on each insert
+    size_t m_size_max; // the maximum number of used and deleted slots before the table is rebuilt
+
+    // diagnostics
+    #ifndef NDEBUG
+    size_t m_probe_total;
+    size_t m_times_resized;
+    #endif
+
+    void init(const size_t capacity) {
+        m_group_bits = 0;
+        while((t_group_size << m_group_bits) < capacity) ++m_group_bits;
+        m_num_groups = 1ULL << m_group_bits;
+        m_cap = m_num_groups * t_group_size;
+        m_size = 0;
+        m_deleted = 0;
+        m_probe_max = 0;
+        #ifndef NDEBUG
+        m_probe_total = 0;
+        #endif
+
+        m_ctrl = std::vector<int8_t>(m_cap, CTRL_EMPTY);
+        m_entries = std::vector<E>(m_cap);
+
+        m_size_max = std::min(m_cap, size_t(m_load_factor * (double)m_cap));
+    }
+
+    uint64_t hash(const K& key) const {
+        return uint64_t(m_hash_func(key)) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    // the most significant bits of the hash value select the home group, the seven bits below are stored in the control byte
+    size_t home_group(const uint64_t h) const {
+        return m_group_bits ? size_t(h >> (64 - m_group_bits)) : 0;
+    }
+
+    static int8_t tag(const uint64_t h, const size_t group_bits) {
+        return int8_t((h >> (57 - group_bits)) & 0x7F);
+    }
+
+    size_t find_pos(const K& key) const {
+        return find_pos(key, hash(key));
+    }
+
+    size_t find_pos(const K& key, const uint64_t h) const {
+        const int8_t t = tag(h, m_group_bits);
+        const size_t g0 = home_group(h);
+
+        probe_func_t probe = m_probe_func;
+        size_t g = g0;
+        size_t i = 0;
+        for(size_t p = 0; p < m_num_groups; p++) {
+            const int8_t* group = m_ctrl.data() + g * t_group_size;
+            for(mask_t m = match(group, t); m; m &= m - 1) {
+                const size_t pos = g * t_group_size + __builtin_ctz(m);
+                if(m_entries[pos].key() == key) return pos;
+            }
+            if(match(group, CTRL_EMPTY)) break;
+
+            i = probe(i);
+            g = (g0 + i) & (m_num_groups - 1);
+        }
+        return NOT_FOUND;
+    }
+
+    // places an entry into the first free slot of its probe sequence, assuming that its key is not contained
+    // returns false if there is no free slot in the probe sequence
+    bool insert_new(const E& entry) {
+        const uint64_t h = hash(entry.key());
+        const size_t g0 = home_group(h);
+
+        probe_func_t probe = m_probe_func;
+        size_t g = g0;
+        size_t i = 0;
+        for(size_t p = 0; p < m_num_groups; p++) {
+            const mask_t m = match_free(m_ctrl.data() + g * t_group_size);
+            if(m) {
+                const size_t pos = g * t_group_size + __builtin_ctz(m);
+                if(m_ctrl[pos] == CTRL_DELETED) --m_deleted;
+                m_ctrl[pos] = tag(h, m_group_bits);
+                m_entries[pos] = entry;
+                #ifndef NDEBUG
+                m_probe_total += p;
+                #endif
+                m_probe_max = std::max(m_probe_max, p);
+                ++m_size;
+                return true;
+            }
+
+            i = probe(i);
+            g = (g0 + i) & (m_num_groups - 1);
+        }
+        return false;
+    }
+
+    void resize(const size_t new_cap) {
+        #ifndef NDEBUG
+        ++m_times_resized;
+        #endif
+
+        auto ctrl = std::move(m_ctrl);
+        auto entries = std::move(m_entries);
+
+        init(new_cap);
+
+        for(size_t i = 0; i < ctrl.size(); i++) {
+            if(ctrl[i] >= 0) {
+                [[maybe_unused]] const bool inserted = insert_new(entries[i]);
+                assert(inserted);
+            }
+        }
+    }
+
+    // rebuilds the table with twice the capacity, or with the same capacity if at least half of the used slots are deleted
+    void rebuild() {
+        resize(m_size >= m_size_max / 2 ? 2 * m_cap : m_cap);
+    }
+
+public:
+    /// \brief Constructs an empty table with a single group of slots.
+    SwissTable() requires std::default_initializable<hash_func_t> : SwissTable(hash_func_t(), 0) {
+    }
+
+    /// \brief Main constructor.
+    /// \param hash_func the hash function to use
+    /// \param capacity the initial capacity of the table, which is rounded up to a power of two
+    /// \param load_factor the maximum load factor - once reached, the capacity is doubled
+    /// \param probe_func the probing policy
+    SwissTable(
+        hash_func_t hash_func,
+        size_t capacity,
+        double load_factor = 0.875,
+        probe_func_t probe_func = probe_func_t())
+        : m_hash_func(hash_func),
+          m_probe_func(probe_func),
+          m_load_factor(load_factor) {
+
+        #ifndef NDEBUG
+        m_times_resized = 0;
+        #endif
+
+        init(capacity);
+    }
+
+    SwissTable(const SwissTable&) = default;
+    SwissTable(SwissTable&&) = default;
+    SwissTable& operator=(const SwissTable&) = default;
+    SwissTable& operator=(SwissTable&&) = default;
+
+    /// \brief Returns the number of items stored in the table.
+    inline size_t size() const {
+        return m_size;
+    }
+
+    /// \brief The current capacity of the table.
+    inline size_t capacity() const {
+        return m_cap;
+    }
+
+    /// \brief The current load of the table.
+    inline double load() const {
+        return (double)m_size / (double)m_cap;
+    }
+
+    /// \brief The maximum number of groups probed beyond the home group to insert an item.
+    inline size_t max_probe() const {
+        return m_probe_max;
+    }
+
+    #ifndef NDEBUG
+    /// \brief The average number of groups probed beyond the home group per contained item, not accounting for erased items.
+    inline double avg_probe() const {
+        return (double)m_probe_total / (double)m_size;
+    }
+
+    /// \brief The number of times the map has been rebuilt.
+    inline size_t times_resized() const {
+        return m_times_resized;
+    }
+    #endif
+
+    /// \brief Inserts the given entry into the table.
+    ///
+    /// If an entry with the same key is already contained, it is replaced.
+    ///
+    /// \param entry the entry
+    void insert(const E& entry) {
+        const size_t pos = find_pos(entry.key());
+        if(pos != NOT_FOUND) {
+            m_entries[pos] = entry;
+            return;
+        }
+
+        // first, check if rebuilding is necessary
+        if(m_size + m_deleted + 1 > m_size_max) {
+            rebuild();
+        }
+
+        // now it's safe to insert, unless the probing policy fails to find a free slot
+        while(!insert_new(entry)) {
+            resize(2 * m_cap);
+        }
+    }
+
+    /// \brief Attempts to find the given key and returns an \ref Accessor to the associated item, if any.
+    /// \param key the key in question
+    Accessor find(const K& key) const {
+        const size_t pos = find_pos(key);
+        return pos != NOT_FOUND ? Accessor(*this, pos) : Accessor();
+    }
+
+    /// \brief Finds multiple keys and stores an \ref Accessor to each associated item, if any.
+    ///
+    /// The keys are processed in small groups. The home groups of all keys in a group are computed and prefetched first,
+    /// so that the cache misses of independent lookups overlap rather than occurring one after another.
+    ///
+    /// \param keys the keys in question
+    /// \param n the number of keys
+    /// \param out receives the \ref Accessor for each key, must have space for \c n accessors
+    void find_batch(const K* keys, const size_t n, Accessor* out) const {
+        uint64_t h[BATCH_SIZE];
+        for(size_t i = 0; i < n; i += BATCH_SIZE) {
+            const size_t m = std::min(BATCH_SIZE, n - i);
+            for(size_t j = 0; j < m; j++) {
+                h[j] = hash(keys[i + j]);
+                const size_t g = home_group(h[j]);
+                __builtin_prefetch(m_ctrl.data() + g * t_group_size);
+                __builtin_prefetch(m_entries.data() + g * t_group_size);
+            }
+            for(size_t j = 0; j < m; j++) {
+                const size_t pos = find_pos(keys[i + j], h[j]);
+                out[i + j] = pos != NOT_FOUND ? Accessor(*this, pos) : Accessor();
+            }
+        }
+    }
+
+    /// \brief Returns an arbitrary valid accessor, or \ref end if the table is empty.
+    ///
+    /// This is merely for standard library-style usage.
+    Accessor begin() const {
+        for(size_t i = 0; i < m_cap && m_size > 0; i++) {
+            if(m_ctrl[i] >= 0) return Accessor(*this, i);
+        }
+        return end();
+    }
+
+    /// \brief Returns an invalid accessor.
+    ///
+    /// This is merely for standard library-style usage.
+    Accessor end() const {
+        return Accessor();
+    }
+
+    /// \brief Tests whether a key exists in the table.
+    /// \param key the key in question
+    bool contains(const K& key) const {
+        return find(key) != end();
+    }
+
+    /// \brief Erases an item.
+    ///
+    /// If the group of the item contains an empty slot, no probe sequence has ever passed it, and the slot can be marked empty.
+    /// Otherwise, it is marked deleted so that lookups continue to probe past it.
+    ///
+    /// \param a the accessor
+    bool erase(const Accessor& a) {
+        if(a) {
+            const size_t g = a.m_pos / t_group_size;
+            if(match(m_ctrl.data() + g * t_group_size, CTRL_EMPTY)) {
+                m_ctrl[a.m_pos] = CTRL_EMPTY;
+            } else {
+                m_ctrl[a.m_pos] = CTRL_DELETED;
+                ++m_deleted;
+            }
+            --m_size;
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    /// \brief Erases an item.
+    /// \param key the key of the item
+    bool erase(const K& key) {
+        return erase(find(key));
+    }
+};
+
+}} // namespace tdc::hash
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <functional>
 #include <vector>
 #include <utility>
@@ -13,8 +14,17 @@ namespace tdc {
 namespace hash {
 
 /// \brief A hash table.
+///
+/// With Robin Hood insertion, the table stores the probe distance of each entry, i.e., its distance from the slot its hash points to.
+/// An inserted entry takes over the slot of any entry it meets that is closer to its own slot, which then continues probing in its place.
+/// This keeps probe distances balanced, and a lookup can stop as soon as it meets an entry closer to its own slot than the key in question would be.
+/// Erasing an entry shifts the following entries back by one slot instead of leaving a gap, so no tombstones accumulate during insert/erase churn.
+/// Robin Hood insertion always uses linear probing.
+///
 /// \tparam K the key type, must support default construction, copy assignment and equality
-template<std::semiregular K, TableEntry<K> E = KeyEntry<K>>
+/// \tparam E the entry type
+/// \tparam t_robin_hood whether to use Robin Hood insertion and backward-shift deletion
+template<std::semiregular K, TableEntry<K> E = KeyEntry<K>, bool t_robin_hood = false>
 class Table {
 public:
     /// \brief The hash function type.
@@ -78,6 +88,9 @@ public:
     };
 
 private:
+    // the number of keys whose home slots are prefetched together in a batched lookup
+    static constexpr size_t BATCH_SIZE = 16;
+
     hash_func_t m_hash_func;
     probe_func_t m_probe_func;
     
@@ -89,8 +102,9 @@ private:
     
     mutable size_t m_begin;
 
-    std::vector<bool> m_used;
-    std::vector<E>    m_entries;
+    std::vector<bool>     m_used;    // not used with Robin Hood insertion
+    std::vector<uint32_t> m_dist;    // with Robin Hood insertion, the probe distance plus one of each entry, or zero for empty slots
+    std::vector<E>        m_entries;
 
     // caches to avoid floating point computations on each insert
     size_t m_size_max;
@@ -110,7 +124,11 @@ private:
         m_probe_total = 0;
         #endif
         
-        m_used    = std::vector<bool>(m_cap);
+        if constexpr(t_robin_hood) {
+            m_dist = std::vector<uint32_t>(m_cap);
+        } else {
+            m_used = std::vector<bool>(m_cap);
+        }
         m_entries = std::vector<E>(m_cap);
 
         m_size_max = size_t(m_load_factor * (double)m_cap);
@@ -121,7 +139,102 @@ private:
         return size_t(m_hash_func(key)) % m_cap;
     }
 
+    bool used(const size_t pos) const {
+        if constexpr(t_robin_hood) {
+            return m_dist[pos] != 0;
+        } else {
+            return m_used[pos];
+        }
+    }
+
+    size_t next(const size_t pos) const {
+        return (pos + 1 < m_cap) ? pos + 1 : 0;
+    }
+
+    void insert_robin_hood(const E& entry) {
+        E e = entry;
+        uint32_t d = 1;
+        size_t h = hash(e.key());
+        
+        while(m_dist[h] != 0) {
+            if(m_dist[h] < d) {
+                // the resident is closer to its slot, displace it
+                std::swap(e, m_entries[h]);
+                std::swap(d, m_dist[h]);
+                m_probe_max = std::max(m_probe_max, size_t(m_dist[h] - 1));
+            }
+            h = next(h);
+            ++d;
+            
+            #ifndef NDEBUG
+            ++m_probe_total; // every step increases the probe distance of the carried entry
+            #endif
+        }
+
+        m_probe_max = std::max(m_probe_max, size_t(d - 1));
+        
+        m_dist[h] = d;
+        m_entries[h] = e;
+        m_begin = h;
+        
+        ++m_size;
+    }
+
+    // locates an entry using the probe distances, terminating as soon as the key in question would have displaced an entry
+    size_t find_robin_hood(const K& key, size_t h) const {
+        for(uint32_t d = 1; m_dist[h] >= d; d++) {
+            if(m_entries[h].key() == key) return h;
+            h = next(h);
+        }
+        return SIZE_MAX;
+    }
+
+    // erases an entry and shifts the following entries back until one is found that is already in its home slot
+    void erase_robin_hood(size_t pos) {
+        #ifndef NDEBUG
+        m_probe_total -= m_dist[pos] - 1;
+        #endif
+        
+        for(size_t nxt = next(pos); m_dist[nxt] > 1; nxt = next(nxt)) {
+            m_entries[pos] = m_entries[nxt];
+            m_dist[pos] = m_dist[nxt] - 1;
+            pos = nxt;
+            
+            #ifndef NDEBUG
+            --m_probe_total;
+            #endif
+        }
+        m_dist[pos] = 0;
+    }
+
+    Accessor find_hashed(const K& key, const size_t hkey) const {
+        if constexpr(t_robin_hood) {
+            const size_t pos = find_robin_hood(key, hkey);
+            return pos != SIZE_MAX ? Accessor(*this, pos) : Accessor();
+        }
+        
+        size_t h = hkey;
+        if(m_used[h] && m_entries[h].key() == key) {
+            return Accessor(*this, h);
+        } else {
+            size_t i = 0;
+            for(size_t probe = 0; probe < m_probe_max; probe++) {
+                i = m_probe_func(i);
+                h = (hkey + i) % m_cap;
+                if(m_used[h] && m_entries[h].key() == key) {
+                    return Accessor(*this, h);
+                }
+            }
+            return Accessor(); // key not found
+        }
+    }
+
     void insert_internal(const E& entry) {
+        if constexpr(t_robin_hood) {
+            insert_robin_hood(entry);
+            return;
+        }
+        
         const size_t hkey = hash(entry.key());
         
         size_t h = hkey;
@@ -154,13 +267,14 @@ private:
         #endif
         
         auto old_cap = m_cap;
-        auto used = m_used;
+        auto used = std::move(m_used);
+        auto dist = std::move(m_dist);
         auto entries = std::move(m_entries);
 
         init(new_cap);
 
         for(size_t i = 0; i < old_cap; i++) {
-            if(used[i]) insert_internal(entries[i]);
+            if(t_robin_hood ? dist[i] != 0 : bool(used[i])) insert_internal(entries[i]);
         }
     }
 
@@ -173,6 +287,7 @@ public:
     /// \param capacity the initial capacity of the table
     /// \param load_factor the maximum load factor - once reached, the capacity is increased
     /// \param growth_factor the factor for increasing the capacity when the load has been reached
+    /// \param probe_func the probe function, ignored with Robin Hood insertion
     Table(
         hash_func_t hash_func,
         size_t capacity,
@@ -212,6 +327,8 @@ public:
     }
 
     /// \brief The maximum number of probe steps performed to resolve a collision.
+    ///
+    /// With Robin Hood insertion, this is the maximum probe distance of any entry ever inserted; lookups do not depend on it.
     inline size_t max_probe() const {
         return m_probe_max;
     }
@@ -243,21 +360,29 @@ public:
     /// \brief Attempts to find the given key and returns an \ref Accessor to the associated item, if any.
     /// \param key the key in question
     Accessor find(const K& key) const {
-        const size_t hkey = hash(key);
-        
-        size_t h = hkey;
-        if(m_used[h] && m_entries[h].key() == key) {
-            return Accessor(*this, h);
-        } else {
-            size_t i = 0;
-            for(size_t probe = 0; probe < m_probe_max; probe++) {
-                i = m_probe_func(i);
-                h = (hkey + i) % m_cap;
-                if(m_used[h] && m_entries[h].key() == key) {
-                    return Accessor(*this, h);
-                }
+        return find_hashed(key, hash(key));
+    }
+
+    /// \brief Finds multiple keys and stores an \ref Accessor to each associated item, if any.
+    ///
+    /// The keys are processed in small groups. The home slots of all keys in a group are computed and prefetched first,
+    /// so that the cache misses of independent lookups overlap rather than occurring one after another.
+    ///
+    /// \param keys the keys in question
+    /// \param n the number of keys
+    /// \param out receives the \ref Accessor for each key, must have space for \c n accessors
+    void find_batch(const K* keys, const size_t n, Accessor* out) const {
+        size_t h[BATCH_SIZE];
+        for(size_t i = 0; i < n; i += BATCH_SIZE) {
+            const size_t m = std::min(BATCH_SIZE, n - i);
+            for(size_t j = 0; j < m; j++) {
+                h[j] = hash(keys[i + j]);
+                if constexpr(t_robin_hood) __builtin_prefetch(&m_dist[h[j]]);
+                __builtin_prefetch(&m_entries[h[j]]);
+            }
+            for(size_t j = 0; j < m; j++) {
+                out[i + j] = find_hashed(keys[i + j], h[j]);
             }
-            return Accessor(); // key not found
         }
     }
     
@@ -268,7 +393,7 @@ public:
         if(m_size == 0) {
             return end();
         } else {
-            while(!m_used[m_begin]) m_begin = (m_begin + 1) % m_cap;
+            while(!used(m_begin)) m_begin = next(m_begin);
             return Accessor(*this, m_begin);
         }
     }
@@ -290,7 +415,11 @@ public:
     /// \param a the accessor
     bool erase(const Accessor& a) {
         if(a) {
-            m_used[a.m_pos] = false;
+            if constexpr(t_robin_hood) {
+                erase_robin_hood(a.m_pos);
+            } else {
+                m_used[a.m_pos] = false;
+            }
             --m_size;
             return true;
         } else {
@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <limits>
 
+#include "tzcnt.hpp"
+
 namespace tdc {
 namespace intrisics {
 
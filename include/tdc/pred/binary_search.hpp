@@ -72,25 +72,25 @@ public:
     static PosResult successor_seeded(const keyarray_t& keys, size_t p, size_t q, const key_t& x)  {
         assert(p <= q);
         while(p < q - 1) {
-            assert(x >= keys[p]);
-            assert(x < keys[q]);
+            assert(x > keys[p]);
+            assert(x <= keys[q]);
 
             const size_t m = (p + q) >> 1ULL;
 
-            const bool le = (keys[m] <= x);
+            const bool lt = (keys[m] < x);
 
             /*
                 the following is a fast form of:
-                if(le) p = m; else q = m;
+                if(lt) p = m; else q = m;
             */
-            const size_t le_mask = -size_t(le);
-            const size_t gt_mask = ~le_mask;
+            const size_t lt_mask = -size_t(lt);
+            const size_t ge_mask = ~lt_mask;
 
-            if(le) assert(le_mask == SIZE_MAX && gt_mask == 0ULL);
-            else   assert(gt_mask == SIZE_MAX && le_mask == 0ULL);
+            if(lt) assert(lt_mask == SIZE_MAX && ge_mask == 0ULL);
+            else   assert(ge_mask == SIZE_MAX && lt_mask == 0ULL);
 
-            p = (le_mask & m) | (gt_mask & p);
-            q = (gt_mask & m) | (le_mask & q);
+            p = (lt_mask & m) | (ge_mask & p);
+            q = (ge_mask & m) | (lt_mask & q);
         }
         return PosResult { true, q };
     }
@@ -102,6 +102,7 @@ public:
     /// \param x the key in question
     template<IndexAccessTo<key_t> keyarray_t>
     static PosResult successor(const keyarray_t& keys, const size_t num, const key_t& x)  {
+        if(tdc_unlikely(num == 0)) return PosResult { false, 0 };
         if(tdc_unlikely(x <= keys[0]))  return PosResult { true, 0 };
         if(tdc_unlikely(x > keys[num-1])) return PosResult { false, 0 };
         return successor_seeded(keys, 0, num-1, x);
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <tdc/pred/result.hpp>
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+/// \brief A dynamic predecessor data structure that switches between a sparse and a dense representation depending on the density of the keys.
+///
+/// The density is the number of keys divided by the span between the smallest and the largest key.
+/// It is checked periodically after updates. If it exceeds the dense threshold, the structure starts migrating to the dense representation,
+/// and if it drops below the sparse threshold, it starts migrating back. The gap between the two thresholds prevents switching back and forth.
+///
+/// Migration is incremental: while it is in progress, both representations exist, new keys are inserted into the target,
+/// and every update moves a few of the largest keys from the source into the target.
+/// Queries consult both representations until the source is empty and released.
+///
+/// \tparam sparse_t the representation for sparse key sets (e.g., \ref BTree)
+/// \tparam dense_t the representation for dense key sets (e.g., \ref DynIndex with bit vector or hybrid buckets)
+/// \tparam t_check_interval the number of updates between two density checks
+/// \tparam t_migrate_step the number of keys moved to the target representation per update during a migration
+template<typename sparse_t, typename dense_t, size_t t_check_interval = 1024, size_t t_migrate_step = 4>
+class Adaptive {
+private:
+    static_assert(t_check_interval > 0);
+    static_assert(t_migrate_step > 0);
+
+    double m_dense_threshold;
+    double m_sparse_threshold;
+
+    std::unique_ptr<sparse_t> m_sparse;
+    std::unique_ptr<dense_t> m_dense;
+    bool m_to_dense;          // whether the dense representation is the current target for insertions
+    size_t m_updates = 0;     // the number of updates since the last density check
+    size_t m_num_migrations = 0;
+
+    bool migrating() const {
+        return m_sparse && m_dense;
+    }
+
+    template<typename ds_t>
+    static bool contains(const ds_t& ds, const uint64_t x) {
+        if(ds.size() == 0) return false;
+        const auto r = ds.predecessor(x);
+        return r.exists && (uint64_t)r.key == x;
+    }
+
+    template<typename ds_t>
+    static KeyResult<uint64_t> pred(const ds_t* ds, const uint64_t x) {
+        if(ds == nullptr || ds->size() == 0) return { false, 0 };
+        const auto r = ds->predecessor(x);
+        return { r.exists, (uint64_t)r.key };
+    }
+
+    template<typename ds_t>
+    static KeyResult<uint64_t> succ(const ds_t* ds, const uint64_t x) {
+        if(ds == nullptr || ds->size() == 0) return { false, 0 };
+        const auto r = ds->successor(x);
+        return { r.exists, (uint64_t)r.key };
+    }
+
+    // moves the largest keys of the source representation into the target, and releases the source once it is empty
+    template<typename src_t, typename dst_t>
+    static void migrate(std::unique_ptr<src_t>& src, dst_t& dst, const size_t num) {
+        for(size_t i = 0; i < num && src->size() > 0; i++) {
+            const uint64_t x = (uint64_t)src->predecessor(UINT64_MAX).key;
+            src->remove(x);
+            dst.insert(x);
+        }
+        if(src->size() == 0) src.reset();
+    }
+
+    void check_density() {
+        const size_t n = size();
+        if(n == 0) return;
+
+        const uint64_t min = successor(0).key;
+        const uint64_t max = predecessor(UINT64_MAX).key;
+        const double density = (double)n / ((double)(max - min) + 1.0);
+
+        if(!m_to_dense && density >= m_dense_threshold) {
+            m_dense = std::make_unique<dense_t>();
+            m_to_dense = true;
+            ++m_num_migrations;
+        } else if(m_to_dense && density < m_sparse_threshold) {
+            m_sparse = std::make_unique<sparse_t>();
+            m_to_dense = false;
+            ++m_num_migrations;
+        }
+    }
+
+    void after_update() {
+        if(migrating()) {
+            if(m_to_dense) {
+                migrate(m_sparse, *m_dense, t_migrate_step);
+            } else {
+                migrate(m_dense, *m_sparse, t_migrate_step);
+            }
+        } else if(++m_updates >= t_check_interval) {
+            m_updates = 0;
+            check_density();
+        }
+    }
+
+public:
+    /// \brief Constructs an empty data structure, which starts out with the sparse representation.
+    /// \param dense_threshold the density at which to switch to the dense representation
+    /// \param sparse_threshold the density below which to switch back to the sparse representation
+    Adaptive(const double dense_threshold = 1.0 / 64.0, const double sparse_threshold = 1.0 / 256.0)
+        : m_dense_threshold(dense_threshold),
+          m_sparse_threshold(sparse_threshold),
+          m_sparse(std::make_unique<sparse_t>()),
+          m_to_dense(false) {
+        assert(sparse_threshold <= dense_threshold);
+    }
+
+    Adaptive(const Adaptive&) = delete;
+    Adaptive& operator=(const Adaptive&) = delete;
+
+    /// \brief Inserts the specified key, which must not be contained yet.
+    /// \param x the key to insert
+    void insert(const uint64_t x) {
+        if(m_to_dense) {
+            m_dense->insert(x);
+        } else {
+            m_sparse->insert(x);
+        }
+        after_update();
+    }
+
+    /// \brief Removes the specified key, which must be contained.
+    /// \param x the key to remove
+    void remove(const uint64_t x) {
+        if(migrating()) {
+            // the key may not have been moved yet
+            if(contains(*m_sparse, x)) {
+                m_sparse->remove(x);
+            } else {
+                m_dense->remove(x);
+            }
+        } else if(m_to_dense) {
+            m_dense->remove(x);
+        } else {
+            m_sparse->remove(x);
+        }
+        after_update();
+    }
+
+    /// \brief Finds the predecessor of the specified key.
+    /// \param x the key in question
+    KeyResult<uint64_t> predecessor(const uint64_t x) const {
+        const auto a = pred(m_sparse.get(), x);
+        const auto b = pred(m_dense.get(), x);
+        if(a.exists && b.exists) return { true, std::max(a.key, b.key) };
+        return a.exists ? a : b;
+    }
+
+    /// \brief Finds the successor of the specified key.
+    /// \param x the key in question
+    KeyResult<uint64_t> successor(const uint64_t x) const {
+        const auto a = succ(m_sparse.get(), x);
+        const auto b = succ(m_dense.get(), x);
+        if(a.exists && b.exists) return { true, std::min(a.key, b.key) };
+        return a.exists ? a : b;
+    }
+
+    /// \brief Counts the keys contained in the specified range.
+    /// \param a the lower bound of the range, inclusive
+    /// \param b the upper bound of the range, inclusive
+    size_t count_range(const uint64_t a, const uint64_t b) const {
+        size_t count = 0;
+        if(m_sparse && m_sparse->size() > 0) count += m_sparse->count_range(a, b);
+        if(m_dense && m_dense->size() > 0) count += m_dense->count_range(a, b);
+        return count;
+    }
+
+    /// \brief Moves all remaining keys into the target representation if a migration is in progress.
+    void finish_migration() {
+        if(migrating()) {
+            if(m_to_dense) {
+                migrate(m_sparse, *m_dense, SIZE_MAX);
+            } else {
+                migrate(m_dense, *m_sparse, SIZE_MAX);
+            }
+        }
+    }
+
+    /// \brief Reports whether the dense representation is the current target for insertions.
+    bool is_dense() const {
+        return m_to_dense;
+    }
+
+    /// \brief Reports whether a migration between the representations is in progress.
+    bool is_migrating() const {
+        return migrating();
+    }
+
+    /// \brief Reports the number of migrations that have been started so far.
+    size_t num_migrations() const {
+        return m_num_migrations;
+    }
+
+    /// \brief Reports the number of contained keys.
+    size_t size() const {
+        return (m_sparse ? m_sparse->size() : 0) + (m_dense ? m_dense->size() : 0);
+    }
+};
+
+}}} // namespace tdc::pred::dynamic
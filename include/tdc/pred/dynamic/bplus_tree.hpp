@@ -0,0 +1,853 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tdc/math/idiv.hpp>
+#include <tdc/pred/result.hpp>
+#include <tdc/util/assert.hpp>
+#include <tdc/util/likely.hpp>
+
+#include "btree.hpp"
+#include "btree/node_allocator.hpp"
+#include "btree/sorted_array_node.hpp"
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+/// \brief A B+-tree, i.e., a B-Tree that stores all keys in its leaves.
+///
+/// Inner nodes only contain separators that guide the search: the i-th child of an inner node contains keys greater than or equal to the (i-1)-th separator and less than the i-th separator.
+/// Separators are copies of keys, but they are not removed along with the keys, so they may no longer be contained in the tree.
+/// Leaves are doubly linked in key order, so range scans proceed sequentially along the leaf level without revisiting inner nodes.
+///
+/// Compared to \ref BTree, removals never need to fetch predecessors or successors from subtrees, leaves do not waste space for child pointers,
+/// and the leaf capacity can be chosen independently of the degree of inner nodes.
+///
+/// If a value type is given, the tree is a map that associates a value with every key.
+/// The values are stored in arrays parallel to the keys in the leaves, so they are found by the same traversal as their keys
+/// and never need to be moved when inner nodes change.
+///
+/// \tparam key_t the key type
+/// \tparam degree the maximum number of children of an inner node
+/// \tparam inner_impl_t node implementation for the separators in inner nodes (e.g., \ref DynamicFusionNode); must be sorted and support array access, size, insert, remove and predecessor
+/// \tparam leaf_capacity the maximum number of keys in a leaf; leaves are sorted arrays, searched using binary search if they are large
+/// \tparam allocator_t node allocation policy, parameterized with the block size (e.g., \ref HeapNodeAllocator or \ref PoolNodeAllocator)
+/// \tparam value_t the type of values associated with the keys, or \c void if the tree is a set
+template<std::totally_ordered m_key_t, size_t m_degree, BTreeNodeImpl<m_key_t> m_inner_impl_t, size_t m_leaf_capacity = m_degree - 1, template<size_t> typename m_allocator_t = HeapNodeAllocator, typename m_value_t = void>
+class BPlusTree {
+private:
+    struct NoValue {};
+
+public:
+    /// \brief The contained key type.
+    using key_t = m_key_t;
+
+    /// \brief Whether the tree associates values with its keys.
+    static constexpr bool is_map = !std::is_void_v<m_value_t>;
+
+    /// \brief The associated value type, or an empty placeholder if the tree is a set.
+    using value_t = std::conditional_t<is_map, m_value_t, NoValue>;
+
+    /// \brief The data structure that manages separators contained in an inner node.
+    using inner_impl_t = m_inner_impl_t;
+
+    /// \brief The data structure that manages keys contained in a leaf.
+    using leaf_impl_t = SortedArrayNode<key_t, m_leaf_capacity, (m_leaf_capacity > 64)>;
+
+    /// \brief The maximum number of children of an inner node.
+    static constexpr size_t degree = m_degree;
+
+    /// \brief The maximum number of keys in a leaf.
+    static constexpr size_t leaf_capacity = m_leaf_capacity;
+
+private:
+    static_assert(m_degree > 3);
+    static_assert(m_degree < 65536);
+    static_assert(m_leaf_capacity > 1);
+
+    static constexpr size_t m_max_inner_keys = m_degree - 1;
+    static constexpr size_t m_min_inner_keys = (m_degree - 2) / 2;  // a full inner node is split into nodes with at least this many keys
+    static constexpr size_t m_min_leaf_keys = m_leaf_capacity / 2;  // a full leaf is split into leaves with at least this many keys
+
+    struct Leaf {
+        leaf_impl_t m_impl;
+        [[no_unique_address]] std::conditional_t<is_map, std::array<value_t, m_leaf_capacity>, NoValue> m_values;
+        Leaf* m_prev;
+        Leaf* m_next;
+
+        Leaf() : m_prev(nullptr), m_next(nullptr) {
+        }
+
+        size_t size() const {
+            return m_impl.size();
+        }
+    };
+
+    // an inner node has one more child than separators, children are leaves if the node is on the lowest inner level
+    struct Inner {
+        inner_impl_t m_impl;
+        void* m_children[m_degree];
+
+        size_t size() const {
+            return m_impl.size();
+        }
+
+        // finds the child that is responsible for the given key
+        size_t child_index(const key_t x) const {
+            const auto r = m_impl.predecessor(x);
+            return r.exists ? r.pos + 1 : 0;
+        }
+
+        void insert_child(const size_t i, void* child) {
+            // the separator has already been inserted, so the node now has size()+1 children
+            for(size_t j = size(); j > i; j--) m_children[j] = m_children[j-1];
+            m_children[i] = child;
+        }
+
+        void remove_child(const size_t i) {
+            // the separator has already been removed, so the node had size()+2 children
+            for(size_t j = i; j <= size(); j++) m_children[j] = m_children[j+1];
+        }
+    };
+
+    template<typename impl_t>
+    static void assign(impl_t& impl, const key_t* keys, const size_t num) {
+        if constexpr(requires(impl_t& x) { x.assign(keys, num); }) {
+            impl.assign(keys, num);
+        } else {
+            impl = impl_t();
+            for(size_t i = 0; i < num; i++) impl.insert(keys[i]);
+        }
+    }
+
+    static value_t leaf_value(const Leaf* leaf, const size_t i) {
+        if constexpr(is_map) {
+            return leaf->m_values[i];
+        } else {
+            return value_t();
+        }
+    }
+
+    // inserts a key and its value into a leaf that is not full
+    static void leaf_insert(Leaf* leaf, const key_t key, const value_t& value) {
+        if constexpr(is_map) {
+            const auto r = leaf->m_impl.predecessor(key);
+            const size_t pos = r.exists ? r.pos + 1 : 0;
+            for(size_t j = leaf->size(); j > pos; j--) leaf->m_values[j] = leaf->m_values[j-1];
+            leaf->m_values[pos] = value;
+        }
+        leaf->m_impl.insert(key);
+    }
+
+    // removes a key and its value from a leaf, returns whether the key was contained
+    static bool leaf_remove(Leaf* leaf, const key_t key) {
+        if constexpr(is_map) {
+            const auto r = leaf->m_impl.predecessor(key);
+            if(!r.exists || leaf->m_impl[r.pos] != key) return false;
+            for(size_t j = r.pos + 1; j < leaf->size(); j++) leaf->m_values[j-1] = leaf->m_values[j];
+        }
+        return leaf->m_impl.remove(key);
+    }
+
+    // replaces the contents of a leaf
+    static void leaf_assign(Leaf* leaf, const key_t* keys, const value_t* values, const size_t num) {
+        leaf->m_impl.assign(keys, num);
+        if constexpr(is_map) {
+            std::copy(values, values + num, leaf->m_values.begin());
+        }
+    }
+
+    m_allocator_t<sizeof(Leaf)> m_leaf_alloc;
+    m_allocator_t<sizeof(Inner)> m_inner_alloc;
+
+    size_t m_size;
+    size_t m_height; // the number of inner levels above the leaves
+    void* m_root;
+    Leaf* m_head;    // the leftmost leaf
+    Leaf* m_tail;    // the rightmost leaf
+
+    Leaf* new_leaf() {
+        return new(m_leaf_alloc.allocate()) Leaf();
+    }
+
+    Inner* new_inner() {
+        return new(m_inner_alloc.allocate()) Inner();
+    }
+
+    void free_leaf(Leaf* leaf) {
+        leaf->~Leaf();
+        m_leaf_alloc.free(leaf);
+    }
+
+    void free_inner(Inner* inner) {
+        inner->~Inner();
+        m_inner_alloc.free(inner);
+    }
+
+    void free_subtree(void* node, const size_t level) {
+        if(level > 0) {
+            Inner* inner = (Inner*)node;
+            for(size_t i = 0; i <= inner->size(); i++) {
+                free_subtree(inner->m_children[i], level - 1);
+            }
+            free_inner(inner);
+        } else {
+            free_leaf((Leaf*)node);
+        }
+    }
+
+    static size_t node_size(const void* node, const size_t level) {
+        return level > 0 ? ((const Inner*)node)->size() : ((const Leaf*)node)->size();
+    }
+
+    // finds the leaf that is responsible for the given key
+    const Leaf* find_leaf(const key_t x) const {
+        const void* node = m_root;
+        for(size_t level = m_height; level > 0; level--) {
+            const Inner* inner = (const Inner*)node;
+            node = inner->m_children[inner->child_index(x)];
+        }
+        return (const Leaf*)node;
+    }
+
+    // finds the leaf and position of the predecessor of the given key, the leaf is nullptr if there is none
+    std::pair<const Leaf*, size_t> find_predecessor(const key_t x) const {
+        const Leaf* leaf = find_leaf(x);
+        const auto r = leaf->m_impl.predecessor(x);
+        if(r.exists) {
+            return { leaf, r.pos };
+        } else if(leaf->m_prev) {
+            // all keys in the previous leaf are less than x
+            return { leaf->m_prev, leaf->m_prev->size() - 1 };
+        } else {
+            return { nullptr, 0 };
+        }
+    }
+
+    // finds the leaf and position of the successor of the given key, the leaf is nullptr if there is none
+    std::pair<const Leaf*, size_t> find_successor(const key_t x) const {
+        const Leaf* leaf = find_leaf(x);
+        const auto r = leaf->m_impl.successor(x);
+        if(r.exists) {
+            return { leaf, r.pos };
+        } else {
+            // all keys in the next leaf are greater than x
+            return { leaf->m_next, 0 };
+        }
+    }
+
+    // finds the leaf and position of the given key, the leaf is nullptr if it is not contained
+    std::pair<const Leaf*, size_t> find_key(const key_t x) const {
+        if(tdc_unlikely(size() == 0)) return { nullptr, 0 };
+        const Leaf* leaf = find_leaf(x);
+        const auto r = leaf->m_impl.predecessor(x);
+        return r.exists && leaf->m_impl[r.pos] == x ? std::pair(leaf, r.pos) : std::pair<const Leaf*, size_t>(nullptr, 0);
+    }
+
+    void insert_impl(const key_t key, const value_t& value) {
+        if(node_size(m_root, m_height) == (m_height > 0 ? m_max_inner_keys : m_leaf_capacity)) {
+            // root is full, split it up
+            Inner* new_root = new_inner();
+            new_root->m_children[0] = m_root;
+            m_root = new_root;
+            ++m_height;
+            split_child(new_root, 0, m_height - 1);
+        }
+
+        void* node = m_root;
+        for(size_t level = m_height; level > 0; level--) {
+            Inner* inner = (Inner*)node;
+            size_t i = inner->child_index(key);
+            if(node_size(inner->m_children[i], level - 1) == (level > 1 ? m_max_inner_keys : m_leaf_capacity)) {
+                split_child(inner, i, level - 1);
+                if(key >= inner->m_impl[i]) ++i;
+            }
+            node = inner->m_children[i];
+        }
+
+        leaf_insert((Leaf*)node, key, value);
+        ++m_size;
+    }
+
+    void bulk_load_impl(const key_t* keys, const value_t* values, const size_t num) {
+        assert_sorted_ascending(keys, num);
+
+        free_subtree(m_root, m_height);
+        m_size = num;
+        m_height = 0;
+
+        // distribute the keys evenly over as few leaves as possible, so that every leaf gets at least m_min_leaf_keys keys
+        const size_t num_leaves = std::max(math::idiv_ceil(num, m_leaf_capacity), size_t(1));
+        std::vector<void*> nodes(num_leaves);
+        std::vector<key_t> seps(num_leaves - 1);
+
+        Leaf* prev = nullptr;
+        for(size_t g = 0; g < num_leaves; g++) {
+            const size_t offs = g * (num / num_leaves) + std::min(g, num % num_leaves);
+            const size_t sz = num / num_leaves + (g < num % num_leaves);
+
+            Leaf* leaf = new_leaf();
+            leaf_assign(leaf, keys + offs, is_map ? values + offs : nullptr, sz);
+            leaf->m_prev = prev;
+            if(prev) prev->m_next = leaf;
+            if(g > 0) seps[g - 1] = keys[offs];
+
+            nodes[g] = leaf;
+            prev = leaf;
+        }
+        m_head = (Leaf*)nodes.front();
+        m_tail = prev;
+
+        // construct inner levels, grouping the nodes of the previous level evenly
+        while(nodes.size() > 1) {
+            const size_t nc = nodes.size();
+            const size_t m = math::idiv_ceil(nc, m_degree);
+
+            std::vector<void*> next_nodes(m);
+            std::vector<key_t> next_seps(m - 1);
+            for(size_t g = 0; g < m; g++) {
+                // the g-th node receives the children starting at offs and the separators in between them
+                const size_t offs = g * (nc / m) + std::min(g, nc % m);
+                const size_t sz = nc / m + (g < nc % m);
+
+                Inner* inner = new_inner();
+                assign(inner->m_impl, seps.data() + offs, sz - 1);
+                for(size_t j = 0; j < sz; j++) inner->m_children[j] = nodes[offs + j];
+                if(g > 0) next_seps[g - 1] = seps[offs - 1];
+
+                next_nodes[g] = inner;
+            }
+
+            nodes = std::move(next_nodes);
+            seps = std::move(next_seps);
+            ++m_height;
+        }
+        m_root = nodes.front();
+    }
+
+    // splits the full i-th child of the given node, which is on the given level
+    void split_child(Inner* parent, const size_t i, const size_t level) {
+        assert(parent->size() < m_max_inner_keys);
+
+        if(level > 0) {
+            Inner* y = (Inner*)parent->m_children[i];
+            const size_t n = y->size();
+            assert(n == m_max_inner_keys);
+
+            key_t keys[m_max_inner_keys];
+            for(size_t j = 0; j < n; j++) keys[j] = y->m_impl[j];
+
+            // the middle separator moves up into the parent
+            const size_t mid = n / 2;
+            Inner* z = new_inner();
+            assign(z->m_impl, keys + mid + 1, n - mid - 1);
+            for(size_t j = mid + 1; j <= n; j++) z->m_children[j - mid - 1] = y->m_children[j];
+            assign(y->m_impl, keys, mid);
+
+            parent->m_impl.insert(keys[mid]);
+            parent->insert_child(i + 1, z);
+        } else {
+            Leaf* y = (Leaf*)parent->m_children[i];
+            const size_t n = y->size();
+            assert(n == m_leaf_capacity);
+
+            key_t keys[m_leaf_capacity];
+            value_t values[m_leaf_capacity];
+            for(size_t j = 0; j < n; j++) {
+                keys[j] = y->m_impl[j];
+                values[j] = leaf_value(y, j);
+            }
+
+            // the smallest key of the new right leaf becomes the separator
+            const size_t mid = n / 2;
+            Leaf* z = new_leaf();
+            leaf_assign(z, keys + mid, values + mid, n - mid);
+            leaf_assign(y, keys, values, mid);
+
+            z->m_prev = y;
+            z->m_next = y->m_next;
+            if(z->m_next) z->m_next->m_prev = z; else m_tail = z;
+            y->m_next = z;
+
+            parent->m_impl.insert(keys[mid]);
+            parent->insert_child(i + 1, z);
+        }
+    }
+
+    // makes sure that the i-th child of the given node, which is on the given level, has more than the minimum number of keys
+    // by moving a key from a sibling or by merging it with a sibling
+    void fix_child(Inner* parent, const size_t i, const size_t level) {
+        const size_t min_keys = level > 0 ? m_min_inner_keys : m_min_leaf_keys;
+        void* left = i > 0 ? parent->m_children[i-1] : nullptr;
+        void* right = i < parent->size() ? parent->m_children[i+1] : nullptr;
+
+        if(left && node_size(left, level) > min_keys) {
+            borrow_from_left(parent, i, level);
+        } else if(right && node_size(right, level) > min_keys) {
+            borrow_from_right(parent, i, level);
+        } else if(right) {
+            merge_children(parent, i, level);
+        } else {
+            assert(left);
+            merge_children(parent, i - 1, level);
+        }
+    }
+
+    // moves the largest key of the (i-1)-th child into the i-th child
+    void borrow_from_left(Inner* parent, const size_t i, const size_t level) {
+        const key_t sep = parent->m_impl[i-1];
+        parent->m_impl.remove(sep);
+
+        if(level > 0) {
+            // rotate the separator down into the child and the largest key of the sibling up into the parent
+            Inner* c = (Inner*)parent->m_children[i];
+            Inner* left = (Inner*)parent->m_children[i-1];
+            const size_t lsize = left->size();
+            const key_t x = left->m_impl[lsize-1];
+            void* moved = left->m_children[lsize];
+            left->m_impl.remove(x);
+
+            c->m_impl.insert(sep);
+            c->insert_child(0, moved);
+            parent->m_impl.insert(x);
+        } else {
+            Leaf* c = (Leaf*)parent->m_children[i];
+            Leaf* left = (Leaf*)parent->m_children[i-1];
+            const key_t x = left->m_impl[left->size()-1];
+            const value_t v = leaf_value(left, left->size()-1);
+            leaf_remove(left, x);
+            leaf_insert(c, x, v);
+            parent->m_impl.insert(x);
+        }
+    }
+
+    // moves the smallest key of the (i+1)-th child into the i-th child
+    void borrow_from_right(Inner* parent, const size_t i, const size_t level) {
+        const key_t sep = parent->m_impl[i];
+        parent->m_impl.remove(sep);
+
+        if(level > 0) {
+            Inner* c = (Inner*)parent->m_children[i];
+            Inner* right = (Inner*)parent->m_children[i+1];
+            const key_t x = right->m_impl[0];
+            void* moved = right->m_children[0];
+            right->m_impl.remove(x);
+            right->remove_child(0);
+
+            c->m_impl.insert(sep);
+            c->m_children[c->size()] = moved;
+            parent->m_impl.insert(x);
+        } else {
+            Leaf* c = (Leaf*)parent->m_children[i];
+            Leaf* right = (Leaf*)parent->m_children[i+1];
+            const key_t x = right->m_impl[0];
+            const value_t v = leaf_value(right, 0);
+            leaf_remove(right, x);
+            leaf_insert(c, x, v);
+            parent->m_impl.insert(right->m_impl[0]);
+        }
+    }
+
+    // merges the (i+1)-th child into the i-th child
+    void merge_children(Inner* parent, const size_t i, const size_t level) {
+        const key_t sep = parent->m_impl[i];
+
+        if(level > 0) {
+            Inner* y = (Inner*)parent->m_children[i];
+            Inner* z = (Inner*)parent->m_children[i+1];
+            const size_t ysize = y->size();
+            const size_t zsize = z->size();
+            assert(ysize + zsize < m_max_inner_keys);
+
+            // the separator between the two moves down
+            key_t keys[m_max_inner_keys];
+            for(size_t j = 0; j < ysize; j++) keys[j] = y->m_impl[j];
+            keys[ysize] = sep;
+            for(size_t j = 0; j < zsize; j++) keys[ysize + 1 + j] = z->m_impl[j];
+            assign(y->m_impl, keys, ysize + 1 + zsize);
+            for(size_t j = 0; j <= zsize; j++) y->m_children[ysize + 1 + j] = z->m_children[j];
+
+            free_inner(z);
+        } else {
+            Leaf* y = (Leaf*)parent->m_children[i];
+            Leaf* z = (Leaf*)parent->m_children[i+1];
+            const size_t ysize = y->size();
+            const size_t zsize = z->size();
+            assert(ysize + zsize <= m_leaf_capacity);
+
+            key_t keys[m_leaf_capacity];
+            value_t values[m_leaf_capacity];
+            for(size_t j = 0; j < ysize; j++) {
+                keys[j] = y->m_impl[j];
+                values[j] = leaf_value(y, j);
+            }
+            for(size_t j = 0; j < zsize; j++) {
+                keys[ysize + j] = z->m_impl[j];
+                values[ysize + j] = leaf_value(z, j);
+            }
+            leaf_assign(y, keys, values, ysize + zsize);
+
+            y->m_next = z->m_next;
+            if(y->m_next) y->m_next->m_prev = y; else m_tail = y;
+
+            free_leaf(z);
+        }
+
+        parent->m_impl.remove(sep);
+        parent->remove_child(i + 1);
+    }
+
+#ifndef NDEBUG
+    // verifies the subtree and returns the number of keys in it, keys must be in [lo, hi)
+    size_t verify(const void* node, const size_t level, const bool has_lo, const key_t lo, const bool has_hi, const key_t hi) const {
+        const size_t sz = node_size(node, level);
+        if(node != m_root) assert(sz >= (level > 0 ? m_min_inner_keys : m_min_leaf_keys));
+
+        if(level > 0) {
+            const Inner* inner = (const Inner*)node;
+            size_t num = 0;
+            for(size_t i = 0; i <= sz; i++) {
+                if(i > 0 && i < sz) assert(inner->m_impl[i-1] < inner->m_impl[i]);
+                num += verify(inner->m_children[i], level - 1,
+                    i > 0 || has_lo, i > 0 ? inner->m_impl[i-1] : lo,
+                    i < sz || has_hi, i < sz ? inner->m_impl[i] : hi);
+            }
+            return num;
+        } else {
+            const Leaf* leaf = (const Leaf*)node;
+            for(size_t i = 0; i < sz; i++) {
+                if(i > 0) assert(leaf->m_impl[i-1] < leaf->m_impl[i]);
+                if(has_lo) assert(leaf->m_impl[i] >= lo);
+                if(has_hi) assert(leaf->m_impl[i] < hi);
+            }
+            if(leaf->m_next) assert(leaf->m_next->m_prev == leaf);
+            return sz;
+        }
+    }
+#endif
+
+public:
+    /// \brief Constructs an empty tree.
+    BPlusTree() : m_size(0), m_height(0) {
+        m_head = m_tail = new_leaf();
+        m_root = m_head;
+    }
+
+    ~BPlusTree() {
+        free_subtree(m_root, m_height);
+    }
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    /// \brief Finds the \em value of the predecessor of the specified key in the tree.
+    /// \param x the key in question
+    KeyResult<key_t> predecessor(const key_t x) const {
+        const auto [leaf, pos] = find_predecessor(x);
+        return leaf ? KeyResult<key_t>{ true, leaf->m_impl[pos] } : KeyResult<key_t>{ false, 0 };
+    }
+
+    /// \brief Finds the predecessor of the specified key in the tree along with its associated value.
+    /// \param x the key in question
+    KeyValueResult<key_t, value_t> predecessor_entry(const key_t x) const requires is_map {
+        const auto [leaf, pos] = find_predecessor(x);
+        return leaf ? KeyValueResult<key_t, value_t>{ true, leaf->m_impl[pos], leaf->m_values[pos] } : KeyValueResult<key_t, value_t>{ false, 0, value_t() };
+    }
+
+    /// \brief Finds the \em value of the successor of the specified key in the tree.
+    /// \param x the key in question
+    KeyResult<key_t> successor(const key_t x) const {
+        const auto [leaf, pos] = find_successor(x);
+        return leaf ? KeyResult<key_t>{ true, leaf->m_impl[pos] } : KeyResult<key_t>{ false, 0 };
+    }
+
+    /// \brief Finds the successor of the specified key in the tree along with its associated value.
+    /// \param x the key in question
+    KeyValueResult<key_t, value_t> successor_entry(const key_t x) const requires is_map {
+        const auto [leaf, pos] = find_successor(x);
+        return leaf ? KeyValueResult<key_t, value_t>{ true, leaf->m_impl[pos], leaf->m_values[pos] } : KeyValueResult<key_t, value_t>{ false, 0, value_t() };
+    }
+
+    /// \brief Finds the value associated with the specified key.
+    /// \param x the key in question
+    /// \return a pointer to the value, or \c nullptr if the key is not contained
+    const value_t* find(const key_t x) const requires is_map {
+        const auto [leaf, pos] = find_key(x);
+        return leaf ? &leaf->m_values[pos] : nullptr;
+    }
+
+    /// \brief Finds the value associated with the specified key, which can then be modified.
+    /// \param x the key in question
+    /// \return a pointer to the value, or \c nullptr if the key is not contained
+    value_t* find(const key_t x) requires is_map {
+        const auto [leaf, pos] = find_key(x);
+        return leaf ? &const_cast<Leaf*>(leaf)->m_values[pos] : nullptr;
+    }
+
+    /// \brief Iterates over the keys contained in the tree in ascending order.
+    ///
+    /// The iterator follows the links between leaves, so advancing it takes constant time.
+    /// It is invalidated by any modification of the tree.
+    class Iterator {
+    private:
+        friend class BPlusTree;
+
+        const Leaf* m_leaf;
+        size_t      m_pos;
+
+        Iterator(const Leaf* leaf, const size_t pos) : m_leaf(leaf), m_pos(pos) {
+        }
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = key_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const key_t*;
+        using reference = key_t;
+
+        /// \brief Constructs an iterator pointing to the end of the tree.
+        Iterator() : m_leaf(nullptr), m_pos(0) {
+        }
+
+        /// \brief Returns the current key.
+        key_t operator*() const {
+            assert(m_leaf);
+            return m_leaf->m_impl[m_pos];
+        }
+
+        /// \brief Returns the value associated with the current key.
+        const value_t& value() const requires is_map {
+            assert(m_leaf);
+            return m_leaf->m_values[m_pos];
+        }
+
+        /// \brief Advances to the next larger key.
+        Iterator& operator++() {
+            assert(m_leaf);
+            if(++m_pos >= m_leaf->size()) {
+                m_leaf = m_leaf->m_next;
+                m_pos = 0;
+            }
+            return *this;
+        }
+
+        /// \brief Advances to the next larger key.
+        Iterator operator++(int) {
+            Iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        /// \brief Moves to the next smaller key.
+        ///
+        /// Only valid if the iterator does not point to the smallest key or to the end of the tree.
+        Iterator& operator--() {
+            assert(m_leaf);
+            if(m_pos == 0) {
+                m_leaf = m_leaf->m_prev;
+                assert(m_leaf);
+                m_pos = m_leaf->size();
+            }
+            --m_pos;
+            return *this;
+        }
+
+        /// \brief Moves to the next smaller key.
+        Iterator operator--(int) {
+            Iterator it = *this;
+            --(*this);
+            return it;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return m_leaf == other.m_leaf && m_pos == other.m_pos;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /// \brief Returns an iterator pointing to the smallest key greater than or equal to the specified key.
+    /// \param x the key in question
+    Iterator lower_bound(const key_t x) const {
+        const Leaf* leaf = find_leaf(x);
+        const auto r = leaf->m_impl.successor(x);
+        return r.exists ? Iterator(leaf, r.pos) : Iterator(leaf->m_next, 0);
+    }
+
+    /// \brief Returns an iterator pointing to the smallest key in the tree.
+    Iterator begin() const {
+        return m_size > 0 ? Iterator(m_head, 0) : end();
+    }
+
+    /// \brief Returns an iterator pointing to the end of the tree.
+    Iterator end() const {
+        return Iterator();
+    }
+
+    /// \brief Counts the keys contained in the specified range.
+    ///
+    /// After locating the first key, this scans the leaf level and counts whole leaves at once,
+    /// so it takes time linear in the number of leaves covered by the range rather than the number of keys.
+    ///
+    /// \param a the lower bound of the range, inclusive
+    /// \param b the upper bound of the range, inclusive
+    size_t count_range(const key_t a, const key_t b) const {
+        size_t count = 0;
+        if(a <= b) {
+            const Iterator it = lower_bound(a);
+            const Leaf* leaf = it.m_leaf;
+            size_t i = it.m_pos;
+            while(leaf) {
+                const size_t sz = leaf->size();
+                if(leaf->m_impl[sz - 1] <= b) {
+                    count += sz - i;
+                    leaf = leaf->m_next;
+                    i = 0;
+                } else {
+                    while(leaf->m_impl[i] <= b) {
+                        ++count;
+                        ++i;
+                    }
+                    break;
+                }
+            }
+        }
+        return count;
+    }
+
+    /// \brief Tests whether the given key is contained in the tree.
+    /// \param x the key in question
+    inline bool contains(const key_t x) const {
+        return find_key(x).first != nullptr;
+    }
+
+    /// \brief Reports the minimum key in the tree.
+    key_t min() const {
+        return m_head->m_impl[0];
+    }
+
+    /// \brief Reports the maximum key in the tree.
+    key_t max() const {
+        return m_tail->m_impl[m_tail->size() - 1];
+    }
+
+    /// \brief Inserts the specified key.
+    ///
+    /// Full nodes are split on the way down, so splits never propagate upwards.
+    ///
+    /// \param key the key to insert, which must not be contained yet
+    void insert(const key_t key) requires (!is_map) {
+        insert_impl(key, value_t());
+    }
+
+    /// \brief Inserts the specified key and associates it with the specified value.
+    ///
+    /// Full nodes are split on the way down, so splits never propagate upwards.
+    ///
+    /// \param key the key to insert, which must not be contained yet
+    /// \param value the associated value
+    void insert(const key_t key, const value_t& value) requires is_map {
+        insert_impl(key, value);
+    }
+
+    /// \brief Removes the specified key.
+    ///
+    /// Keys are only ever removed from leaves.
+    /// Children that may underflow are refilled from a sibling or merged with it on the way down, so no fixes propagate upwards.
+    ///
+    /// \param key the key to remove
+    /// \return whether the item was found and removed
+    bool remove(const key_t key) {
+        if(m_size == 0) return false;
+
+        void* node = m_root;
+        size_t level = m_height;
+        while(level > 0) {
+            Inner* inner = (Inner*)node;
+            size_t i = inner->child_index(key);
+            if(node_size(inner->m_children[i], level - 1) <= (level > 1 ? m_min_inner_keys : m_min_leaf_keys)) {
+                fix_child(inner, i, level - 1);
+                if(inner == m_root && inner->size() == 0) {
+                    // the root's only two children have been merged, make the result the new root
+                    m_root = inner->m_children[0];
+                    free_inner(inner);
+                    node = m_root;
+                    level = --m_height;
+                    continue;
+                }
+                i = inner->child_index(key);
+            }
+            node = inner->m_children[i];
+            --level;
+        }
+
+        const bool result = leaf_remove((Leaf*)node, key);
+        if(result) --m_size;
+        return result;
+    }
+
+    /// \brief Replaces the contents of the tree by the given keys.
+    ///
+    /// The leaves are filled up to their capacity and linked from left to right, then the inner levels are constructed bottom-up,
+    /// using the smallest key of every node but the first on a level as a separator for the next level.
+    ///
+    /// \param keys the keys, which must be unique and in ascending order
+    /// \param num the number of keys
+    void bulk_load(const key_t* keys, const size_t num) requires (!is_map) {
+        bulk_load_impl(keys, nullptr, num);
+    }
+
+    /// \brief Replaces the contents of the tree by the given keys and their associated values.
+    ///
+    /// \param keys the keys, which must be unique and in ascending order
+    /// \param values the values associated with the keys
+    /// \param num the number of keys
+    void bulk_load(const key_t* keys, const value_t* values, const size_t num) requires is_map {
+        bulk_load_impl(keys, values, num);
+    }
+
+    /// \brief Returns the current size of the tree.
+    inline size_t size() const {
+        return m_size;
+    }
+
+    /// \brief Returns the number of inner levels above the leaves.
+    inline size_t height() const {
+        return m_height;
+    }
+
+#ifndef NDEBUG
+    void verify() const {
+        const size_t num = verify(m_root, m_height, false, key_t(), false, key_t());
+        assert(num == m_size);
+
+        // the linked leaves contain all keys in ascending order
+        size_t num_linked = 0;
+        assert(m_head->m_prev == nullptr);
+        assert(m_tail->m_next == nullptr);
+        for(const Leaf* leaf = m_head; leaf; leaf = leaf->m_next) {
+            if(leaf->m_next) assert(leaf->m_impl[leaf->size() - 1] < leaf->m_next->m_impl[0]);
+            num_linked += leaf->size();
+        }
+        assert(num_linked == m_size);
+    }
+#endif
+};
+
+/// \brief A B+-tree that associates a value with every key, see \ref BPlusTree.
+template<std::totally_ordered key_t, typename value_t, size_t degree, BTreeNodeImpl<key_t> inner_impl_t, size_t leaf_capacity = degree - 1, template<size_t> typename allocator_t = HeapNodeAllocator>
+using BPlusTreeMap = BPlusTree<key_t, degree, inner_impl_t, leaf_capacity, allocator_t, value_t>;
+
+}}} // namespace tdc::pred::dynamic
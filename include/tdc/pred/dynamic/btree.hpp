@@ -1,17 +1,27 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
+#include <tdc/math/idiv.hpp>
+#include <tdc/math/ilog2.hpp>
 #include <tdc/pred/result.hpp>
+#include <tdc/pred/dynamic/snapshot.hpp>
+#include <tdc/util/assert.hpp>
 #include <tdc/util/concepts.hpp>
 #include <tdc/util/likely.hpp>
 
+#include "btree/node_allocator.hpp"
+
 namespace tdc {
 namespace pred {
 namespace dynamic {
@@ -27,7 +37,8 @@ concept BTreeNodeImpl = SizedIndexAccessTo<T, key_t> && requires(T node, key_t k
 /// \tparam key_t the key type
 /// \tparam degree the maximum number of children per node
 /// \tparam node_impl_t node implementation; must be sorted and support array access, size, insert, remove and predecessor
-template<std::totally_ordered m_key_t, size_t m_degree, BTreeNodeImpl<m_key_t> m_node_impl_t>
+/// \tparam allocator_t node allocation policy, parameterized with the block size (e.g., \ref HeapNodeAllocator or \ref PoolNodeAllocator)
+template<std::totally_ordered m_key_t, size_t m_degree, BTreeNodeImpl<m_key_t> m_node_impl_t, template<size_t> typename m_allocator_t = HeapNodeAllocator>
 class BTree {
 public:
     /// \brief The contained key type.
@@ -41,6 +52,11 @@ public:
     /// The number of keys (splitters) contained in a node equals this value minus one.
     static constexpr size_t degree = m_degree;
 
+    /// \brief The fill factor used when \ref remove_batch rebuilds the tree.
+    ///
+    /// This is about the typical fill of a B-Tree under random insertions, so nodes have room for subsequent insertions and are not split right away.
+    static constexpr double rebuild_fill_factor = 0.7;
+
     /// \brief A node in the B-Tree.
     class Node;
 
@@ -75,6 +91,18 @@ private:
     static constexpr size_t m_split_right = m_max_node_keys / 2;
     static constexpr size_t m_split_mid = m_split_right - 1;
     static constexpr size_t m_deletion_threshold = m_degree / 2;
+    static constexpr size_t m_min_node_keys = std::max(m_deletion_threshold - 1, size_t(1)); // for bulk loading
+
+    // an upper bound for the height of the tree, given that every node except the root has at least m_deletion_threshold children
+    static constexpr size_t m_max_height = 64 / math::ilog2_floor(std::max(m_deletion_threshold, size_t(2))) + 2;
+
+    class NodeAllocator;
+
+    // scratch space for batch insertions, one per tree level
+    struct BatchBuffer {
+        std::vector<key_t> keys;
+        std::vector<Node*> children;
+    };
 
 public:
     class Node {
@@ -124,31 +152,58 @@ public:
             return size() == m_max_node_keys;
         }
 
-        Node() : m_children(nullptr), m_num_children(0) {
+        Node(Node** children) : m_num_children(0), m_children(children) {
         }
         
-        ~Node() {
-            for(size_t i = 0; i < m_num_children; i++) {
-                delete m_children[i];
-            }
-            if(m_children) delete[] m_children;
-        }
+        ~Node() = default;
 
         Node(const Node&) = default;
         Node(Node&&) = default;
         Node& operator=(const Node&) = default;
         Node& operator=(Node&&) = default;
 
-        inline void alloc_m_children() {
-            if(m_children == nullptr) {
-                m_children = new Node*[m_degree];
+        void assign(const key_t* keys, const size_t num) {
+            if constexpr(requires(node_impl_t& impl) { impl.assign(keys, num); }) {
+                m_impl.assign(keys, num);
+            } else {
+                m_impl = node_impl_t();
+                for(size_t i = 0; i < num; i++) m_impl.insert(keys[i]);
+            }
+        }
+
+        // replaces the contents of this node by the given keys (and, for inner nodes, the num+1 given children)
+        // if they do not fit, they are distributed evenly over this node and as many new right siblings as needed,
+        // which are appended to out_nodes, each preceded by its separating key in out_seps
+        void assemble(const key_t* keys, const size_t num, Node* const* children, std::vector<key_t>& out_seps, std::vector<Node*>& out_nodes, NodeAllocator& alloc) {
+            const size_t m = (num <= m_max_node_keys) ? 1 : math::idiv_ceil(num + 1, m_max_node_keys + 1);
+            const size_t node_keys = (num - (m - 1)) / m;
+            const size_t node_keys_rem = (num - (m - 1)) % m;
+
+            for(size_t g = 0; g < m; g++) {
+                const size_t offs = g * (node_keys + 1) + std::min(g, node_keys_rem);
+                const size_t sz = node_keys + (g < node_keys_rem);
+
+                Node* node = this;
+                if(g > 0) {
+                    node = is_leaf() ? alloc.new_leaf() : alloc.new_inner();
+                    out_seps.push_back(keys[offs - 1]);
+                    out_nodes.push_back(node);
+                }
+
+                node->assign(keys + offs, sz);
+                if(!is_leaf()) {
+                    for(size_t j = 0; j <= sz; j++) {
+                        node->m_children[j] = children[offs + j];
+                    }
+                    node->m_num_children = sz + 1;
+                }
             }
         }
 
         void insert_child(const size_t i, Node* node) {
+            assert(!is_leaf());
             assert(i <= m_num_children);
             assert(m_num_children < m_degree);
-            alloc_m_children();
             
             // insert
             for(size_t j = m_num_children; j > i; j--) {
@@ -167,21 +222,16 @@ public:
             }
             m_children[m_num_children-1] = nullptr;
             --m_num_children;
-            
-            if(m_num_children == 0) {
-                delete[] m_children;
-                m_children = nullptr;
-            }
         }
 
-        void split_child(const size_t i) {
+        void split_child(const size_t i, NodeAllocator& alloc) {
             assert(!is_full());
             
             Node* y = m_children[i];
             assert(y->is_full());
 
-            // allocate new node
-            Node* z = new Node();
+            // allocate new node on the same level
+            Node* z = y->is_leaf() ? alloc.new_leaf() : alloc.new_inner();
 
             // get the middle value
             const key_t m = y->m_impl[m_split_mid];
@@ -201,7 +251,6 @@ public:
 
             // move the m_children right of middle from y to z
             if(!y->is_leaf()) {
-                z->alloc_m_children();
                 for(size_t j = m_split_right; j <= m_max_node_keys; j++) {
                     z->m_children[z->m_num_children++] = y->m_children[j];
                 }
@@ -221,7 +270,7 @@ public:
             if(!y->is_leaf()) assert(y->m_num_children == m_split_mid + 1);
         }
         
-        void insert(const key_t key, Observer* obs) {
+        void insert(const key_t key, Observer* obs, NodeAllocator& alloc) {
             assert(!is_full());
             
             if(is_leaf()) {
@@ -237,18 +286,18 @@ public:
                 
                 if(m_children[i]->is_full()) {
                     // it's full, split it up first
-                    split_child(i);
+                    split_child(i, alloc);
 
                     // we may have to increase the index of the child to descend into
                     if(key > m_impl[i]) ++i;
                 }
 
                 // descend into non-full child
-                m_children[i]->insert(key, obs);
+                m_children[i]->insert(key, obs, alloc);
             }
         }
 
-        bool remove(const key_t key, Observer* obs) {
+        bool remove(const key_t key, Observer* obs, NodeAllocator& alloc) {
             assert(!is_empty());
 
             if(is_leaf()) {
@@ -286,7 +335,7 @@ public:
                         m_impl.insert(key_pred);
 
                         // recursively delete key_pred from y
-                        y->remove(key_pred, obs);
+                        y->remove(key_pred, obs, alloc);
                     } else if(zsize >= m_deletion_threshold) {
                         // find successor of key in z's subtree - i.e., its minimum
                         Node* c = z;
@@ -300,7 +349,7 @@ public:
                         m_impl.insert(key_succ);
 
                         // recursively delete key_succ from z
-                        z->remove(key_succ, obs);
+                        z->remove(key_succ, obs, alloc);
                     } else {
                         // assert balance
                         assert(ysize == m_deletion_threshold - 1);
@@ -332,10 +381,10 @@ public:
 
                         // delete z
                         remove_child(i);
-                        delete z;
+                        alloc.free(z);
 
                         // recursively delete key from y
-                        y->remove(key, obs);
+                        y->remove(key, obs, alloc);
                     }
                     return true;
                 } else {
@@ -429,7 +478,7 @@ public:
                                 
                                 // delete right sibling
                                 remove_child(i+1);
-                                delete right;
+                                alloc.free(right);
                             } else {
                                 // merge child with left sibling
                                 const key_t splitter = m_impl[i-1];
@@ -463,13 +512,85 @@ public:
                                 
                                 // delete left sibling
                                 remove_child(i-1);
-                                delete left;
+                                alloc.free(left);
                             }
                         }
                     }
                     
                     // remove from subtree
-                    return c->remove(key, obs);
+                    return c->remove(key, obs, alloc);
+                }
+            }
+        }
+
+        // inserts a sorted batch of keys into the subtree rooted in this node, using buf[0] as scratch space for this node and buf[1..] for its descendants
+        // the node is rebuilt at most once, possibly splitting into several siblings that are reported to the caller (see assemble)
+        void insert_batch(const key_t* keys, const size_t num, std::vector<key_t>& out_seps, std::vector<Node*>& out_nodes, NodeAllocator& alloc, BatchBuffer* buf) {
+            const size_t sz = size();
+            if(is_leaf()) {
+                if(sz + num <= m_max_node_keys) {
+                    // the keys fit, insert them directly
+                    for(size_t j = 0; j < num; j++) {
+                        assert(!m_impl.predecessor(keys[j]).exists || m_impl[m_impl.predecessor(keys[j]).pos] != keys[j]); // keys must not be contained yet
+                        m_impl.insert(keys[j]);
+                    }
+                } else {
+                    // merge the batch into the leaf's keys and split up the result
+                    std::vector<key_t>& merged = buf->keys;
+                    merged.clear();
+
+                    size_t i = 0, j = 0;
+                    while(i < sz && j < num) {
+                        assert(m_impl[i] != keys[j]); // keys must not be contained yet
+                        if(m_impl[i] < keys[j]) {
+                            merged.push_back(m_impl[i++]);
+                        } else {
+                            merged.push_back(keys[j++]);
+                        }
+                    }
+                    while(i < sz) merged.push_back(m_impl[i++]);
+                    while(j < num) merged.push_back(keys[j++]);
+
+                    assemble(merged.data(), merged.size(), nullptr, out_seps, out_nodes, alloc);
+                }
+            } else {
+                // distribute the batch over the children
+                // as soon as a child is split, we start collecting the resulting keys and children of this node
+                std::vector<key_t>& node_keys = buf->keys;
+                std::vector<Node*>& node_children = buf->children;
+                node_keys.clear();
+                node_children.clear();
+                bool split = false;
+
+                size_t j = 0;
+                for(size_t i = 0; i <= sz; i++) {
+                    // the i-th child receives the keys smaller than the i-th splitter
+                    const size_t first = j;
+                    if(i < sz) {
+                        while(j < num && keys[j] < m_impl[i]) ++j;
+                        assert(j == num || keys[j] != m_impl[i]); // keys must not be contained yet
+                    } else {
+                        j = num;
+                    }
+
+                    Node* c = m_children[i];
+                    if(split) node_children.push_back(c);
+                    if(j > first) {
+                        // new siblings of the child are appended right after it
+                        c->insert_batch(keys + first, j - first, node_keys, node_children, alloc, buf + 1);
+                        if(!split && !node_children.empty()) {
+                            // first split, prepend the preceding keys and children
+                            split = true;
+                            node_keys.insert(node_keys.begin(), i, key_t());
+                            for(size_t k = 0; k < i; k++) node_keys[k] = m_impl[k];
+                            node_children.insert(node_children.begin(), m_children, m_children + i + 1);
+                        }
+                    }
+                    if(split && i < sz) node_keys.push_back(m_impl[i]);
+                }
+
+                if(split) {
+                    assemble(node_keys.data(), node_keys.size(), node_children.data(), out_seps, out_nodes, alloc);
                 }
             }
         }
@@ -518,18 +639,99 @@ public:
     } __attribute__((__packed__));
     
 private:
+    // allocates nodes; inner nodes are allocated together with their array of children
+    class NodeAllocator {
+    private:
+        static constexpr size_t m_children_offset = ((sizeof(Node) + alignof(Node*) - 1) / alignof(Node*)) * alignof(Node*);
+        
+        m_allocator_t<sizeof(Node)> m_leaves;
+        m_allocator_t<m_children_offset + m_degree * sizeof(Node*)> m_inner;
+        
+    public:
+        Node* new_leaf() {
+            return new(m_leaves.allocate()) Node(nullptr);
+        }
+        
+        Node* new_inner() {
+            char* block = (char*)m_inner.allocate();
+            return new(block) Node((Node**)(block + m_children_offset));
+        }
+        
+        void free(Node* node) {
+            const bool leaf = node->is_leaf();
+            node->~Node();
+            if(leaf) {
+                m_leaves.free(node);
+            } else {
+                m_inner.free(node);
+            }
+        }
+        
+        void free_subtree(Node* node) {
+            for(size_t i = 0; i < node->m_num_children; i++) {
+                free_subtree(node->m_children[i]);
+            }
+            free(node);
+        }
+    };
+
     size_t m_size;
+    NodeAllocator m_alloc;
     Node* m_root;
     
     Observer m_default_observer;
     Observer* m_observer;
 
+    std::vector<key_t> m_batch;
+    std::vector<BatchBuffer> m_batch_buffers;
+
+    // copies the given batch into m_batch and sorts it
+    void sort_batch(const key_t* keys, const size_t num) {
+        m_batch.assign(keys, keys + num);
+        std::sort(m_batch.begin(), m_batch.end());
+    }
+
+    // notifies the observer about the sorted batch of keys contained in the subtree rooted in the given node,
+    // reporting each key with the node that holds it, which may differ from the leaf it was inserted into if the leaf was split
+    void notify_inserted(const Node* node, const key_t* keys, const size_t num) {
+        const size_t sz = node->size();
+        size_t j = 0;
+        for(size_t i = 0; i <= sz && j < num; i++) {
+            // the keys smaller than the i-th key of the node are in the i-th subtree
+            const size_t first = j;
+            if(i < sz) {
+                while(j < num && keys[j] < node->m_impl[i]) ++j;
+            } else {
+                j = num;
+            }
+            if(j > first) {
+                assert(!node->is_leaf());
+                notify_inserted(node->m_children[i], keys + first, j - first);
+            }
+
+            if(i < sz && j < num && keys[j] == node->m_impl[i]) {
+                m_observer->key_inserted(keys[j], *node);
+                ++j;
+            }
+        }
+    }
+
+    void notify_inserted(const Node* node) {
+        for(size_t i = 0; i < node->size(); i++) {
+            m_observer->key_inserted(node->m_impl[i], *node);
+        }
+        for(size_t i = 0; i < node->m_num_children; i++) {
+            notify_inserted(node->m_children[i]);
+        }
+    }
+
 public:
-    BTree() : m_size(0), m_root(new Node()), m_observer(&m_default_observer) {
+    BTree() : m_size(0), m_observer(&m_default_observer) {
+        m_root = m_alloc.new_leaf();
     }
 
     ~BTree() {
-        delete m_root;
+        m_alloc.free_subtree(m_root);
     }
 
     /// \brief Finds the \em value of the predecessor of the specified key in the tree.
@@ -588,10 +790,146 @@ public:
         
         exists = exists || r.exists;
         if(r.exists) value = node->m_impl[r.pos];
-        
+
         return { exists, value };
     }
 
+    /// \brief Forward iterator over the keys contained in the tree, in ascending order.
+    ///
+    /// The iterator keeps the path from the root to the current key on a stack, so advancing it takes constant amortized time.
+    /// It is invalidated by any modification of the tree.
+    class Iterator {
+    private:
+        friend class BTree;
+
+        struct Frame {
+            const Node* node;
+            size_t      i; // the current key in a leaf, or the child we descended into in an inner node
+        };
+
+        Frame  m_path[m_max_height];
+        size_t m_height;
+
+        void push(const Node* node, const size_t i) {
+            assert(m_height < m_max_height);
+            m_path[m_height++] = { node, i };
+        }
+
+        // pushes the path to the leftmost leaf of the given subtree
+        void descend_leftmost(const Node* node) {
+            push(node, 0);
+            while(!node->is_leaf()) {
+                node = node->m_children[0];
+                push(node, 0);
+            }
+        }
+
+        // pops all nodes whose keys have been fully traversed
+        void ascend() {
+            while(m_height > 0 && m_path[m_height-1].i >= m_path[m_height-1].node->size()) {
+                --m_height;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = key_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const key_t*;
+        using reference = key_t;
+
+        /// \brief Constructs an iterator pointing to the end of the tree.
+        Iterator() : m_height(0) {
+        }
+
+        /// \brief Returns the current key.
+        key_t operator*() const {
+            assert(m_height > 0);
+            const Frame& f = m_path[m_height-1];
+            return f.node->m_impl[f.i];
+        }
+
+        /// \brief Advances to the next larger key.
+        Iterator& operator++() {
+            assert(m_height > 0);
+            Frame& f = m_path[m_height-1];
+            ++f.i;
+            if(!f.node->is_leaf()) {
+                // the next key is the minimum of the following subtree
+                descend_leftmost(f.node->m_children[f.i]);
+            }
+            ascend();
+            return *this;
+        }
+
+        /// \brief Advances to the next larger key.
+        Iterator operator++(int) {
+            Iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        bool operator==(const Iterator& other) const {
+            if(m_height == 0 || other.m_height == 0) {
+                return m_height == other.m_height;
+            } else {
+                const Frame& f = m_path[m_height-1];
+                const Frame& g = other.m_path[other.m_height-1];
+                return f.node == g.node && f.i == g.i;
+            }
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /// \brief Returns an iterator pointing to the smallest key greater than or equal to the specified key.
+    /// \param x the key in question
+    Iterator lower_bound(const key_t x) const {
+        Iterator it;
+
+        const Node* node = m_root;
+        while(true) {
+            const auto r = node->m_impl.successor(x);
+            const size_t i = r.exists ? r.pos : node->size();
+            it.push(node, i);
+
+            if(node->is_leaf() || (r.exists && node->m_impl[r.pos] == x)) break;
+            node = node->m_children[i];
+        }
+
+        it.ascend();
+        return it;
+    }
+
+    /// \brief Returns an iterator pointing to the smallest key in the tree.
+    Iterator begin() const {
+        Iterator it;
+        it.descend_leftmost(m_root);
+        it.ascend();
+        return it;
+    }
+
+    /// \brief Returns an iterator pointing to the end of the tree.
+    Iterator end() const {
+        return Iterator();
+    }
+
+    /// \brief Counts the keys contained in the specified range.
+    ///
+    /// This enumerates the keys in the range and thus takes time linear in their number.
+    ///
+    /// \param a the lower bound of the range, inclusive
+    /// \param b the upper bound of the range, inclusive
+    size_t count_range(const key_t a, const key_t b) const {
+        size_t count = 0;
+        if(a <= b) {
+            for(auto it = lower_bound(a); it != end() && *it <= b; ++it) ++count;
+        }
+        return count;
+    }
+
     /// \brief Tests whether the given key is contained in the trie.
     /// \param x the key in question
     inline bool contains(const key_t x) const {
@@ -623,23 +961,200 @@ public:
     void insert(const key_t key) {
         if(m_root->is_full()) {
             // root is full, split it up
-            Node* new_root = new Node();
+            Node* new_root = m_alloc.new_inner();
             new_root->insert_child(0, m_root);
 
             m_root = new_root;
-            m_root->split_child(0);
+            m_root->split_child(0, m_alloc);
         }
-        m_root->insert(key, m_observer);
+        m_root->insert(key, m_observer, m_alloc);
         ++m_size;
     }
 
+    /// \brief Inserts a batch of keys.
+    ///
+    /// The batch is sorted and then distributed top-down over the tree in a single pass, splitting it among the children of each visited node.
+    /// Every affected node is rebuilt only once, and overflowing nodes are split evenly into as many siblings as needed, similar to \ref bulk_load.
+    /// This amortizes the traversal and node allocation over the batch.
+    ///
+    /// \param keys the keys to insert, which must be unique and not yet contained in the tree
+    /// \param num the number of keys
+    void insert_batch(const key_t* keys, const size_t num) {
+        if(num == 0) return;
+
+        sort_batch(keys, num);
+        if(m_size == 0) {
+            bulk_load(m_batch.data(), num);
+            return;
+        }
+
+        // make sure there is a scratch buffer for every level
+        {
+            size_t height = 1;
+            for(const Node* node = m_root; !node->is_leaf(); node = node->m_children[0]) ++height;
+            if(m_batch_buffers.size() < height) m_batch_buffers.resize(height);
+        }
+
+        std::vector<key_t> seps;
+        std::vector<Node*> nodes;
+        m_root->insert_batch(m_batch.data(), num, seps, nodes, m_alloc, m_batch_buffers.data());
+        while(!nodes.empty()) {
+            // the root was split, grow the tree by one level
+            std::vector<key_t> root_keys;
+            std::vector<Node*> root_children;
+            root_keys.swap(seps);
+            root_children.reserve(nodes.size() + 1);
+            root_children.push_back(m_root);
+            root_children.insert(root_children.end(), nodes.begin(), nodes.end());
+            nodes.clear();
+
+            m_root = m_alloc.new_inner();
+            m_root->assemble(root_keys.data(), root_keys.size(), root_children.data(), seps, nodes, m_alloc);
+        }
+        m_size += num;
+
+        // notify observer
+        if(m_observer != &m_default_observer) {
+            notify_inserted(m_root, m_batch.data(), num);
+        }
+    }
+
+    /// \brief Replaces the contents of the tree by the given keys.
+    ///
+    /// The tree is constructed bottom-up in linear time, one level at a time:
+    /// the keys of a level are distributed evenly over as many nodes as needed to reach the given fill factor, separated by single splitter keys that form the input for the next level.
+    /// Nodes are filled in one pass using the node implementation's \c assign function, if available.
+    /// The nodes of a level are independent of each other and can be constructed in parallel.
+    ///
+    /// \param keys the keys, which must be unique and in ascending order
+    /// \param num the number of keys
+    /// \param fill_factor the fraction of node capacity to use, leaving room for subsequent insertions; nodes are never filled below the minimum required for balance
+    /// \param num_threads the number of threads used to construct the nodes of each level
+    void bulk_load(const key_t* keys, const size_t num, const double fill_factor = 1.0, const size_t num_threads = 1) {
+        assert(fill_factor > 0.0 && fill_factor <= 1.0);
+        assert(num_threads > 0);
+        assert_sorted_ascending(keys, num);
+        
+        m_alloc.free_subtree(m_root);
+        m_size = num;
+        
+        if(num == 0) {
+            m_root = m_alloc.new_leaf();
+            return;
+        }
+        
+        const size_t target = std::clamp(size_t(fill_factor * m_max_node_keys), size_t(1), m_max_node_keys);
+        
+        std::vector<key_t> splitters; // the splitters of the current level, i.e., the keys for the next level
+        std::vector<Node*> children;  // the nodes of the previous level
+        
+        const key_t* level_keys = keys;
+        size_t level_num = num;
+        while(true) {
+            // compute the number of nodes m for this level, leaving m-1 splitters for the next level
+            // the remaining keys are distributed evenly, so that every node gets between m_min_node_keys and m_max_node_keys keys
+            size_t m = math::idiv_ceil(level_num + 1, target + 1);
+            {
+                const size_t m_min = math::idiv_ceil(level_num + 1, m_max_node_keys + 1);
+                const size_t m_max = std::max(m_min, (level_num + 1) / (m_min_node_keys + 1));
+                m = std::clamp(m, m_min, m_max);
+            }
+            
+            const size_t node_keys = (level_num - (m - 1)) / m;
+            const size_t node_keys_rem = (level_num - (m - 1)) % m;
+            
+            // allocate nodes up front, as the allocator is not thread-safe
+            const bool leaves = children.empty();
+            std::vector<Node*> nodes(m);
+            for(size_t g = 0; g < m; g++) {
+                nodes[g] = leaves ? m_alloc.new_leaf() : m_alloc.new_inner();
+            }
+            std::vector<key_t> next_splitters(m - 1);
+            
+            auto construct_nodes = [&](const size_t first, const size_t last){
+                for(size_t g = first; g < last; g++) {
+                    // the g-th node is preceded by g nodes and g splitters, and the same number of children
+                    const size_t offs = g * (node_keys + 1) + std::min(g, node_keys_rem);
+                    const size_t sz = node_keys + (g < node_keys_rem);
+                    
+                    Node* node = nodes[g];
+                    node->assign(level_keys + offs, sz);
+                    if(!leaves) {
+                        for(size_t j = 0; j <= sz; j++) {
+                            node->m_children[j] = children[offs + j];
+                        }
+                        node->m_num_children = sz + 1;
+                    }
+                    
+                    if(g < m - 1) next_splitters[g] = level_keys[offs + sz];
+                }
+            };
+            
+            // distribute the nodes in contiguous chunks over the threads
+            const size_t num_chunks = std::min(num_threads, m);
+            if(num_chunks > 1) {
+                const size_t chunk_size = math::idiv_ceil(m, num_chunks);
+                
+                std::vector<std::thread> threads;
+                threads.reserve(num_chunks - 1);
+                for(size_t t = 1; t < num_chunks; t++) {
+                    const size_t first = t * chunk_size;
+                    const size_t last = std::min(first + chunk_size, m);
+                    if(first < last) threads.emplace_back(construct_nodes, first, last);
+                }
+                
+                construct_nodes(0, chunk_size);
+                for(auto& thread : threads) thread.join();
+            } else {
+                construct_nodes(0, m);
+            }
+            
+            if(m == 1) {
+                m_root = nodes[0];
+                break;
+            }
+            
+            // proceed with next level
+            children = std::move(nodes);
+            splitters = std::move(next_splitters);
+            level_keys = splitters.data();
+            level_num = splitters.size();
+        }
+        
+        // notify observer
+        if(m_observer != &m_default_observer) {
+            notify_inserted(m_root);
+        }
+    }
+
+    /// \brief Writes a snapshot of the tree, see \ref snapshot.
+    /// \param out the output stream
+    void snapshot(std::ostream& out) const {
+        snapshot::write<key_t>(out, *this);
+    }
+
+    /// \brief Replaces the contents of the tree by those of a snapshot using \ref bulk_load.
+    /// \param in the input stream
+    /// \param fill_factor the fraction of node capacity to use, see \ref bulk_load
+    void restore(std::istream& in, const double fill_factor = 1.0) {
+        snapshot::read<key_t>(in, [&](const key_t* keys, const size_t num){ bulk_load(keys, num, fill_factor); });
+    }
+
+    /// \brief Replaces the contents of the tree by those of a snapshot in memory, e.g., a memory mapped file, using \ref bulk_load.
+    /// \param data the snapshot data
+    /// \param size the size of the snapshot data in bytes
+    /// \param fill_factor the fraction of node capacity to use, see \ref bulk_load
+    void restore(const void* data, const size_t size, const double fill_factor = 1.0) {
+        snapshot::read<key_t>(data, size, [&](const key_t* keys, const size_t num){ bulk_load(keys, num, fill_factor); });
+    }
+
     /// \brief Removes the specified key.
     /// \param key the key to remove
     /// \return whether the item was found and removed
     bool remove(const key_t key) {
         assert(m_size > 0);
         
-        bool result = m_root->remove(key, m_observer);
+        bool result = m_root->remove(key, m_observer, m_alloc);
         
         if(result) {
             --m_size;
@@ -651,12 +1166,50 @@ public:
             // root is now empty but it still has a child, make that new root
             Node* new_root = m_root->m_children[0];
             m_root->m_num_children = 0;
-            delete m_root;
+            m_alloc.free(m_root);
             m_root = new_root;
         }
         return result;
     }
     
+    /// \brief Removes a batch of keys.
+    ///
+    /// If the batch is large compared to the tree, the tree is rebuilt bottom-up from the remaining keys using \ref bulk_load
+    /// with the \ref rebuild_fill_factor, which takes time linear in the size of the tree. Otherwise, the keys are removed one by one.
+    /// The rebuild is only done if no custom observer is registered, so trees with a custom observer always remove the keys one by one.
+    ///
+    /// \param keys the keys to remove
+    /// \param num the number of keys
+    /// \return the number of keys that were found and removed
+    size_t remove_batch(const key_t* keys, const size_t num) {
+        if(num == 0 || m_size == 0) return 0;
+
+        if(m_observer == &m_default_observer && num * math::ilog2_ceil(m_size) >= m_size) {
+            // rebuild from the remaining keys
+            sort_batch(keys, num);
+
+            std::vector<key_t> remaining;
+            remaining.reserve(m_size);
+
+            size_t j = 0;
+            for(auto it = begin(); it != end(); ++it) {
+                const key_t x = *it;
+                while(j < num && m_batch[j] < x) ++j;
+                if(j == num || m_batch[j] != x) remaining.push_back(x);
+            }
+
+            const size_t removed = m_size - remaining.size();
+            bulk_load(remaining.data(), remaining.size(), rebuild_fill_factor);
+            return removed;
+        } else {
+            size_t removed = 0;
+            for(size_t j = 0; j < num && m_size > 0; j++) {
+                if(remove(keys[j])) ++removed;
+            }
+            return removed;
+        }
+    }
+
     /// \brief Returns the current size of the underlying octrie.
     inline size_t size() const {
         return m_size;
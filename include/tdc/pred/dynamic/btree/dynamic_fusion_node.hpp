@@ -3,15 +3,18 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 
 #include <bitset> // FIXME: Debug
 #include <iostream> // FIXME: Debug
 
 #include <tdc/math/bit_mask.hpp>
+#include <tdc/intrisics/lzcnt.hpp>
 #include <tdc/intrisics/popcnt.hpp>
 #include <tdc/intrisics/select.hpp>
 #include <tdc/intrisics/tzcnt.hpp>
+#include <tdc/util/assert.hpp>
 #include <tdc/util/concepts.hpp>
 #include <tdc/util/likely.hpp>
 
@@ -49,8 +52,22 @@ private:
     using matrix_t = typename Internals::matrix_t;
     
     static constexpr size_t m_ckey_bits = 8ULL * sizeof(ckey_t);
+    static constexpr size_t m_matrix_rows = sizeof(matrix_t) / sizeof(ckey_t);
     static constexpr matrix_t m_matrix_max = std::numeric_limits<matrix_t>::max();
 
+    // finds the position of the most significant bit in which the two given keys differ
+    static size_t msb_diff(const key_t& a, const key_t& b) {
+        const key_t x = a ^ b;
+        assert(x != key_t(0));
+        if constexpr(m_key_bits <= 64) {
+            return 63ULL - intrisics::lzcnt((uint64_t)x);
+        } else {
+            size_t j = m_key_msb;
+            while((x & ((key_t)1ULL << (key_t)j)) == key_t(0)) --j;
+            return j;
+        }
+    }
+
     key_t    m_key[m_max_keys];
     mask_t   m_mask;
     matrix_t m_branch, m_free;
@@ -91,6 +108,19 @@ public:
         }
     }
 
+    /// \brief Finds the rank of the successor of the specified key in the node.
+    /// \param x the key in question
+    PosResult successor(const key_t x) const {
+        const auto r = predecessor(x);
+        if(r.exists && m_key[r.pos] == x) {
+            return r;
+        } else {
+            // the successor directly follows the predecessor
+            const size_t i = r.exists ? r.pos + 1 : 0;
+            return { i < size(), i };
+        }
+    }
+
     /// \brief Inserts the specified key.
     /// \param key the key to insert
     void insert(const key_t key) {
@@ -188,8 +218,8 @@ public:
             
             // insert new row at rank i
             {
-                const ckey_t matched_branch = m_branch >> (matched * m_ckey_bits);
-                const ckey_t matched_free = m_free >> (matched * m_ckey_bits);
+                const ckey_t matched_branch = (ckey_t)(m_branch >> (matched * m_ckey_bits));
+                const ckey_t matched_free = (ckey_t)(m_free >> (matched * m_ckey_bits));
 
                 // construct new entry:
                 // - the h-1 lowest bits are dontcares (branch 0, free 1)
@@ -246,6 +276,70 @@ public:
 #endif
     }
 
+    /// \brief Replaces the contents of this node by the given keys.
+    ///
+    /// Instead of inserting the keys one by one, the compressed trie is computed directly:
+    /// the branching nodes of the trie correspond to the most significant differing bits of neighbouring keys,
+    /// and each such node is on the path of exactly the keys in the surrounding range of neighbours that differ only in lower bits.
+    ///
+    /// \param keys the keys, which must be unique and in ascending order
+    /// \param num the number of keys, must not exceed the maximum number of keys
+    template<IndexAccessTo<key_t> keyarray_t>
+    void assign(const keyarray_t& keys, const size_t num) {
+        assert(num <= m_max_keys);
+        assert_sorted_ascending(keys, num);
+        
+        for(size_t i = 0; i < num; i++) {
+            m_key[i] = keys[i];
+        }
+        m_size = num;
+        
+        // find the branching positions between neighbouring keys and compute the mask
+        size_t diff[m_max_keys];
+        mask_t mask = 0;
+        for(size_t a = 0; a + 1 < num; a++) {
+            diff[a] = msb_diff(keys[a], keys[a+1]);
+            mask |= (mask_t)1ULL << (mask_t)diff[a];
+        }
+        
+        // initially, all compressed keys consist of wildcards only, and unused ones are at the maximum possible value
+        ckey_t branch[m_matrix_rows];
+        ckey_t free[m_matrix_rows];
+        {
+            const ckey_t all_free = math::bit_mask<ckey_t>(intrisics::popcnt(mask));
+            for(size_t i = 0; i < num; i++) {
+                branch[i] = 0;
+                free[i] = all_free;
+            }
+            for(size_t i = num; i < m_matrix_rows; i++) {
+                branch[i] = std::numeric_limits<ckey_t>::max();
+                free[i] = 0;
+            }
+        }
+        
+        // resolve the branching node between keys a and a+1 in the compressed keys below it
+        for(size_t a = 0; a + 1 < num; a++) {
+            const size_t j = diff[a];
+            const size_t h = intrisics::popcnt(mask) - intrisics::popcnt((mask_t)(mask >> (mask_t)j)); // rank of j in the mask
+            const key_t jmask = (key_t)1ULL << (key_t)j;
+            
+            // the subtree of the branching node contains all neighbours that branch in lower bits
+            size_t l = a;
+            while(l > 0 && diff[l-1] < j) --l;
+            size_t r = a + 1;
+            while(r + 1 < num && diff[r] < j) ++r;
+            
+            for(size_t i = l; i <= r; i++) {
+                branch[i] |= (ckey_t)((keys[i] & jmask) != 0) << h;
+                free[i] &= ~((ckey_t)1U << h);
+            }
+        }
+        
+        m_mask = mask;
+        std::memcpy(&m_branch, branch, sizeof(matrix_t));
+        std::memcpy(&m_free, free, sizeof(matrix_t));
+    }
+
     /// \brief Removes the specified key.
     /// \param key the key to remove
     /// \return whether the item was found and removed
@@ -266,8 +360,8 @@ public:
         if(sz > 2) {
             // find least significant distinguishing bit that is not a wildcard
             // to do that, check the number of trailing ones in free
-            const ckey_t key_free = m_free >> (i * m_ckey_bits);
-            const ckey_t key_branch = m_branch >> (i * m_ckey_bits);
+            const ckey_t key_free = (ckey_t)(m_free >> (i * m_ckey_bits));
+            const ckey_t key_branch = (ckey_t)(m_branch >> (i * m_ckey_bits));
             
             const size_t h = intrisics::tzcnt0((ckey_t)~key_free); // free contains a 1 for every wildcard, so invert free and count the trailing zeroes
             //~ std::cout << "\th=" << h << std::endl;
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+/// \brief B-Tree node allocation policy that allocates every node individually from the heap.
+/// \tparam m_block_size the size of an allocated block, in bytes
+template<size_t m_block_size>
+class HeapNodeAllocator {
+public:
+    /// \brief Allocates a block of memory.
+    inline void* allocate() {
+        return ::operator new(m_block_size);
+    }
+
+    /// \brief Releases a block of memory.
+    /// \param block the block to release, which must have been allocated by this allocator
+    inline void free(void* block) {
+        ::operator delete(block);
+    }
+};
+
+/// \brief B-Tree node allocation policy that carves nodes from large slabs and recycles released nodes using a free list.
+///
+/// This saves the per-node bookkeeping of the heap allocator and keeps nodes close together in memory.
+/// Slabs are only returned to the heap when the allocator is destroyed.
+///
+/// \tparam m_block_size the size of an allocated block, in bytes
+/// \tparam m_slab_blocks the number of blocks per slab
+template<size_t m_block_size, size_t m_slab_blocks = 1024>
+class PoolNodeAllocator {
+private:
+    static_assert(m_slab_blocks > 0);
+
+    // blocks are aligned like pointers and must be able to hold the free list pointer
+    static constexpr size_t m_align = alignof(void*);
+    static constexpr size_t m_block_stride = ((std::max(m_block_size, sizeof(void*)) + m_align - 1) / m_align) * m_align;
+
+    std::vector<char*> m_slabs;
+    char* m_next; // the next unused block in the current slab
+    char* m_end;  // the end of the current slab
+    void* m_free; // the head of the free list
+
+    void release() {
+        for(char* slab : m_slabs) {
+            ::operator delete(slab);
+        }
+        m_slabs.clear();
+    }
+
+public:
+    PoolNodeAllocator() : m_next(nullptr), m_end(nullptr), m_free(nullptr) {
+    }
+
+    ~PoolNodeAllocator() {
+        release();
+    }
+
+    PoolNodeAllocator(const PoolNodeAllocator&) = delete;
+    PoolNodeAllocator& operator=(const PoolNodeAllocator&) = delete;
+
+    PoolNodeAllocator(PoolNodeAllocator&& other)
+        : m_slabs(std::move(other.m_slabs)), m_next(other.m_next), m_end(other.m_end), m_free(other.m_free) {
+        other.m_slabs.clear();
+        other.m_next = other.m_end = nullptr;
+        other.m_free = nullptr;
+    }
+
+    PoolNodeAllocator& operator=(PoolNodeAllocator&& other) {
+        if(this != &other) {
+            release();
+            m_slabs = std::move(other.m_slabs);
+            m_next = other.m_next;
+            m_end = other.m_end;
+            m_free = other.m_free;
+            other.m_slabs.clear();
+            other.m_next = other.m_end = nullptr;
+            other.m_free = nullptr;
+        }
+        return *this;
+    }
+
+    /// \brief Allocates a block of memory.
+    void* allocate() {
+        if(m_free) {
+            // recycle
+            void* block = m_free;
+            m_free = *(void**)block;
+            return block;
+        }
+
+        if(m_next == m_end) {
+            // allocate a new slab
+            char* slab = (char*)::operator new(m_slab_blocks * m_block_stride);
+            m_slabs.push_back(slab);
+            m_next = slab;
+            m_end = slab + m_slab_blocks * m_block_stride;
+        }
+
+        void* block = m_next;
+        m_next += m_block_stride;
+        return block;
+    }
+
+    /// \brief Releases a block of memory to the free list.
+    /// \param block the block to release, which must have been allocated by this allocator
+    void free(void* block) {
+        assert(block != nullptr);
+        *(void**)block = m_free;
+        m_free = block;
+    }
+};
+
+}}} // namespace tdc::pred::dynamic
@@ -51,10 +51,10 @@ public:
     /// \brief Finds the rank of the predecessor of the specified key in the node.
     /// \param x the key in question
     PosResult predecessor(const key_t x) const {
+        if(tdc_unlikely(m_size == 0)) return { false, 0 };
         if constexpr(m_binary_search) {
             return BinarySearch<key_t>::predecessor(m_keys, m_size, x);
         } else {
-            if(tdc_unlikely(m_size == 0)) return { false, 0 };
             if(tdc_unlikely(x < m_keys[0])) return { false, 0 };
             if(tdc_unlikely(x >= m_keys[m_size-1])) return { true, m_size - 1ULL };
             
@@ -67,15 +67,15 @@ public:
     /// \brief Finds the rank of the successor of the specified key in the node.
     /// \param x the key in question
     PosResult successor(const key_t x) const {
+        if(tdc_unlikely(m_size == 0)) return { false, 0 };
         if constexpr(m_binary_search) {
             return BinarySearch<key_t>::successor(m_keys, m_size, x);
         } else {
-            if(tdc_unlikely(m_size == 0)) return { false, 0 };
             if(tdc_unlikely(x <= m_keys[0])) return { true, 0 };
             if(tdc_unlikely(x > m_keys[m_size-1])) return { false, 0 };
             
             size_t i = 1;
-            while(m_keys[i] <= x) ++i;
+            while(m_keys[i] < x) ++i;
             return { true, i };
         }
     }
@@ -91,6 +91,16 @@ public:
         ++m_size;
     }
 
+    /// \brief Replaces the contents of this node by the given keys.
+    /// \param keys the keys, which must be in ascending order
+    /// \param num the number of keys, must not exceed the capacity
+    template<IndexAccessTo<key_t> keyarray_t>
+    void assign(const keyarray_t& keys, const size_t num) {
+        assert(num <= m_capacity);
+        for(size_t i = 0; i < num; i++) m_keys[i] = keys[i];
+        m_size = num;
+    }
+
     /// \brief Removes the specified key.
     /// \param key the key to remove
     /// \return whether the item was found and removed
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <bitset>
 #include <cassert>
 #include <limits>
 #include <memory>
 #include <type_traits>
+#include <vector>
 
 #include <tdc/pred/binary_search.hpp>
+#include <tdc/pred/result.hpp>
 #include <tdc/math/bit_mask.hpp>
 #include <tdc/util/hybrid_ptr.hpp>
 #include <tdc/vec/fixed_width_int_vector.hpp>
@@ -33,6 +37,20 @@ struct bucket_base {
     inline static constexpr uint64_t suffix(uint64_t i) {
         return i & SUFFIX_MAX;
     }
+
+    // counts the set bits in the range [lo, hi]
+    // std::bitset provides no access to its words, but its shifts and count work word-wise, so the bits outside the range are shifted out before counting
+    static size_t count_bits(const std::bitset<MAX_NUM>& bits, const uint64_t lo, const uint64_t hi) {
+        if (hi - lo < 64) {
+            // testing few bits one by one is cheaper than shifting the whole bit vector
+            size_t count = 0;
+            for (uint64_t i = lo; i <= hi; ++i) {
+                count += bits[i];
+            }
+            return count;
+        }
+        return ((bits >> lo) << (MAX_NUM - 1 - (hi - lo))).count();
+    }
 };
 
 // This is a bucket that holds a bit vector.
@@ -52,7 +70,7 @@ struct bucket_bv : bucket_base<b_wordl> {
     set(suf);
   }
 
-  uint64_t get_min() {
+  uint64_t get_min() const {
     assert(m_size > 0);
     size_t i = 0;
     while (!m_bits[i]) {
@@ -94,6 +112,24 @@ struct bucket_bv : bucket_base<b_wordl> {
     }
     return m_prev_pred;
   }
+
+  // finds the successor of a key within this bucket only
+  KeyResult<uint64_t> successor(uint64_t key) const {
+    if (base::prefix(key) > m_prefix) {
+      return {false, 0};
+    }
+    for (uint64_t suf = base::prefix(key) < m_prefix ? 0 : base::suffix(key); suf <= base::SUFFIX_MAX; ++suf) {
+      if (m_bits[suf]) {
+        return {true, (m_prefix << b_wordl) + suf};
+      }
+    }
+    return {false, 0};
+  }
+
+  // counts the keys with suffixes in the range [lo, hi]
+  size_t count_range(uint64_t lo, uint64_t hi) const {
+    return base::count_bits(m_bits, lo, hi);
+  }
 };
 
 // This is a bucket that holds an std::vector.
@@ -113,7 +149,7 @@ struct bucket_list : bucket_base<b_wordl> {
     set(suf);
   }
 
-  uint64_t get_min() {
+  uint64_t get_min() const {
     assert(m_list.size() > 0);
     return (m_prefix << b_wordl) + *std::min_element(std::begin(m_list), std::end(m_list));
   }
@@ -157,6 +193,33 @@ struct bucket_list : bucket_base<b_wordl> {
     }
     return (m_prefix << b_wordl) + max_pred;
   }
+
+  // finds the successor of a key within this bucket only
+  KeyResult<uint64_t> successor(uint64_t key) const {
+    if (base::prefix(key) > m_prefix) {
+      return {false, 0};
+    }
+    const uint64_t suf = base::prefix(key) < m_prefix ? 0 : base::suffix(key);
+
+    bool found = false;
+    uint64_t min_succ = base::SUFFIX_MAX;
+    for (const uint64_t x : m_list) {
+      if (x >= suf && x <= min_succ) {
+        min_succ = x;
+        found = true;
+      }
+    }
+    return {found, (m_prefix << b_wordl) + min_succ};
+  }
+
+  // counts the keys with suffixes in the range [lo, hi]
+  size_t count_range(uint64_t lo, uint64_t hi) const {
+    size_t count = 0;
+    for (const uint64_t x : m_list) {
+      count += (lo <= x && x <= hi);
+    }
+    return count;
+  }
 };
 
 // This is a bucket that either holds an std::vector or a bit_vector depending
@@ -184,7 +247,7 @@ struct bucket_hybrid : bucket_base<b_wordl> {
     set(suf);
   }
 
-  uint64_t get_min() {
+  uint64_t get_min() const {
     assert(m_size > 0);
     if (m_ptr.is_first()) {
       auto& list = *m_ptr.as_first();
@@ -268,6 +331,46 @@ struct bucket_hybrid : bucket_base<b_wordl> {
     }
   }
 
+  // finds the successor of a key within this bucket only
+  KeyResult<uint64_t> successor(uint64_t key) const {
+    if (base::prefix(key) > m_prefix) {
+      return {false, 0};
+    }
+    uint64_t suf = base::prefix(key) < m_prefix ? 0 : base::suffix(key);
+    if (m_ptr.is_first()) {
+      bool found = false;
+      uint64_t min_succ = base::SUFFIX_MAX;
+      for (const uint64_t x : *m_ptr.as_first()) {
+        if (x >= suf && x <= min_succ) {
+          min_succ = x;
+          found = true;
+        }
+      }
+      return {found, (m_prefix << b_wordl) + min_succ};
+    } else {
+      auto& bv = *m_ptr.as_second();
+      for (; suf <= base::SUFFIX_MAX; ++suf) {
+        if (bv[suf]) {
+          return {true, (m_prefix << b_wordl) + suf};
+        }
+      }
+      return {false, 0};
+    }
+  }
+
+  // counts the keys with suffixes in the range [lo, hi]
+  size_t count_range(uint64_t lo, uint64_t hi) const {
+    if (m_ptr.is_first()) {
+      size_t count = 0;
+      for (const uint64_t x : *m_ptr.as_first()) {
+        count += (lo <= x && x <= hi);
+      }
+      return count;
+    } else {
+      return base::count_bits(*m_ptr.as_second(), lo, hi);
+    }
+  }
+
   void
   rebuild() {
     if (m_ptr.is_first()) {
@@ -290,6 +393,139 @@ struct bucket_hybrid : bucket_base<b_wordl> {
   }
 } __attribute__((__packed__));
 
+// This is a bucket that holds an std::vector of suffixes and a parallel
+// std::vector of values associated to the keys
+template <typename key_t, uint8_t b_wordl, typename m_value_t>
+struct bucket_list_kv : bucket_base<b_wordl> {
+  using base = bucket_base<b_wordl>;
+  using suffix_t = typename base::suffix_t;
+  using list_t = typename base::list_t;
+  using value_t = m_value_t;
+
+  const uint64_t m_prefix;
+  uint64_t m_prev_pred = 0;
+  bucket_list_kv *m_next_b = nullptr;
+  list_t m_list;
+  std::vector<value_t> m_values;
+
+  bucket_list_kv(uint64_t prefix, uint64_t prev_pred, bucket_list_kv *next_b, suffix_t suf, const value_t &value)
+      : m_prefix(prefix), m_prev_pred(prev_pred), m_next_b(next_b) {
+    set(suf, value);
+  }
+
+  // finds the position of a suffix, or size() if it is not contained
+  size_t find_pos(uint64_t suf) const {
+    size_t i = 0;
+    while (i < m_list.size() && m_list[i] != suf) {
+      ++i;
+    }
+    return i;
+  }
+
+  // finds the position of the largest suffix less than or equal to the suffix of key, or size() if there is none
+  size_t predecessor_pos(int64_t key) const {
+    key = base::prefix(key) != m_prefix ? base::SUFFIX_MAX : base::suffix(key);
+    size_t pos = m_list.size();
+    for (size_t i = 0; i < m_list.size(); ++i) {
+      if (m_list[i] <= (uint64_t)key && (pos == m_list.size() || m_list[i] > m_list[pos])) {
+        pos = i;
+      }
+    }
+    return pos;
+  }
+
+  // finds the position of the smallest suffix greater than or equal to the suffix of key, or size() if there is none
+  size_t successor_pos(uint64_t key) const {
+    if (base::prefix(key) > m_prefix) {
+      return m_list.size();
+    }
+    const uint64_t suf = base::prefix(key) < m_prefix ? 0 : base::suffix(key);
+    size_t pos = m_list.size();
+    for (size_t i = 0; i < m_list.size(); ++i) {
+      if (m_list[i] >= suf && (pos == m_list.size() || m_list[i] < m_list[pos])) {
+        pos = i;
+      }
+    }
+    return pos;
+  }
+
+  uint64_t get_min() const {
+    assert(m_list.size() > 0);
+    return (m_prefix << b_wordl) + *std::min_element(std::begin(m_list), std::end(m_list));
+  }
+
+  void set(uint64_t suf, const value_t &value) {
+    m_list.push_back(suf);
+    m_values.push_back(value);
+    if (tdc_likely(m_next_b != nullptr)) {
+      m_next_b->m_prev_pred = std::max((m_prefix << b_wordl) + suf, m_next_b->m_prev_pred);
+    }
+  }
+
+  void remove(uint64_t suf) {
+    const size_t i = find_pos(suf);
+    assert(i < m_list.size());
+    m_list[i] = (suffix_t)m_list.back();
+    m_list.pop_back();
+    m_values[i] = std::move(m_values.back());
+    m_values.pop_back();
+    // here we update next_b->prev_pred
+    if (tdc_likely(m_next_b != nullptr)) {
+      if (m_next_b->m_prev_pred == (m_prefix << b_wordl) + suf) {
+        m_next_b->m_prev_pred = predecessor((m_prefix << b_wordl) + suf);
+      }
+    }
+  }
+
+  size_t size() {
+    return m_list.size();
+  }
+
+  uint64_t predecessor(int64_t key) const {
+    const size_t pos = predecessor_pos(key);
+    return pos < m_list.size() ? (m_prefix << b_wordl) + m_list[pos] : m_prev_pred;
+  }
+
+  // finds the predecessor of a key within this bucket only, along with its value
+  KeyValueResult<uint64_t, value_t> predecessor_entry(int64_t key) const {
+    const size_t pos = predecessor_pos(key);
+    if (pos == m_list.size()) {
+      return {false, 0, value_t()};
+    }
+    return {true, (m_prefix << b_wordl) + m_list[pos], m_values[pos]};
+  }
+
+  // finds the successor of a key within this bucket only
+  KeyResult<uint64_t> successor(uint64_t key) const {
+    const size_t pos = successor_pos(key);
+    return {pos < m_list.size(), pos < m_list.size() ? (m_prefix << b_wordl) + m_list[pos] : 0};
+  }
+
+  // finds the successor of a key within this bucket only, along with its value
+  KeyValueResult<uint64_t, value_t> successor_entry(uint64_t key) const {
+    const size_t pos = successor_pos(key);
+    if (pos == m_list.size()) {
+      return {false, 0, value_t()};
+    }
+    return {true, (m_prefix << b_wordl) + m_list[pos], m_values[pos]};
+  }
+
+  // finds the value associated to a suffix, or nullptr if it is not contained
+  value_t *find(uint64_t suf) {
+    const size_t i = find_pos(suf);
+    return i < m_list.size() ? &m_values[i] : nullptr;
+  }
+
+  // counts the keys with suffixes in the range [lo, hi]
+  size_t count_range(uint64_t lo, uint64_t hi) const {
+    size_t count = 0;
+    for (const uint64_t x : m_list) {
+      count += (lo <= x && x <= hi);
+    }
+    return count;
+  }
+};
+
 template <typename key_t, uint8_t b_wordl>
 struct map_bucket_bv : bucket_base<b_wordl> {
   using base = bucket_base<b_wordl>;
@@ -316,7 +552,7 @@ struct map_bucket_bv : bucket_base<b_wordl> {
   map_bucket_bv& operator=(const map_bucket_bv&) = delete;
   map_bucket_bv& operator=(map_bucket_bv&&) = delete;
 
-  uint64_t get_min() {
+  uint64_t get_min() const {
     assert(m_size > 0);
     size_t suf = 0;
     while (!(*m_bits)[suf]) {
@@ -346,6 +582,20 @@ struct map_bucket_bv : bucket_base<b_wordl> {
     }
     return {false, 0};
   }
+
+  KeyResult<uint64_t> successor(uint64_t suf) const {
+    for (; suf <= base::SUFFIX_MAX; ++suf) {
+      if ((*m_bits)[suf]) {
+        return {true, suf};
+      }
+    }
+    return {false, 0};
+  }
+
+  // counts the suffixes in the range [lo, hi]
+  size_t count_range(uint64_t lo, uint64_t hi) const {
+    return base::count_bits(*m_bits, lo, hi);
+  }
 } __attribute__((__packed__));
 
 // This is a bucket that holds an std::vector.
@@ -369,7 +619,7 @@ struct map_bucket_list : bucket_base<b_wordl> {
   map_bucket_list& operator=(const map_bucket_list&) = delete;
   map_bucket_list& operator=(map_bucket_list&&) = delete;
 
-  uint64_t get_min() {
+  uint64_t get_min() const {
     assert(m_list.size() > 0);
     return *std::min_element(std::begin(m_list), std::end(m_list));
   }
@@ -402,6 +652,27 @@ struct map_bucket_list : bucket_base<b_wordl> {
     }
     return {true, max_pred};
   }
+
+  KeyResult<uint64_t> successor(uint64_t suf) const {
+    bool found = false;
+    uint64_t min_succ = base::SUFFIX_MAX;
+    for (const uint64_t x : m_list) {
+      if (x >= suf && x <= min_succ) {
+        min_succ = x;
+        found = true;
+      }
+    }
+    return {found, min_succ};
+  }
+
+  // counts the suffixes in the range [lo, hi]
+  size_t count_range(uint64_t lo, uint64_t hi) const {
+    size_t count = 0;
+    for (const uint64_t x : m_list) {
+      count += (lo <= x && x <= hi);
+    }
+    return count;
+  }
 };
 
 // This is a bucket that holds a sorted std::vector.
@@ -425,7 +696,7 @@ struct map_bucket_slist : bucket_base<b_wordl> {
   map_bucket_slist& operator=(const map_bucket_slist&) = delete;
   map_bucket_slist& operator=(map_bucket_slist&&) = delete;
 
-  uint64_t get_min() {
+  uint64_t get_min() const {
     assert(m_list.size() > 0);
     return m_list[0];
   }
@@ -471,6 +742,24 @@ struct map_bucket_slist : bucket_base<b_wordl> {
         return {false, 0};
     }
   }
+
+  KeyResult<uint64_t> successor(uint64_t suf) const {
+    auto succ = BinarySearch<suffix_t>::successor(m_list, size(), suf);
+    if(succ.exists) {
+        return {true, m_list[succ.pos]};
+    } else {
+        return {false, 0};
+    }
+  }
+
+  // counts the suffixes in the range [lo, hi]
+  size_t count_range(uint64_t lo, uint64_t hi) const {
+    auto first = BinarySearch<suffix_t>::successor(m_list, size(), lo);
+    if(!first.exists) return 0;
+    auto last = BinarySearch<suffix_t>::predecessor(m_list, size(), hi);
+    if(!last.exists || last.pos < first.pos) return 0;
+    return last.pos - first.pos + 1;
+  }
 };
 
 // This is a bucket that either holds an std::vector or a bit_vector depending
@@ -501,7 +790,7 @@ struct map_bucket_hybrid : bucket_base<b_wordl> {
   map_bucket_hybrid& operator=(const map_bucket_hybrid& other) = delete;
   map_bucket_hybrid& operator=(map_bucket_hybrid&& other) = delete;
 
-  uint64_t get_min() {
+  uint64_t get_min() const {
     assert(m_size > 0);
     if (m_ptr.is_first()) {
       auto& list = *m_ptr.as_first();
@@ -572,6 +861,41 @@ struct map_bucket_hybrid : bucket_base<b_wordl> {
     }
   }
 
+  KeyResult<uint64_t> successor(uint64_t suf) const {
+    if (m_ptr.is_first()) {
+      bool found = false;
+      uint64_t min_succ = base::SUFFIX_MAX;
+      for (const uint64_t x : *m_ptr.as_first()) {
+        if (x >= suf && x <= min_succ) {
+          min_succ = x;
+          found = true;
+        }
+      }
+      return {found, min_succ};
+    } else {
+      auto& bv = *m_ptr.as_second();
+      for (; suf <= base::SUFFIX_MAX; ++suf) {
+        if (bv[suf]) {
+          return {true, suf};
+        }
+      }
+      return {false, 0};
+    }
+  }
+
+  // counts the suffixes in the range [lo, hi]
+  size_t count_range(uint64_t lo, uint64_t hi) const {
+    if (m_ptr.is_first()) {
+      size_t count = 0;
+      for (const uint64_t x : *m_ptr.as_first()) {
+        count += (lo <= x && x <= hi);
+      }
+      return count;
+    } else {
+      return base::count_bits(*m_ptr.as_second(), lo, hi);
+    }
+  }
+
   void rebuild() {
     if (m_ptr.is_first()) {
       m_size = 0;
@@ -1,6 +1,9 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 #include <tdc/pred/result.hpp>
 
 namespace tdc {
@@ -34,6 +37,7 @@ class yfast_bucket {
   yfast_bucket* m_next;                                            // Pointer to the next greater bucket.
   t_value_type m_min;                                              // The smallest key in the bucket. This is the representant.
   bool m_repr_active;                                              // Says whether the representative is active
+  uint32_t m_handle = 0;                                           // The handle of the bucket in a compact xfast_trie, or 0 if it has none.
   std::vector<t_value_type> m_elem;                                // The keys in stored by the bucket without the representant.
 
  public:
@@ -41,10 +45,39 @@ class yfast_bucket {
       : m_min(repr), m_repr_active(repr_active), m_prev(prev), m_next(next) {
   }
 
+  // The number of keys a bucket receives when the bucket list is constructed bottom-up.
+  static constexpr size_t bulk_size = c_bucket_size;
+
+  // Appends a new bucket with the given representant after this bucket, which must be the last one, and returns it.
+  // Keys greater than the representant can then be added to the new bucket in ascending order using insert.
+  yfast_bucket* append(const t_value_type repr) {
+    assert(m_next == nullptr);
+    m_next = new yfast_bucket(repr, true, this, nullptr);
+    return m_next;
+  }
+
+  // Appends the keys of the bucket to the given vector in ascending order.
+  void collect(std::vector<uint64_t>& out) const {
+    const size_t first = out.size();
+    if (m_repr_active) {
+      out.push_back(static_cast<uint64_t>(m_min));
+    }
+    for (auto elem : m_elem) {
+      out.push_back(static_cast<uint64_t>(elem));
+    }
+    std::sort(out.begin() + first, out.end());
+  }
+
   // Returns the next smaller bucket.
   yfast_bucket* get_prev() const { return m_prev; }
+  // Returns the next greater bucket.
+  yfast_bucket* get_next() const { return m_next; }
   // Return the representant.
   t_value_type get_repr() const { return m_min; }
+  // Returns the handle assigned by a compact xfast_trie.
+  uint32_t get_handle() const { return m_handle; }
+  // Sets the handle assigned by a compact xfast_trie.
+  void set_handle(const uint32_t handle) { m_handle = handle; }
 
   // Inserts the key into the bucket and return the chages that have to be done
   // to the xfast_trie. A bucket may become too large and split. Then we have
@@ -183,6 +216,39 @@ class yfast_bucket {
       }
     }
   }
+
+  // Returns the successor in the bucket.
+  KeyResult<uint64_t> successor(t_value_type key) const {
+    bool found = m_repr_active && m_min >= key;
+    t_value_type min_succ = m_min;
+    for (auto elem : m_elem) {
+      if (elem >= key && (!found || elem < min_succ)) {
+        min_succ = elem;
+        found = true;
+      }
+    }
+    if (found) {
+      //We found a correct successor
+      return {true, static_cast<uint64_t>(min_succ)};
+    } else {
+      if (m_next != nullptr) {
+        // The successor is in the next bucket
+        return m_next->successor(key);
+      } else {
+        // There is no next bucket and therefore no successor
+        return {false, 0};
+      }
+    }
+  }
+
+  // Returns the number of keys in the bucket that lie in the range [a, b].
+  size_t count_range(t_value_type a, t_value_type b) const {
+    size_t count = (m_repr_active && a <= m_min && m_min <= b) ? 1 : 0;
+    for (auto elem : m_elem) {
+      count += (a <= elem && elem <= b);
+    }
+    return count;
+  }
 };
 
 template <typename t_value_type, uint8_t t_bucket_width, uint8_t t_merge_threshold = 2>
@@ -193,6 +259,7 @@ class yfast_bucket_sl {
   yfast_bucket_sl* m_next;                                         // Pointer to the next greater bucket.
   t_value_type m_min;                                              // The smallest key in the bucket. This is the representant.
   bool m_repr_active;                                              // Says whether the representative is active
+  uint32_t m_handle = 0;                                           // The handle of the bucket in a compact xfast_trie, or 0 if it has none.
   std::vector<t_value_type> m_elem;                                // The keys in stored by the bucket without the representant.
 
  public:
@@ -200,10 +267,37 @@ class yfast_bucket_sl {
       : m_min(repr), m_repr_active(repr_active), m_prev(prev), m_next(next) {
   }
 
+  // The number of keys a bucket receives when the bucket list is constructed bottom-up.
+  static constexpr size_t bulk_size = c_bucket_size;
+
+  // Appends a new bucket with the given representant after this bucket, which must be the last one, and returns it.
+  // Keys greater than the representant can then be added to the new bucket in ascending order using insert.
+  yfast_bucket_sl* append(const t_value_type repr) {
+    assert(m_next == nullptr);
+    m_next = new yfast_bucket_sl(repr, true, this, nullptr);
+    return m_next;
+  }
+
+  // Appends the keys of the bucket to the given vector in ascending order.
+  void collect(std::vector<uint64_t>& out) const {
+    if (m_repr_active) {
+      out.push_back(static_cast<uint64_t>(m_min));
+    }
+    for (auto elem : m_elem) {
+      out.push_back(static_cast<uint64_t>(elem));
+    }
+  }
+
   // Returns the next smaller bucket.
   yfast_bucket_sl* get_prev() const { return m_prev; }
+  // Returns the next greater bucket.
+  yfast_bucket_sl* get_next() const { return m_next; }
   // Return the representant.
   t_value_type get_repr() const { return m_min; }
+  // Returns the handle assigned by a compact xfast_trie.
+  uint32_t get_handle() const { return m_handle; }
+  // Sets the handle assigned by a compact xfast_trie.
+  void set_handle(const uint32_t handle) { m_handle = handle; }
 
   // Inserts the key into the bucket and return the chages that have to be done
   // to the xfast_trie. A bucket may become too large and split. Then we have
@@ -350,6 +444,34 @@ class yfast_bucket_sl {
       }
     }
   }
+
+  // Returns the successor in the bucket.
+  KeyResult<uint64_t> successor(t_value_type key) const {
+    if (m_repr_active && m_min >= key) {
+      // The representant is smaller than all other keys
+      return {true, static_cast<uint64_t>(m_min)};
+    }
+    auto it = std::lower_bound(m_elem.begin(), m_elem.end(), key);
+    if (it != m_elem.end()) {
+      //We found a correct successor
+      return {true, static_cast<uint64_t>(*it)};
+    } else {
+      if (m_next != nullptr) {
+        // The successor is in the next bucket
+        return m_next->successor(key);
+      } else {
+        // There is no next bucket and therefore no successor
+        return {false, 0};
+      }
+    }
+  }
+
+  // Returns the number of keys in the bucket that lie in the range [a, b].
+  size_t count_range(t_value_type a, t_value_type b) const {
+    size_t count = (m_repr_active && a <= m_min && m_min <= b) ? 1 : 0;
+    count += std::upper_bound(m_elem.begin(), m_elem.end(), b) - std::lower_bound(m_elem.begin(), m_elem.end(), a);
+    return count;
+  }
 };
 
 }  // namespace dynamic
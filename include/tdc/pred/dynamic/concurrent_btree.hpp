@@ -0,0 +1,473 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#include <tdc/pred/result.hpp>
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+/// \brief A B+-tree that supports concurrent queries and updates using optimistic lock coupling.
+///
+/// Every node carries a version counter that doubles as a write lock.
+/// Readers never acquire any locks: they record the version of a node before reading it and validate it afterwards,
+/// restarting the operation if the node has been modified in the meantime.
+/// Writers descend the same way and only lock the nodes they modify, i.e., the leaf and, in case of a split, its parent.
+/// Full nodes are split eagerly on the way down, so splits never propagate upwards.
+///
+/// All keys are stored in the leaves, inner nodes contain copies of keys as separators.
+/// Since readers may read keys while a writer modifies them, keys and child pointers are accessed atomically, using relaxed memory order.
+///
+/// A leaf that becomes empty as a result of a removal is unlinked from its parent, so that its key range falls to a sibling,
+/// unless it is the only child. Unlinked leaves remain locked, so concurrent operations that reach them restart,
+/// and they are only freed when the tree is destroyed, so concurrent readers need no memory reclamation scheme.
+/// Inner nodes are never merged.
+///
+/// \tparam key_t the key type
+/// \tparam degree the maximum number of children of an inner node; leaves hold up to degree-1 keys
+template<std::totally_ordered m_key_t, size_t m_degree>
+class ConcurrentBTree {
+public:
+    /// \brief The contained key type.
+    using key_t = m_key_t;
+
+    /// \brief The maximum number of children of an inner node.
+    static constexpr size_t degree = m_degree;
+
+private:
+    static_assert(m_degree > 2);
+    static_assert(m_degree < 65536);
+
+    static_assert(std::is_trivially_copyable_v<m_key_t>);
+
+    static constexpr size_t m_max_node_keys = m_degree - 1;
+
+    struct Node {
+        // the least significant bit indicates that the node is locked, every modification increments the version by two
+        std::atomic<uint64_t> m_version;
+        std::atomic<uint16_t> m_size;
+        const bool m_leaf;
+        std::atomic<key_t> m_keys[m_max_node_keys];
+        Node* m_next_retired; // the next unlinked node, used to free unlinked nodes when the tree is destroyed
+
+        Node(const bool leaf) : m_version(0), m_size(0), m_leaf(leaf), m_next_retired(nullptr) {
+        }
+
+        // reads the number of keys, which may be inconsistent during a concurrent modification, but never exceeds the capacity
+        size_t size() const {
+            return std::min(size_t(m_size.load(std::memory_order_relaxed)), m_max_node_keys);
+        }
+
+        key_t key(const size_t i) const {
+            return m_keys[i].load(std::memory_order_relaxed);
+        }
+
+        void set_key(const size_t i, const key_t x) {
+            m_keys[i].store(x, std::memory_order_relaxed);
+        }
+
+        // moves the keys in [first, last) by the given distance, the node must be locked
+        void shift_keys(const size_t first, const size_t last, const ptrdiff_t distance) {
+            if(distance > 0) {
+                for(size_t j = last; j > first; j--) set_key(j - 1 + distance, key(j - 1));
+            } else {
+                for(size_t j = first; j < last; j++) set_key(j + distance, key(j));
+            }
+        }
+
+        // finds the position of the first key greater than or equal to x
+        size_t lower_bound(const key_t x) const {
+            // count the smaller keys, which is branch-free
+            const size_t n = size();
+            size_t i = 0;
+            for(size_t j = 0; j < n; j++) i += (key(j) < x);
+            return i;
+        }
+
+        // finds the position of the first key greater than x
+        size_t upper_bound(const key_t x) const {
+            const size_t n = size();
+            size_t i = 0;
+            for(size_t j = 0; j < n; j++) i += (key(j) <= x);
+            return i;
+        }
+    };
+
+    struct Inner : public Node {
+        std::atomic<Node*> m_children[m_degree];
+
+        Inner() : Node(false) {
+        }
+
+        Node* child(const size_t i) const {
+            return m_children[i].load(std::memory_order_relaxed);
+        }
+
+        void set_child(const size_t i, Node* node) {
+            m_children[i].store(node, std::memory_order_relaxed);
+        }
+
+        // moves the children in [first, last) by the given distance, the node must be locked
+        void shift_children(const size_t first, const size_t last, const ptrdiff_t distance) {
+            if(distance > 0) {
+                for(size_t j = last; j > first; j--) set_child(j - 1 + distance, child(j - 1));
+            } else {
+                for(size_t j = first; j < last; j++) set_child(j + distance, child(j));
+            }
+        }
+    };
+
+    // records the version of the node, fails if it is currently locked
+    static bool read_lock(const Node* node, uint64_t& version) {
+        version = node->m_version.load(std::memory_order_acquire);
+        if(version & 1ULL) {
+            std::this_thread::yield();
+            return false;
+        }
+        return true;
+    }
+
+    // tests whether the node has not been modified since the version was recorded
+    static bool validate(const Node* node, const uint64_t version) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return node->m_version.load(std::memory_order_relaxed) == version;
+    }
+
+    // locks the node, fails if it has been modified since the version was recorded
+    static bool upgrade_lock(Node* node, uint64_t& version) {
+        uint64_t expected = version;
+        if(node->m_version.compare_exchange_strong(expected, version + 1, std::memory_order_acquire)) {
+            std::atomic_thread_fence(std::memory_order_release);
+            ++version;
+            return true;
+        } else {
+            std::this_thread::yield();
+            return false;
+        }
+    }
+
+    static void unlock(Node* node) {
+        node->m_version.fetch_add(1, std::memory_order_release);
+    }
+
+    static void free_subtree(Node* node) {
+        if(!node->m_leaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            for(size_t i = 0; i <= inner->size(); i++) {
+                free_subtree(inner->child(i));
+            }
+            delete inner;
+        } else {
+            delete node;
+        }
+    }
+
+    static size_t count_leaves(const Node* node) {
+        if(node->m_leaf) return 1;
+
+        const Inner* inner = static_cast<const Inner*>(node);
+        size_t num = 0;
+        for(size_t i = 0; i <= inner->size(); i++) {
+            num += count_leaves(inner->child(i));
+        }
+        return num;
+    }
+
+    std::atomic<Node*> m_root;
+    std::atomic<size_t> m_size;
+    std::atomic<Node*> m_retired; // the unlinked nodes
+
+    // unlinks the empty and locked leaf from the locked parent, which must have at least two children
+    // the leaf remains locked, so that concurrent operations that reach it restart
+    void unlink(Node* leaf, Inner* parent) {
+        const size_t pn = parent->size();
+        assert(leaf->size() == 0 && pn > 0);
+
+        size_t i = 0;
+        while(parent->child(i) != leaf) ++i;
+        assert(i <= pn);
+
+        // the key range of the leaf falls to its left sibling, or to the right sibling if it is the leftmost child
+        const size_t k = (i > 0) ? i - 1 : 0;
+        parent->shift_keys(k + 1, pn, -1);
+        parent->shift_children(i + 1, pn + 1, -1);
+        parent->m_size.store(pn - 1, std::memory_order_relaxed);
+
+        leaf->m_next_retired = m_retired.load(std::memory_order_relaxed);
+        while(!m_retired.compare_exchange_weak(leaf->m_next_retired, leaf, std::memory_order_relaxed)) {
+        }
+    }
+
+    // splits the full and locked node, inserting the separator and the new sibling into the locked parent, or into a new root
+    void split(Node* node, Inner* parent) {
+        const size_t n = node->size();
+        assert(n == m_max_node_keys);
+
+        Node* sibling;
+        key_t sep;
+        if(node->m_leaf) {
+            // the separator is the largest key remaining in the left leaf
+            const size_t mid = n / 2;
+            sibling = new Node(true);
+            for(size_t j = mid; j < n; j++) sibling->set_key(j - mid, node->key(j));
+            sibling->m_size.store(n - mid, std::memory_order_relaxed);
+            sep = node->key(mid - 1);
+            node->m_size.store(mid, std::memory_order_relaxed);
+        } else {
+            // the middle key moves up as the separator
+            const size_t mid = n / 2;
+            Inner* inner = static_cast<Inner*>(node);
+            Inner* inner_sibling = new Inner();
+            for(size_t j = mid + 1; j < n; j++) inner_sibling->set_key(j - mid - 1, inner->key(j));
+            for(size_t j = mid + 1; j <= n; j++) inner_sibling->set_child(j - mid - 1, inner->child(j));
+            inner_sibling->m_size.store(n - mid - 1, std::memory_order_relaxed);
+            sep = inner->key(mid);
+            inner->m_size.store(mid, std::memory_order_relaxed);
+            sibling = inner_sibling;
+        }
+
+        if(parent) {
+            const size_t pn = parent->size();
+            assert(pn < m_max_node_keys);
+
+            const size_t i = parent->lower_bound(sep);
+            parent->shift_keys(i, pn, 1);
+            parent->shift_children(i + 1, pn + 1, 1);
+            parent->set_key(i, sep);
+            parent->set_child(i + 1, sibling);
+            parent->m_size.store(pn + 1, std::memory_order_relaxed);
+        } else {
+            Inner* root = new Inner();
+            root->set_key(0, sep);
+            root->set_child(0, node);
+            root->set_child(1, sibling);
+            root->m_size.store(1, std::memory_order_relaxed);
+            m_root.store(root, std::memory_order_release);
+        }
+    }
+
+    // descends to the leaf responsible for the given key and locks it
+    // also reports the parent of the leaf, if any, and its version, which has been validated after locking the leaf
+    // returns nullptr if the operation needs to be restarted
+    Node* lock_leaf(const key_t x, Inner*& out_parent, uint64_t& out_parent_version) {
+        Node* node = m_root.load(std::memory_order_acquire);
+        uint64_t version;
+        if(!read_lock(node, version) || node != m_root.load(std::memory_order_acquire)) return nullptr;
+
+        Inner* parent = nullptr;
+        uint64_t parent_version = 0;
+        while(true) {
+            if(node->size() == m_max_node_keys) {
+                // the node is full, split it eagerly and restart
+                if(parent && !upgrade_lock(parent, parent_version)) return nullptr;
+                if(!upgrade_lock(node, version)) {
+                    if(parent) unlock(parent);
+                    return nullptr;
+                }
+                if(!parent && node != m_root.load(std::memory_order_acquire)) {
+                    // the root has been split concurrently
+                    unlock(node);
+                    return nullptr;
+                }
+
+                split(node, parent);
+                unlock(node);
+                if(parent) unlock(parent);
+                return nullptr;
+            }
+
+            if(parent && !validate(parent, parent_version)) return nullptr;
+            if(node->m_leaf) break;
+
+            Inner* inner = static_cast<Inner*>(node);
+            Node* child = inner->child(inner->lower_bound(x));
+            if(!validate(inner, version)) return nullptr;
+
+            parent = inner;
+            parent_version = version;
+            node = child;
+            if(!read_lock(node, version)) return nullptr;
+        }
+
+        if(!upgrade_lock(node, version)) return nullptr;
+        if(parent && !validate(parent, parent_version)) {
+            unlock(node);
+            return nullptr;
+        }
+        out_parent = parent;
+        out_parent_version = parent_version;
+        return node;
+    }
+
+public:
+    /// \brief Constructs an empty tree.
+    ConcurrentBTree() : m_root(new Node(true)), m_size(0), m_retired(nullptr) {
+    }
+
+    ~ConcurrentBTree() {
+        free_subtree(m_root.load());
+        for(Node* node = m_retired.load(); node != nullptr;) {
+            Node* next = node->m_next_retired;
+            delete node;
+            node = next;
+        }
+    }
+
+    ConcurrentBTree(const ConcurrentBTree&) = delete;
+    ConcurrentBTree& operator=(const ConcurrentBTree&) = delete;
+
+    /// \brief Finds the predecessor of the specified key in the tree.
+    ///
+    /// This never blocks, but may be restarted if a concurrent update modifies any visited node.
+    ///
+    /// \param x the key in question
+    KeyResult<key_t> predecessor(key_t x) const {
+        while(true) {
+            Node* node = m_root.load(std::memory_order_acquire);
+            uint64_t version;
+            if(!read_lock(node, version) || node != m_root.load(std::memory_order_acquire)) continue;
+
+            // the largest separator less than x on the path, which is an exclusive lower bound for the keys in the leaf
+            bool has_fence = false;
+            key_t fence = key_t();
+
+            // the parent is validated after the version of the child has been recorded, which makes sure the child has not been split in between
+            const Node* parent = nullptr;
+            uint64_t parent_version = 0;
+
+            bool restart = false;
+            while(!node->m_leaf) {
+                const Inner* inner = static_cast<const Inner*>(node);
+                if(parent && !validate(parent, parent_version)) {
+                    restart = true;
+                    break;
+                }
+
+                const size_t i = inner->lower_bound(x);
+                if(i > 0) {
+                    has_fence = true;
+                    fence = inner->key(i - 1);
+                }
+                Node* child = inner->child(i);
+                if(!validate(inner, version)) {
+                    restart = true;
+                    break;
+                }
+
+                parent = inner;
+                parent_version = version;
+                node = child;
+                if(!read_lock(node, version)) {
+                    restart = true;
+                    break;
+                }
+            }
+            if(restart) continue;
+
+            const size_t i = node->upper_bound(x);
+            const key_t pred = (i > 0) ? node->key(i - 1) : key_t();
+            if(!validate(node, version) || (parent && !validate(parent, parent_version))) continue;
+
+            if(i > 0) {
+                return { true, pred };
+            } else if(has_fence) {
+                // the leaf contains no key less than or equal to x, so there is none in between the fence and x either
+                x = fence;
+            } else {
+                return { false, 0 };
+            }
+        }
+    }
+
+    /// \brief Tests whether the given key is contained in the tree.
+    /// \param x the key in question
+    bool contains(const key_t x) const {
+        const auto r = predecessor(x);
+        return r.exists && r.key == x;
+    }
+
+    /// \brief Inserts the specified key, unless it is already contained.
+    /// \param key the key to insert
+    /// \return whether the key was inserted
+    bool insert(const key_t key) {
+        Node* leaf;
+        Inner* parent;
+        uint64_t parent_version;
+        while((leaf = lock_leaf(key, parent, parent_version)) == nullptr) {
+        }
+
+        const size_t n = leaf->size();
+        const size_t i = leaf->lower_bound(key);
+        const bool contained = (i < n && leaf->key(i) == key);
+        if(!contained) {
+            leaf->shift_keys(i, n, 1);
+            leaf->set_key(i, key);
+            leaf->m_size.store(n + 1, std::memory_order_relaxed);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+        }
+        unlock(leaf);
+        return !contained;
+    }
+
+    /// \brief Removes the specified key.
+    /// \param key the key to remove
+    /// \return whether the key was found and removed
+    bool remove(const key_t key) {
+        while(true) {
+            Inner* parent;
+            uint64_t parent_version;
+            Node* leaf = lock_leaf(key, parent, parent_version);
+            if(!leaf) continue;
+
+            const size_t n = leaf->size();
+            const size_t i = leaf->lower_bound(key);
+            const bool contained = (i < n && leaf->key(i) == key);
+            if(!contained) {
+                unlock(leaf);
+                return false;
+            }
+
+            // if the leaf becomes empty, it is unlinked from its parent, which needs to be locked as well
+            const bool unlink_leaf = (n == 1 && parent && parent->size() > 0);
+            if(unlink_leaf && !upgrade_lock(parent, parent_version)) {
+                unlock(leaf);
+                continue;
+            }
+
+            leaf->shift_keys(i + 1, n, -1);
+            leaf->m_size.store(n - 1, std::memory_order_relaxed);
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+
+            if(unlink_leaf) {
+                unlink(leaf, parent);
+                unlock(parent);
+            } else {
+                unlock(leaf);
+            }
+            return true;
+        }
+    }
+
+    /// \brief Returns the number of contained keys.
+    ///
+    /// In the presence of concurrent updates, this is only a snapshot.
+    size_t size() const {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    /// \brief Reports the number of leaves in the tree.
+    ///
+    /// This must not be called concurrently with updates.
+    size_t num_leaves() const {
+        return count_leaves(m_root.load());
+    }
+};
+
+}}} // namespace tdc::pred::dynamic
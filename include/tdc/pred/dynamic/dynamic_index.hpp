@@ -5,7 +5,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <stdexcept>
 #include <tdc/pred/dynamic/buckets/buckets.hpp>
+#include <tdc/pred/dynamic/dynamic_index_top.hpp>
+#include <tdc/pred/dynamic/snapshot.hpp>
+#include <tdc/pred/dynamic/successor_iterator.hpp>
 #include <tdc/pred/result.hpp>
 #include <tdc/util/assert.hpp>
 #include <tdc/util/concepts.hpp>
@@ -18,7 +22,9 @@ namespace dynamic {
 
 // TODO: use int_vector so that sampling parameter works
 /// \brief Dynamic predecessor search using universe-based sampling.
-template <std::totally_ordered key_t, uint8_t t_sampling, typename bucket>
+///
+/// \tparam top the top directory that maps each prefix to its bucket, see dynamic_index_top.hpp
+template <std::totally_ordered key_t, uint8_t t_sampling, typename bucket, typename top = dense_top<bucket>>
 class DynIndex {
  private:
   // The bottom part of the data structure is either
@@ -27,11 +33,14 @@ class DynIndex {
   static constexpr size_t b_max = (1ULL << b_wordl) - 1;
 
   static_assert(bucket::suffix_bits == b_wordl, "bucket size not matching sampling parameter");
+
+  // whether the buckets associate values with the keys
+  static constexpr bool has_values = requires { typename bucket::value_t; };
   
   uint64_t m_size = 0;                                    // number of keys stored
   uint64_t m_min = std::numeric_limits<uint64_t>::max();  // stores the minimal key
   uint64_t m_max = std::numeric_limits<uint64_t>::min();  // stores the maximal key
-  std::vector<bucket *> m_top;                            // top data structure
+  top m_top;                                              // top data structure
   bucket *m_first_b = nullptr;                            // pointer to the first bucket
 
   // return the x_wordl more significant bits of i
@@ -56,7 +65,14 @@ class DynIndex {
     return m_size;
   }
 
-  void insert(const uint64_t key) {
+  /// \brief Inserts the specified key, which must not be contained yet.
+  ///
+  /// If the buckets store values (e.g., \ref bucket_list_kv), the value associated with the key is passed as well.
+  ///
+  /// \param key the key to insert
+  /// \param value the associated value, if any
+  template <typename... value_args>
+  void insert(const uint64_t key, const value_args &...value) {
     assert(!predecessor(key).exists || predecessor(key).key != key);
     const uint64_t key_pre = prefix(key);
     const uint64_t key_suf = suffix(key);
@@ -65,25 +81,24 @@ class DynIndex {
     // if a key is inserted that needs a greater bucket
     if (key_pre >= m_top.size()) {
       if (tdc_likely(m_size != 0)) {
-        new_b = new bucket(key_pre, m_max, nullptr, key_suf);
-        m_top.back()->m_next_b = new_b;
-        m_top.resize(prefix(key) + 1, m_top.back());
+        new_b = new bucket(key_pre, m_max, nullptr, key_suf, value...);
+        m_top.get(m_top.size() - 1)->m_next_b = new_b;
       } else {
-        new_b = new bucket(key_pre, 0, nullptr, key_suf);
+        new_b = new bucket(key_pre, 0, nullptr, key_suf, value...);
         m_first_b = new_b;
-        m_top.resize(prefix(key) + 1, nullptr);
       }
+      m_top.extend(key_pre + 1);
     } else if (key_pre < prefix(m_min)) {
       // if a key is inserted before the first bucket
-      new_b = new bucket(key_pre, 0, m_first_b, key_suf);
+      new_b = new bucket(key_pre, 0, m_first_b, key_suf, value...);
       m_first_b = new_b;
     } else {
       // if a key is inserted inbetween
-      bucket *key_bucket = m_top[key_pre];
+      bucket *key_bucket = m_top.get(key_pre);
       bucket *next_bucket = key_bucket->m_next_b;
       // if exact bucket exists, add key
       if (key_bucket->m_prefix == key_pre) {
-        key_bucket->set(key_suf);
+        key_bucket->set(key_suf, value...);
         m_min = std::min(key, m_min);
         m_max = std::max(key, m_max);
         ++m_size;
@@ -91,7 +106,7 @@ class DynIndex {
         return;
       } else {
         // if exact bucket does not exist
-        new_b = new bucket(key_pre, next_bucket->m_prev_pred, next_bucket, key_suf);
+        new_b = new bucket(key_pre, next_bucket->m_prev_pred, next_bucket, key_suf, value...);
         // pointer in next_bucket
         key_bucket->m_next_b = new_b;
         assert(key_bucket->m_prefix < new_b->m_prefix);
@@ -102,16 +117,8 @@ class DynIndex {
     ++m_size;
     m_min = std::min(key, m_min);
     m_max = std::max(key, m_max);
-    // update xfast
-    m_top[key_pre] = new_b;
-    if (key_pre + 1 < m_top.size()) {
-      bucket *next_bucket = m_top[key_pre + 1];
-      if (next_bucket == nullptr || next_bucket->m_prefix < key_pre) {
-        for (size_t j = key_pre + 1; j < m_top.size() && next_bucket == m_top[j]; ++j) {
-          m_top[j] = new_b;
-        }
-      }
-    }
+    // update top, the new bucket is responsible for all prefixes up to the next bucket
+    m_top.add_bucket(new_b, new_b->m_next_b != nullptr ? new_b->m_next_b->m_prefix : m_top.size());
     assert(predecessor(key).key == key);
   }
 
@@ -120,8 +127,8 @@ class DynIndex {
     --m_size;
     const uint64_t key_pre = prefix(key);
     const uint64_t key_suf = suffix(key);
-    bucket *const key_bucket = m_top[key_pre];
-    bucket *const prev_bucket = m_top[prefix(key_bucket->m_prev_pred)];
+    bucket *const key_bucket = m_top.get(key_pre);
+    bucket *const prev_bucket = m_top.get(prefix(key_bucket->m_prev_pred));
     bucket *const next_bucket = key_bucket->m_next_b;
 
     // if the last key of a bucket was deleted
@@ -131,17 +138,13 @@ class DynIndex {
       if (key_bucket != m_first_b && next_bucket != nullptr) {
         prev_bucket->m_next_b = next_bucket;
         next_bucket->m_prev_pred = key_bucket->m_prev_pred;
-        for (uint64_t i = key_pre; i < next_bucket->m_prefix; ++i) {
-          m_top[i] = prev_bucket;
-        }
+        m_top.remove_bucket(key_bucket, prev_bucket, next_bucket->m_prefix);
       } else if (m_first_b == key_bucket) {
         // if there are buckets left
         if (next_bucket != nullptr) {
           m_first_b = next_bucket;
           m_first_b->m_prev_pred = 0;
-          for (uint64_t i = key_pre; i < m_first_b->m_prefix; ++i) {
-            m_top[i] = nullptr;
-          }
+          m_top.remove_bucket(key_bucket, nullptr, m_first_b->m_prefix);
           assert(key == m_min);
           m_min = m_first_b->get_min();
           // if it is the last bucket
@@ -149,12 +152,13 @@ class DynIndex {
           m_first_b = nullptr;
           m_min = std::numeric_limits<uint64_t>::max();
           m_max = std::numeric_limits<uint64_t>::min();
-          std::vector<bucket *>().swap(m_top);
+          m_top.clear();
         }
-      } else if (key_bucket == m_top.back()) {
-        m_top.resize(prev_bucket->m_prefix + 1);
-        m_top.shrink_to_fit();
-        m_top.back()->m_next_b = nullptr;
+      } else {
+        // the last bucket was emptied, which must not be the first one
+        m_top.truncate(prev_bucket->m_prefix + 1);
+        m_top.remove_bucket(key_bucket, prev_bucket, key_pre);
+        prev_bucket->m_next_b = nullptr;
         //TODO: look at this again
         //this assertion did not break the result in one case
         //assert(key == m_max);
@@ -162,6 +166,152 @@ class DynIndex {
       }
       // delete the empty bucket
       delete key_bucket;
+    } else {
+      // the bucket still contains keys, but the minimum or maximum may have been removed
+      if (key == m_min) {
+        m_min = key_bucket->get_min();
+      }
+      if (key == m_max) {
+        m_max = key_bucket->predecessor(key);
+      }
+    }
+  }
+
+  /// \brief Inserts a batch of keys, which must not be contained yet.
+  ///
+  /// The batch is sorted and grouped by prefix, so that the top structure is consulted and updated only once per affected bucket.
+  /// Groups are processed in descending order, so the top directory is extended at most once and every top entry is rewritten at most once when new buckets are created.
+  ///
+  /// \param keys the keys to insert
+  /// \param num the number of keys
+  void insert_batch(const key_t *keys, const size_t num) {
+    std::vector<uint64_t> batch(num);
+    for (size_t i = 0; i < num; ++i) {
+      batch[i] = static_cast<uint64_t>(keys[i]);
+    }
+    std::sort(batch.begin(), batch.end());
+
+    size_t end = num;
+    while (end > 0) {
+      // find the group of keys sharing the prefix of the largest remaining key
+      const uint64_t key_pre = prefix(batch[end - 1]);
+      size_t begin = end - 1;
+      while (begin > 0 && prefix(batch[begin - 1]) == key_pre) {
+        --begin;
+      }
+
+      // the largest key of the group creates the bucket if needed, the others are added to it directly
+      insert(batch[end - 1]);
+      bucket *key_bucket = m_top.get(key_pre);
+      assert(key_bucket->m_prefix == key_pre);
+      for (size_t i = begin; i + 1 < end; ++i) {
+        assert(!predecessor(batch[i]).exists || predecessor(batch[i]).key != batch[i]);
+        key_bucket->set(suffix(batch[i]));
+      }
+      m_size += end - 1 - begin;
+      m_min = std::min(batch[begin], m_min);
+      end = begin;
+    }
+  }
+
+  /// \brief Constructs the data structure from the given keys, it must be empty before.
+  ///
+  /// The buckets are created in ascending order, one per distinct prefix, and each is appended to the top directory,
+  /// so every top entry is written only once.
+  ///
+  /// \param keys the keys, which must be unique and in ascending order
+  /// \param num the number of keys
+  void bulk_load(const key_t *keys, const size_t num) requires(!has_values) {
+    assert(m_size == 0);
+    assert_sorted_ascending(keys, num);
+
+    bucket *last = nullptr;
+    size_t i = 0;
+    while (i < num) {
+      const uint64_t key = static_cast<uint64_t>(keys[i]);
+      const uint64_t key_pre = prefix(key);
+      bucket *b = new bucket(key_pre, last != nullptr ? m_max : 0, nullptr, suffix(key));
+      for (++i; i < num && prefix(static_cast<uint64_t>(keys[i])) == key_pre; ++i) {
+        b->set(suffix(static_cast<uint64_t>(keys[i])));
+      }
+      m_max = static_cast<uint64_t>(keys[i - 1]);
+
+      if (last != nullptr) {
+        last->m_next_b = b;
+      } else {
+        m_first_b = b;
+        m_min = key;
+      }
+      m_top.extend(key_pre + 1);
+      m_top.add_bucket(b, key_pre + 1);
+      last = b;
+    }
+    m_size = num;
+  }
+
+  /// \brief Writes a snapshot of the data structure, see \ref snapshot.
+  /// \param out the output stream
+  void snapshot(std::ostream &out) const requires(!has_values) {
+    snapshot::write<key_t>(out, *this);
+  }
+
+  /// \brief Restores a snapshot using \ref bulk_load; throws \c std::logic_error unless the data structure is empty.
+  /// \param in the input stream
+  void restore(std::istream &in) requires(!has_values) {
+    if (m_size != 0) {
+      throw std::logic_error("a snapshot can only be restored into an empty dynamic index");
+    }
+    snapshot::read<key_t>(in, [&](const key_t *keys, const size_t num) { bulk_load(keys, num); });
+  }
+
+  /// \brief Restores a snapshot in memory, e.g., a memory mapped file, using \ref bulk_load; throws \c std::logic_error unless the data structure is empty.
+  /// \param data the snapshot data
+  /// \param size the size of the snapshot data in bytes
+  void restore(const void *data, const size_t size) requires(!has_values) {
+    if (m_size != 0) {
+      throw std::logic_error("a snapshot can only be restored into an empty dynamic index");
+    }
+    snapshot::read<key_t>(data, size, [&](const key_t *keys, const size_t num) { bulk_load(keys, num); });
+  }
+
+  /// \brief Removes a batch of keys, which must be contained.
+  ///
+  /// The batch is sorted and grouped by prefix, so that the top structure is consulted only once per affected bucket.
+  /// All keys of a group but the largest are removed from the bucket directly, the largest is removed last and deletes the bucket if it becomes empty.
+  ///
+  /// \param keys the keys to remove
+  /// \param num the number of keys
+  void remove_batch(const key_t *keys, const size_t num) {
+    std::vector<uint64_t> batch(num);
+    for (size_t i = 0; i < num; ++i) {
+      batch[i] = static_cast<uint64_t>(keys[i]);
+    }
+    std::sort(batch.begin(), batch.end());
+
+    size_t begin = 0;
+    while (begin < num) {
+      // find the group of keys sharing the prefix of the smallest remaining key
+      const uint64_t key_pre = prefix(batch[begin]);
+      size_t end = begin + 1;
+      while (end < num && prefix(batch[end]) == key_pre) {
+        ++end;
+      }
+
+      if (end - begin > 1) {
+        // the largest key of the group remains in the bucket, so it cannot become empty and the maximum is not affected
+        bucket *key_bucket = m_top.get(key_pre);
+        assert(key_bucket->m_prefix == key_pre);
+        for (size_t i = begin; i + 1 < end; ++i) {
+          assert(predecessor(batch[i]).key == batch[i]);
+          key_bucket->remove(suffix(batch[i]));
+        }
+        m_size -= end - 1 - begin;
+        if (batch[begin] == m_min) {
+          m_min = key_bucket->get_min();
+        }
+      }
+      remove(batch[end - 1]);
+      begin = end;
     }
   }
 
@@ -176,7 +326,126 @@ class DynIndex {
       return {false, 0};
     if (tdc_unlikely(x >= m_max))
       return {true, m_max};
-    return {true, m_top[prefix(x)]->predecessor(x)};
+    return {true, m_top.get(prefix(x))->predecessor(x)};
+  }
+
+  /// \brief Finds the predecessor of the specified key along with its associated value.
+  ///
+  /// If the predecessor is not contained in the bucket responsible for the key, it is the maximum of the previous bucket.
+  ///
+  /// \param x the key in question
+  auto predecessor_entry(const uint64_t x) const requires has_values {
+    using result_t = KeyValueResult<uint64_t, typename bucket::value_t>;
+    if (tdc_unlikely(m_size == 0 || x < m_min))
+      return result_t{false, 0, {}};
+
+    const uint64_t y = std::min(x, m_max);
+    const bucket *b = m_top.get(prefix(y));
+    result_t r = b->predecessor_entry(y);
+    if (!r.exists) {
+      r = m_top.get(prefix(b->m_prev_pred))->predecessor_entry(b->m_prev_pred);
+    }
+    return r;
+  }
+
+  /// \brief Finds the successor of the specified key along with its associated value.
+  /// \param x the key in question
+  auto successor_entry(const uint64_t x) const requires has_values {
+    using result_t = KeyValueResult<uint64_t, typename bucket::value_t>;
+    if (tdc_unlikely(m_size == 0 || x > m_max))
+      return result_t{false, 0, {}};
+
+    const uint64_t y = std::max(x, m_min);
+    const bucket *b = m_top.get(prefix(y));
+    result_t r = b->successor_entry(y);
+    if (!r.exists) {
+      assert(b->m_next_b != nullptr);
+      r = b->m_next_b->successor_entry(y);
+    }
+    return r;
+  }
+
+  /// \brief Finds the value associated with the specified key.
+  /// \param x the key in question
+  /// \return a pointer to the value, or \c nullptr if the key is not contained
+  auto find(const uint64_t x) requires has_values {
+    typename bucket::value_t *value = nullptr;
+    if (m_size > 0 && x >= m_min && x <= m_max) {
+      bucket *b = m_top.get(prefix(x));
+      if (b->m_prefix == prefix(x)) {
+        value = b->find(suffix(x));
+      }
+    }
+    return value;
+  }
+
+  /// \brief Finds the successor of the specified key.
+  /// \param x the key in question
+  KeyResult<uint64_t> successor(const uint64_t x) const {
+    if (tdc_unlikely(m_size == 0 || x > m_max))
+      return {false, 0};
+    if (tdc_unlikely(x <= m_min))
+      return {true, m_min};
+
+    // the successor is either in the bucket that contains the predecessor, or it is the minimum of the next bucket
+    const bucket *b = m_top.get(prefix(x));
+    auto r = b->successor(x);
+    if (!r.exists) {
+      assert(b->m_next_b != nullptr);
+      r = {true, b->m_next_b->get_min()};
+    }
+    return r;
+  }
+
+  using iterator = SuccessorIterator<DynIndex>;
+
+  /// \brief Returns an iterator pointing to the smallest key greater than or equal to the specified key.
+  /// \param x the key in question
+  iterator lower_bound(const uint64_t x) const {
+    return iterator(*this, x);
+  }
+
+  /// \brief Returns an iterator pointing to the smallest key.
+  iterator begin() const {
+    return lower_bound(0);
+  }
+
+  /// \brief Returns an iterator pointing to the end.
+  iterator end() const {
+    return iterator();
+  }
+
+  /// \brief Counts the keys contained in the specified range.
+  ///
+  /// The buckets overlapping the range are scanned in ascending order, buckets that lie entirely within the range are counted in constant time.
+  ///
+  /// \param a the lower bound of the range, inclusive
+  /// \param b the upper bound of the range, inclusive
+  size_t count_range(uint64_t a, uint64_t b) const {
+    a = std::max(a, m_min);
+    b = std::min(b, m_max);
+    if (m_size == 0 || a > b) {
+      return 0;
+    }
+
+    const uint64_t a_pre = prefix(a);
+    const uint64_t b_pre = prefix(b);
+
+    // find the first bucket overlapping the range
+    bucket *cur = m_top.get(a_pre);
+    if (cur->m_prefix < a_pre) {
+      cur = cur->m_next_b;
+    }
+
+    size_t count = 0;
+    for (; cur != nullptr && cur->m_prefix <= b_pre; cur = cur->m_next_b) {
+      if (cur->m_prefix != a_pre && cur->m_prefix != b_pre) {
+        count += cur->size();
+      } else {
+        count += cur->count_range(cur->m_prefix == a_pre ? suffix(a) : 0, cur->m_prefix == b_pre ? suffix(b) : b_max);
+      }
+    }
+    return count;
   }
 };
 }  // namespace dynamic
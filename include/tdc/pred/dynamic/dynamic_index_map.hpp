@@ -3,6 +3,7 @@
 #include <cassert>
 #include <cstdint>
 #include <tdc/pred/dynamic/buckets/buckets.hpp>
+#include <tdc/pred/dynamic/successor_iterator.hpp>
 #include <tdc/pred/result.hpp>
 #include <tdc/util/concepts.hpp>
 #include <tdc/util/likely.hpp>
@@ -95,8 +96,8 @@ class DynIndexMap {
     --m_size;
 
     if (b.size() == 0) {
+      // the minimum or maximum may still need to be updated below
       m_map.erase(key_pre);
-      return;
     }
 
     if (m_size == 0) {
@@ -145,6 +146,78 @@ class DynIndexMap {
     assert(r.exists);
     return {true, (key_pre << b_wordl) + r.key};
   }
+
+  KeyResult<uint64_t> successor(uint64_t key) const {
+    if (tdc_unlikely(m_size == 0 || key > m_max)) {
+      return {false, 0};
+    }
+    if (tdc_unlikely(key <= m_min)) {
+      return {true, m_min};
+    }
+    uint64_t key_pre = prefix(key);
+    auto p = m_map.find(key_pre);
+    if (p != m_map.end()) {
+      auto r = p->second.successor(suffix(key));
+      if (r.exists) {
+        return {true, (key_pre << b_wordl) + r.key};
+      }
+    }
+    do {
+      ++key_pre;
+      p = m_map.find(key_pre);
+    } while (p == m_map.end());
+    return {true, (key_pre << b_wordl) + p->second.get_min()};
+  }
+
+  using iterator = SuccessorIterator<DynIndexMap>;
+
+  // Returns an iterator pointing to the smallest key greater than or equal to x.
+  iterator lower_bound(uint64_t x) const {
+    return iterator(*this, x);
+  }
+
+  // Returns an iterator pointing to the smallest key.
+  iterator begin() const {
+    return lower_bound(0);
+  }
+
+  // Returns an iterator pointing to the end.
+  iterator end() const {
+    return iterator();
+  }
+
+  // Returns the number of keys in the range [a, b].
+  // Depending on which is fewer, we either look up every prefix in the range or scan all buckets.
+  size_t count_range(uint64_t a, uint64_t b) const {
+    a = std::max(a, m_min);
+    b = std::min(b, m_max);
+    if (m_size == 0 || a > b) {
+      return 0;
+    }
+
+    const uint64_t a_pre = prefix(a);
+    const uint64_t b_pre = prefix(b);
+    auto count_bucket = [&](const uint64_t pre, const bucket& bkt) -> size_t {
+      return bkt.count_range(pre == a_pre ? suffix(a) : 0, pre == b_pre ? suffix(b) : b_max);
+    };
+
+    size_t count = 0;
+    if (b_pre - a_pre < m_map.size()) {
+      for (uint64_t pre = a_pre; pre <= b_pre; ++pre) {
+        auto p = m_map.find(pre);
+        if (p != m_map.end()) {
+          count += count_bucket(pre, p->second);
+        }
+      }
+    } else {
+      for (const auto& e : m_map) {
+        if (e.first >= a_pre && e.first <= b_pre) {
+          count += count_bucket(e.first, e.second);
+        }
+      }
+    }
+    return count;
+  }
 };
 }  // namespace dynamic
 }  // namespace pred
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <robin_hood.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <tdc/pred/dynamic/btree.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+// Top directories for DynIndex.
+// The directory maps every prefix p in [0, size()) to the bucket with the largest prefix less than or equal to p, or nullptr if there is none.
+// The valid prefixes end at the prefix of the last bucket. A directory supports the following operations:
+//  - get(p): the bucket for prefix p, which must be valid
+//  - size(): the number of valid prefixes
+//  - extend(n): makes the prefixes up to n-1 valid, the new prefixes map to the bucket of the previously largest valid prefix
+//  - truncate(n): makes the prefixes from n on invalid
+//  - add_bucket(b, end): b is a new bucket, the prefixes in [b->m_prefix, end) now map to it
+//  - remove_bucket(b, pred, end): b is being removed, the prefixes in [b->m_prefix, end) now map to its predecessor bucket pred
+//  - clear(): removes all buckets
+
+/// \brief Top directory that stores the bucket for every valid prefix in an array.
+///
+/// Lookups are a single array access, but the array spans all prefixes up to the largest key,
+/// and creating or removing a bucket rewrites the entries of all prefixes up to the next bucket.
+template <typename bucket>
+class dense_top {
+ private:
+  std::vector<bucket *> m_top;
+
+ public:
+  inline bucket *get(const uint64_t p) const {
+    return m_top[p];
+  }
+
+  inline uint64_t size() const {
+    return m_top.size();
+  }
+
+  void extend(const uint64_t n) {
+    m_top.resize(n, m_top.empty() ? nullptr : m_top.back());
+  }
+
+  void truncate(const uint64_t n) {
+    m_top.resize(n);
+    m_top.shrink_to_fit();
+  }
+
+  void add_bucket(bucket *b, const uint64_t end) {
+    for (uint64_t i = b->m_prefix; i < end; ++i) {
+      m_top[i] = b;
+    }
+  }
+
+  void remove_bucket(bucket *b, bucket *pred, const uint64_t end) {
+    for (uint64_t i = b->m_prefix; i < end; ++i) {
+      m_top[i] = pred;
+    }
+  }
+
+  void clear() {
+    std::vector<bucket *>().swap(m_top);
+  }
+};
+
+/// \brief Top directory that only allocates pages for populated prefix ranges.
+///
+/// The prefixes are divided into pages of 2^page_bits consecutive prefixes, and a page is allocated only if it contains the prefix of a bucket.
+/// Allocated pages are found via a hash table, so lookups of prefixes in allocated pages take constant time.
+/// The prefixes of a page that is not allocated all map to the same bucket as the last prefix of the preceding allocated page,
+/// which is found using a B-Tree over the indices of the allocated pages.
+/// Creating or removing a bucket only rewrites entries in the pages of the bucket and of the next bucket.
+///
+/// This makes the space proportional to the number of buckets rather than the largest key, which is required for large universes.
+///
+/// \tparam bucket the bucket type
+/// \tparam t_page_bits the base-2 logarithm of the number of prefixes per page
+template <typename bucket, uint8_t t_page_bits = 8>
+class paged_top {
+ private:
+  static_assert(t_page_bits > 0 && t_page_bits < 32);
+
+  static constexpr uint64_t c_page_size = 1ULL << t_page_bits;
+  static constexpr uint64_t c_page_mask = c_page_size - 1;
+
+  struct page {
+    bucket *m_entries[c_page_size];
+    size_t m_num_buckets = 0;  // the number of buckets whose prefix lies in this page
+  };
+
+  uint64_t m_size = 0;
+  robin_hood::unordered_map<uint64_t, page *> m_pages;
+  BTree<uint64_t, 65, SortedArrayNode<uint64_t, 64>> m_page_index;  // the indices of the allocated pages
+
+  inline page *find_page(const uint64_t i) const {
+    auto it = m_pages.find(i);
+    return it != m_pages.end() ? it->second : nullptr;
+  }
+
+  // the bucket for all prefixes in the page with index i, which must not be allocated
+  bucket *get_absent(const uint64_t i) const {
+    if (m_page_index.size() == 0) {
+      return nullptr;
+    }
+    const auto r = m_page_index.predecessor(i);
+    return r.exists ? find_page(r.key)->m_entries[c_page_mask] : nullptr;
+  }
+
+  // sets the entries of the prefixes in [a, b) within allocated pages
+  void assign(const uint64_t a, const uint64_t b, bucket *value) {
+    if (a >= b) {
+      return;
+    }
+    // the pages strictly in between contain no bucket and are therefore not allocated
+    const uint64_t pa = a >> t_page_bits;
+    const uint64_t pb = (b - 1) >> t_page_bits;
+    if (page *pg = find_page(pa)) {
+      const uint64_t last = (pa == pb) ? ((b - 1) & c_page_mask) : c_page_mask;
+      for (uint64_t j = a & c_page_mask; j <= last; ++j) {
+        pg->m_entries[j] = value;
+      }
+    }
+    if (pb != pa) {
+      if (page *pg = find_page(pb)) {
+        for (uint64_t j = 0; j <= ((b - 1) & c_page_mask); ++j) {
+          pg->m_entries[j] = value;
+        }
+      }
+    }
+  }
+
+ public:
+  paged_top() = default;
+
+  ~paged_top() {
+    clear();
+  }
+
+  paged_top(const paged_top &) = delete;
+  paged_top &operator=(const paged_top &) = delete;
+
+  inline bucket *get(const uint64_t p) const {
+    assert(p < m_size);
+    if (page *pg = find_page(p >> t_page_bits)) {
+      return pg->m_entries[p & c_page_mask];
+    }
+    return get_absent(p >> t_page_bits);
+  }
+
+  inline uint64_t size() const {
+    return m_size;
+  }
+
+  void extend(const uint64_t n) {
+    if (n > m_size) {
+      // entries of an allocated page beyond the valid prefixes may be stale
+      if (m_size > 0) {
+        assign(m_size, std::min(n, ((m_size >> t_page_bits) + 1) << t_page_bits), get(m_size - 1));
+      }
+      m_size = n;
+    }
+  }
+
+  void truncate(const uint64_t n) {
+    m_size = std::min(m_size, n);
+  }
+
+  void add_bucket(bucket *b, const uint64_t end) {
+    const uint64_t i = b->m_prefix >> t_page_bits;
+    page *pg = find_page(i);
+    if (pg == nullptr) {
+      // allocate the page, the entries before the new bucket map to the bucket preceding the page
+      bucket *pred = get_absent(i);
+      pg = new page();
+      for (uint64_t j = 0; j < (b->m_prefix & c_page_mask); ++j) {
+        pg->m_entries[j] = pred;
+      }
+      for (uint64_t j = b->m_prefix & c_page_mask; j < c_page_size; ++j) {
+        pg->m_entries[j] = b;
+      }
+      m_pages.emplace(i, pg);
+      m_page_index.insert(i);
+    }
+    ++pg->m_num_buckets;
+    assign(b->m_prefix, end, b);
+  }
+
+  void remove_bucket(bucket *b, bucket *pred, const uint64_t end) {
+    const uint64_t i = b->m_prefix >> t_page_bits;
+    page *pg = find_page(i);
+    assert(pg != nullptr && pg->m_num_buckets > 0);
+    assign(b->m_prefix, end, pred);
+    if (--pg->m_num_buckets == 0) {
+      m_pages.erase(i);
+      m_page_index.remove(i);
+      delete pg;
+    }
+  }
+
+  void clear() {
+    for (auto &e : m_pages) {
+      delete e.second;
+    }
+    m_pages.clear();
+    while (m_page_index.size() > 0) {
+      m_page_index.remove(m_page_index.min());
+    }
+    m_size = 0;
+  }
+};
+
+}  // namespace dynamic
+}  // namespace pred
+}  // namespace tdc
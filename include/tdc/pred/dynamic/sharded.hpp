@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+#include <tdc/pred/result.hpp>
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+/// \brief A thread-safe dynamic predecessor data structure that partitions the universe into shards, each guarded by its own lock.
+///
+/// The shard of a key is determined by its most significant bits, and every shard is an independent instance of the underlying data structure.
+/// Updates only lock the shard of the key, so updates and queries in different shards proceed in parallel.
+///
+/// A summary bit vector marks the shards that are not empty.
+/// If the shard of a key contains no predecessor, the query continues with the maximum of the previous non-empty shard, which is found using the summary.
+/// Queries are linearizable with respect to updates in the same shard, but a query that falls through to a previous shard
+/// may not observe concurrent updates in the shards in between.
+///
+/// \tparam key_t the key type
+/// \tparam ds_t the underlying data structure, must be default constructible and support insert, remove, predecessor and size;
+///              keys are passed to it as \c uint64_t
+/// \tparam t_shard_bits the base-2 logarithm of the number of shards
+/// \tparam mutex_t the lock type; with a \c std::shared_mutex, queries only acquire shared locks
+template<std::totally_ordered key_t, typename ds_t, uint8_t t_shard_bits, typename mutex_t = std::shared_mutex>
+class Sharded {
+private:
+    static constexpr size_t m_key_bits = std::numeric_limits<key_t>::digits;
+    static_assert(m_key_bits <= 64);
+    static_assert(t_shard_bits > 0 && t_shard_bits <= 16 && t_shard_bits < m_key_bits);
+
+    static constexpr size_t m_num_shards = 1ULL << t_shard_bits;
+    static constexpr size_t m_shift = m_key_bits - t_shard_bits;
+    static constexpr size_t m_summary_words = (m_num_shards + 63) / 64;
+
+    // shards are aligned to cache lines so that locking one shard does not invalidate the lock of its neighbour
+    struct alignas(64) Shard {
+        mutable mutex_t m_mutex;
+        ds_t m_ds;
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    std::atomic<uint64_t> m_summary[m_summary_words];
+
+    static size_t shard_of(const key_t x) {
+        return (uint64_t)x >> m_shift;
+    }
+
+    // the largest key that belongs to the given shard
+    static uint64_t shard_max(const size_t s) {
+        return ((uint64_t(s) + 1) << m_shift) - 1;
+    }
+
+    template<typename func_t>
+    static auto read_locked(const Shard& shard, func_t func) {
+        if constexpr(std::is_same<mutex_t, std::shared_mutex>::value) {
+            std::shared_lock lock(shard.m_mutex);
+            return func(shard.m_ds);
+        } else {
+            std::lock_guard lock(shard.m_mutex);
+            return func(shard.m_ds);
+        }
+    }
+
+    void set_summary(const size_t s, const bool nonempty) {
+        const uint64_t bit = 1ULL << (s % 64);
+        if(nonempty) {
+            m_summary[s / 64].fetch_or(bit, std::memory_order_release);
+        } else {
+            m_summary[s / 64].fetch_and(~bit, std::memory_order_release);
+        }
+    }
+
+    // finds the largest shard less than s that is marked non-empty in the summary, or m_num_shards if there is none
+    size_t prev_nonempty(size_t s) const {
+        while(s > 0) {
+            --s;
+            const size_t w = s / 64;
+            const size_t b = s % 64;
+            const uint64_t mask = (b == 63) ? UINT64_MAX : ((1ULL << (b + 1)) - 1);
+            const uint64_t bits = m_summary[w].load(std::memory_order_acquire) & mask;
+            if(bits) {
+                return w * 64 + 63 - __builtin_clzll(bits);
+            }
+            s = w * 64;
+        }
+        return m_num_shards;
+    }
+
+public:
+    /// \brief The number of shards.
+    static constexpr size_t num_shards = m_num_shards;
+
+    /// \brief Constructs an empty data structure.
+    Sharded() : m_shards(new Shard[m_num_shards]) {
+        for(auto& w : m_summary) w.store(0, std::memory_order_relaxed);
+    }
+
+    Sharded(const Sharded&) = delete;
+    Sharded& operator=(const Sharded&) = delete;
+
+    /// \brief Inserts the specified key.
+    /// \param x the key to insert
+    void insert(const key_t x) {
+        const size_t s = shard_of(x);
+        Shard& shard = m_shards[s];
+        std::lock_guard lock(shard.m_mutex);
+        const bool was_empty = (shard.m_ds.size() == 0);
+        shard.m_ds.insert((uint64_t)x);
+        if(was_empty) set_summary(s, true);
+    }
+
+    /// \brief Removes the specified key.
+    ///
+    /// If the underlying data structure does not report whether a key was removed, the key must be contained.
+    ///
+    /// \param x the key to remove
+    /// \return whether the key was found and removed
+    bool remove(const key_t x) {
+        const size_t s = shard_of(x);
+        Shard& shard = m_shards[s];
+        std::lock_guard lock(shard.m_mutex);
+        bool removed = true;
+        if constexpr(std::is_same<decltype(shard.m_ds.remove((uint64_t)x)), bool>::value) {
+            removed = shard.m_ds.remove((uint64_t)x);
+        } else {
+            shard.m_ds.remove((uint64_t)x);
+        }
+        if(removed && shard.m_ds.size() == 0) set_summary(s, false);
+        return removed;
+    }
+
+    /// \brief Finds the predecessor of the specified key.
+    /// \param x the key in question
+    KeyResult<key_t> predecessor(const key_t x) const {
+        size_t s = shard_of(x);
+        {
+            const uint64_t k = (uint64_t)x;
+            const auto r = read_locked(m_shards[s], [&](const ds_t& ds){
+                return ds.size() > 0 ? ds.predecessor(k) : decltype(ds.predecessor(k)){ false, 0 };
+            });
+            if(r.exists) return { true, key_t(r.key) };
+        }
+
+        // the predecessor is the maximum of the previous non-empty shard
+        while((s = prev_nonempty(s)) < m_num_shards) {
+            const uint64_t max = shard_max(s);
+            const auto r = read_locked(m_shards[s], [&](const ds_t& ds){
+                return ds.size() > 0 ? ds.predecessor(max) : decltype(ds.predecessor(max)){ false, 0 };
+            });
+            // the shard may have become empty since the summary was read
+            if(r.exists) return { true, key_t(r.key) };
+        }
+        return { false, 0 };
+    }
+
+    /// \brief Counts the keys contained in the specified range, if the underlying data structure supports it.
+    ///
+    /// The shards overlapping the range are locked one after another.
+    ///
+    /// \param a the lower bound of the range, inclusive
+    /// \param b the upper bound of the range, inclusive
+    size_t count_range(const key_t a, const key_t b) const requires requires(const ds_t& ds, const uint64_t x) { ds.count_range(x, x); } {
+        size_t count = 0;
+        if(a <= b) {
+            const size_t sa = shard_of(a);
+            const size_t sb = shard_of(b);
+            for(size_t s = sa; s <= sb; s++) {
+                const uint64_t lo = (s == sa) ? (uint64_t)a : uint64_t(s) << m_shift;
+                const uint64_t hi = (s == sb) ? (uint64_t)b : shard_max(s);
+                count += read_locked(m_shards[s], [&](const ds_t& ds){
+                    return ds.size() > 0 ? size_t(ds.count_range(lo, hi)) : size_t(0);
+                });
+            }
+        }
+        return count;
+    }
+
+    /// \brief Reports the number of contained keys.
+    ///
+    /// The shards are locked one after another, so the result may not reflect concurrent updates.
+    size_t size() const {
+        size_t sum = 0;
+        for(size_t s = 0; s < m_num_shards; s++) {
+            sum += read_locked(m_shards[s], [](const ds_t& ds){ return size_t(ds.size()); });
+        }
+        return sum;
+    }
+};
+
+}}} // namespace tdc::pred::dynamic
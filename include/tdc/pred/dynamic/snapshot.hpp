@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+/// \brief Snapshots of dynamic predecessor data structures.
+///
+/// A snapshot consists of a fixed-size header followed by the contained keys in ascending order, each stored in the native representation of the key type.
+/// This allows restoring a snapshot directly from a memory mapped file without copying the keys.
+/// Data structures are restored bottom-up from the sorted keys using their bulk construction, rather than by inserting the keys one by one.
+namespace snapshot {
+
+/// \brief The current version of the snapshot format.
+static constexpr uint16_t VERSION = 1;
+
+/// \brief The header of a snapshot.
+struct Header {
+    char     magic[4];  ///< always \c TDCP
+    uint16_t version;   ///< the format version
+    uint16_t key_bytes; ///< the number of bytes per key
+    uint64_t num;       ///< the number of keys
+} __attribute__((__packed__));
+
+static_assert(sizeof(Header) == 16);
+
+/// \cond INTERNAL
+inline void check_header(const Header& header, const size_t key_bytes) {
+    if(std::memcmp(header.magic, "TDCP", 4) != 0) {
+        throw std::runtime_error("not a predecessor snapshot");
+    }
+    if(header.version != VERSION) {
+        throw std::runtime_error("unsupported predecessor snapshot version");
+    }
+    if(header.key_bytes != key_bytes) {
+        throw std::runtime_error("predecessor snapshot key size mismatch");
+    }
+}
+
+// makes sure the keys are strictly ascending, continuing from the given previous key if there is one, since the bulk constructions rely on it
+template<typename key_t>
+void check_ascending(const key_t* keys, const size_t num, const key_t* prev) {
+    for(size_t i = 0; i < num; i++) {
+        if(prev && !(*prev < keys[i])) {
+            throw std::runtime_error("unsorted predecessor snapshot");
+        }
+        prev = keys + i;
+    }
+}
+/// \endcond
+
+/// \brief Writes the header of a snapshot, which must be followed by the given number of keys in ascending order.
+/// \tparam key_t the key type
+/// \param out the output stream
+/// \param num the number of keys
+template<typename key_t>
+void write_header(std::ostream& out, const size_t num) {
+    Header header;
+    std::memcpy(header.magic, "TDCP", 4);
+    header.version = VERSION;
+    header.key_bytes = sizeof(key_t);
+    header.num = num;
+    out.write((const char*)&header, sizeof(Header));
+}
+
+/// \brief Writes a snapshot of the given data structure.
+///
+/// The keys are obtained by iterating over the data structure and written in blocks.
+///
+/// \tparam key_t the key type
+/// \tparam ds_t the data structure type, must support \c size, \c begin and \c end
+/// \param out the output stream
+/// \param ds the data structure
+template<typename key_t, typename ds_t>
+void write(std::ostream& out, const ds_t& ds) {
+    write_header<key_t>(out, ds.size());
+
+    static constexpr size_t BLOCK_SIZE = 4096;
+    std::vector<key_t> block;
+    block.reserve(BLOCK_SIZE);
+    for(auto it = ds.begin(); it != ds.end(); ++it) {
+        block.push_back(key_t(*it));
+        if(block.size() == BLOCK_SIZE) {
+            out.write((const char*)block.data(), BLOCK_SIZE * sizeof(key_t));
+            block.clear();
+        }
+    }
+    out.write((const char*)block.data(), block.size() * sizeof(key_t));
+}
+
+/// \brief Reads a snapshot from a stream and passes the keys to the given function.
+///
+/// Throws \c std::runtime_error if the snapshot is invalid, truncated or its keys are not strictly ascending.
+///
+/// \tparam key_t the key type
+/// \tparam func_t the function type, called with a pointer to the keys in ascending order and their number
+/// \param in the input stream
+/// \param func the function
+template<typename key_t, typename func_t>
+void read(std::istream& in, func_t func) {
+    Header header;
+    if(!in.read((char*)&header, sizeof(Header))) {
+        throw std::runtime_error("truncated predecessor snapshot");
+    }
+    check_header(header, sizeof(key_t));
+
+    // the header is untrusted, so the keys are read in blocks rather than allocating space for the claimed number up front
+    static constexpr size_t BLOCK_SIZE = 1ULL << 16;
+    std::vector<key_t> keys;
+    while(keys.size() < header.num) {
+        const size_t offset = keys.size();
+        const size_t num = (size_t)std::min(uint64_t(BLOCK_SIZE), header.num - offset);
+        keys.resize(offset + num);
+        if(!in.read((char*)(keys.data() + offset), num * sizeof(key_t))) {
+            throw std::runtime_error("truncated predecessor snapshot");
+        }
+        check_ascending(keys.data() + offset, num, offset > 0 ? keys.data() + offset - 1 : nullptr);
+    }
+    func(keys.data(), keys.size());
+}
+
+/// \brief Reads a snapshot from memory, e.g., a memory mapped file, and passes the keys to the given function.
+///
+/// The keys are not copied.
+/// Throws \c std::runtime_error if the snapshot is invalid, truncated or its keys are not strictly ascending.
+///
+/// \tparam key_t the key type
+/// \tparam func_t the function type, called with a pointer to the keys in ascending order and their number
+/// \param data the snapshot data
+/// \param size the size of the snapshot data in bytes
+/// \param func the function
+template<typename key_t, typename func_t>
+void read(const void* data, const size_t size, func_t func) {
+    if(size < sizeof(Header)) {
+        throw std::runtime_error("truncated predecessor snapshot");
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    check_header(header, sizeof(key_t));
+
+    if(header.num > (size - sizeof(Header)) / sizeof(key_t)) {
+        throw std::runtime_error("truncated predecessor snapshot");
+    }
+    const key_t* keys = (const key_t*)((const char*)data + sizeof(Header));
+    check_ascending(keys, (size_t)header.num, (const key_t*)nullptr);
+    func(keys, (size_t)header.num);
+}
+
+}}}} // namespace tdc::pred::dynamic::snapshot
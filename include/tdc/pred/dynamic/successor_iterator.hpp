@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+#include <tdc/pred/result.hpp>
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+/// \brief Forward iterator over the keys of a dynamic predecessor data structure, in ascending order.
+///
+/// The iterator is advanced by successor queries, so it can be used with any data structure that supports them.
+/// It is invalidated by any modification of the data structure.
+///
+/// \tparam ds_t the data structure type, must support a \c successor function
+/// \tparam key_t the key type
+template<typename ds_t, typename key_t = uint64_t>
+class SuccessorIterator {
+private:
+    const ds_t* m_ds;
+    KeyResult<key_t> m_cur;
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = key_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const key_t*;
+    using reference = key_t;
+
+    /// \brief Constructs an iterator pointing to the end.
+    SuccessorIterator() : m_ds(nullptr), m_cur { false, 0 } {
+    }
+
+    /// \brief Constructs an iterator pointing to the smallest key greater than or equal to the specified key.
+    /// \param ds the data structure
+    /// \param x the key in question
+    SuccessorIterator(const ds_t& ds, const key_t x) : m_ds(&ds), m_cur(ds.successor(x)) {
+    }
+
+    /// \brief Returns the current key.
+    key_t operator*() const {
+        assert(m_cur.exists);
+        return m_cur.key;
+    }
+
+    /// \brief Advances to the next larger key.
+    SuccessorIterator& operator++() {
+        assert(m_cur.exists);
+        if(m_cur.key == std::numeric_limits<key_t>::max()) {
+            m_cur = { false, 0 };
+        } else {
+            m_cur = m_ds->successor(m_cur.key + 1);
+        }
+        return *this;
+    }
+
+    /// \brief Advances to the next larger key.
+    SuccessorIterator operator++(int) {
+        SuccessorIterator it = *this;
+        ++(*this);
+        return it;
+    }
+
+    bool operator==(const SuccessorIterator& other) const {
+        return m_cur.exists == other.m_cur.exists && (!m_cur.exists || m_cur.key == other.m_cur.key);
+    }
+
+    bool operator!=(const SuccessorIterator& other) const {
+        return !(*this == other);
+    }
+};
+
+}}} // namespace tdc::pred::dynamic
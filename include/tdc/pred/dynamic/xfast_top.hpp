@@ -0,0 +1,242 @@
+#pragma once
+#include <robin_hood.h>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace tdc {
+namespace pred {
+namespace dynamic {
+
+// Representations of the top part of a yfast_trie, the xfast_trie.
+// The xfast_trie has t_key_width + 1 levels. Level l contains the nodes for the prefixes of length t_key_width-l of the representants,
+// and each node maps to a bucket pointer (see YFastTrie). A representation supports the following operations:
+//  - contains(l, p): whether the node for prefix p exists on level l
+//  - at(l, p): the bucket the existing node for prefix p on level l maps to
+//  - set(l, p, b): creates the node for prefix p on level l if necessary and maps it to bucket b
+//  - erase(l, p): removes the node for prefix p on level l
+//  - level_size(l): the number of nodes on level l
+//  - prefetch(l, p): hints that the node for prefix p on level l is going to be looked up soon
+//  - release(b): bucket b is about to be deleted and no node maps to it anymore
+
+// The classical representation, which uses one hash map per level.
+template <class t_bucket, uint8_t t_key_width>
+class xfast_map_levels {
+ private:
+  std::array<robin_hood::unordered_map<uint64_t, t_bucket*>, t_key_width + 1> m_levels;
+
+ public:
+  bool contains(const size_t level, const uint64_t prefix) const {
+    return m_levels[level].find(prefix) != m_levels[level].end();
+  }
+
+  t_bucket* at(const size_t level, const uint64_t prefix) const {
+    return m_levels[level].at(prefix);
+  }
+
+  void set(const size_t level, const uint64_t prefix, t_bucket* const b) {
+    m_levels[level][prefix] = b;
+  }
+
+  void erase(const size_t level, const uint64_t prefix) {
+    m_levels[level].erase(prefix);
+  }
+
+  size_t level_size(const size_t level) const {
+    return m_levels[level].size();
+  }
+
+  void prefetch(const size_t, const uint64_t) const {
+  }
+
+  void release(t_bucket* const) {
+  }
+};
+
+// A compact representation that stores the nodes of all levels in a single open-addressing table with linear probing.
+//  - A node is identified by a single word: on level l > 0, the prefix has at most 63 bits, and we store (prefix * 2 + 1) * 2^(l-1),
+//    so the position of the lowest set bit encodes the level. On level 0, we store the representant itself and mark the slot instead.
+//  - Nodes do not store bucket pointers, but 30-bit handles into a table of buckets. A bucket gets a handle when a node first maps to it,
+//    which the bucket remembers (t_bucket must provide get_handle and set_handle), and the handle is recycled when the bucket is released.
+//  - Removals shift the following slots of the probe sequence backwards, so there are no tombstones.
+// Compared to one hash map per level, this saves the per-level allocations and pointer-sized values: a slot takes 12 bytes.
+template <class t_bucket, uint8_t t_key_width>
+class xfast_compact_table {
+ private:
+  static_assert(t_key_width <= 64);
+
+  // The value of a slot: bit 0 says that the slot is occupied, bit 1 that the node is on level 0, and the remaining bits are the bucket handle.
+  static constexpr uint32_t c_occupied = 1;
+  static constexpr uint32_t c_level0 = 2;
+  static constexpr uint32_t c_handle_shift = 2;
+  static constexpr size_t c_max_handles = 1ULL << (32 - c_handle_shift);
+
+  static constexpr size_t c_min_capacity_log = 6;
+
+  struct slot {
+    uint64_t id;
+    uint32_t value;
+  } __attribute__((__packed__));
+
+  std::vector<slot> m_slots;
+  size_t m_capacity_log = 0;
+  size_t m_mask = 0;
+  size_t m_size = 0;
+  std::array<size_t, t_key_width + 1> m_level_size{};
+
+  // Handle 0 is reserved for nullptr.
+  std::vector<t_bucket*> m_buckets{nullptr};
+  std::vector<uint32_t> m_free_handles;
+
+  static uint64_t node_id(const size_t level, const uint64_t prefix) {
+    return (level == 0) ? prefix : ((prefix << 1) | 1) << (level - 1);
+  }
+
+  static uint32_t level_flags(const size_t level) {
+    return (level == 0) ? (c_occupied | c_level0) : c_occupied;
+  }
+
+  size_t home(const uint64_t id, const uint32_t flags) const {
+    // Fibonacci hashing, level 0 nodes are offset so they do not collide with the nodes of other levels that have the same id
+    const uint64_t h = (id + ((flags & c_level0) ? 0x5851F42D4C957F2DULL : 0)) * 0x9E3779B97F4A7C15ULL;
+    return h >> (64 - m_capacity_log);
+  }
+
+  static bool matches(const slot& s, const uint64_t id, const uint32_t flags) {
+    return s.id == id && (s.value & (c_occupied | c_level0)) == flags;
+  }
+
+  // Returns the position of the node, or the position of the empty slot that ends its probe sequence.
+  size_t find_slot(const uint64_t id, const uint32_t flags) const {
+    size_t i = home(id, flags);
+    while ((m_slots[i].value & c_occupied) && !matches(m_slots[i], id, flags)) {
+      i = (i + 1) & m_mask;
+    }
+    return i;
+  }
+
+  void rehash(const size_t capacity_log) {
+    std::vector<slot> old;
+    old.swap(m_slots);
+    m_capacity_log = capacity_log;
+    m_mask = (1ULL << capacity_log) - 1;
+    m_slots.assign(1ULL << capacity_log, slot{0, 0});
+    for (const slot& s : old) {
+      if (s.value & c_occupied) {
+        m_slots[find_slot(s.id, s.value & (c_occupied | c_level0))] = s;
+      }
+    }
+  }
+
+  uint32_t handle(t_bucket* const b) {
+    if (b == nullptr) {
+      return 0;
+    }
+    uint32_t h = b->get_handle();
+    if (h != 0) {
+      return h;
+    }
+    if (m_free_handles.empty()) {
+      if (m_buckets.size() >= c_max_handles) {
+        // the handle would overflow into the level bits of the node IDs
+        throw std::length_error("too many buckets for the compact x-fast table");
+      }
+      h = m_buckets.size();
+      m_buckets.push_back(b);
+    } else {
+      h = m_free_handles.back();
+      m_free_handles.pop_back();
+      m_buckets[h] = b;
+    }
+    b->set_handle(h);
+    return h;
+  }
+
+ public:
+  xfast_compact_table() {
+    rehash(c_min_capacity_log);
+  }
+
+  bool contains(const size_t level, const uint64_t prefix) const {
+    return m_slots[find_slot(node_id(level, prefix), level_flags(level))].value & c_occupied;
+  }
+
+  t_bucket* at(const size_t level, const uint64_t prefix) const {
+    const slot& s = m_slots[find_slot(node_id(level, prefix), level_flags(level))];
+    assert(s.value & c_occupied);
+    return m_buckets[s.value >> c_handle_shift];
+  }
+
+  void set(const size_t level, const uint64_t prefix, t_bucket* const b) {
+    const uint64_t id = node_id(level, prefix);
+    const uint32_t flags = level_flags(level);
+    const uint32_t value = (handle(b) << c_handle_shift) | flags;
+
+    size_t i = find_slot(id, flags);
+    if (m_slots[i].value & c_occupied) {
+      m_slots[i].value = value;
+      return;
+    }
+
+    // keep the load factor below 3/4
+    if (4 * (m_size + 1) > 3 * m_slots.size()) {
+      rehash(m_capacity_log + 1);
+      i = find_slot(id, flags);
+    }
+    m_slots[i] = slot{id, value};
+    ++m_size;
+    ++m_level_size[level];
+  }
+
+  void erase(const size_t level, const uint64_t prefix) {
+    size_t i = find_slot(node_id(level, prefix), level_flags(level));
+    if (!(m_slots[i].value & c_occupied)) {
+      return;
+    }
+    --m_size;
+    --m_level_size[level];
+
+    // Shift back following slots whose home is not in between the hole and their position.
+    size_t j = i;
+    while (true) {
+      m_slots[i].value = 0;
+      while (true) {
+        j = (j + 1) & m_mask;
+        if (!(m_slots[j].value & c_occupied)) {
+          return;
+        }
+        const size_t k = home(m_slots[j].id, m_slots[j].value & (c_occupied | c_level0));
+        if (((j - k) & m_mask) >= ((j - i) & m_mask)) {
+          break;
+        }
+      }
+      m_slots[i] = m_slots[j];
+      i = j;
+    }
+  }
+
+  size_t level_size(const size_t level) const {
+    return m_level_size[level];
+  }
+
+  void prefetch(const size_t level, const uint64_t prefix) const {
+    __builtin_prefetch(&m_slots[home(node_id(level, prefix), level_flags(level))]);
+  }
+
+  void release(t_bucket* const b) {
+    const uint32_t h = b->get_handle();
+    if (h != 0) {
+      m_buckets[h] = nullptr;
+      m_free_handles.push_back(h);
+      b->set_handle(0);
+    }
+  }
+};
+
+}  // namespace dynamic
+}  // namespace pred
+}  // namespace tdc
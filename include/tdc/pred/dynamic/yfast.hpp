@@ -1,11 +1,16 @@
 #include <robin_hood.h>
 
 #include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <iostream>
+#include <stdexcept>
 #include <tdc/pred/result.hpp>
 #include <vector>
 #include <tdc/pred/dynamic/buckets/yfast_buckets.hpp>
+#include <tdc/pred/dynamic/snapshot.hpp>
+#include <tdc/pred/dynamic/successor_iterator.hpp>
+#include <tdc/pred/dynamic/xfast_top.hpp>
 
 namespace tdc {
 namespace pred {
@@ -18,7 +23,7 @@ namespace dynamic {
 //  - The xfast_trie manages every '2^t_bucket_width'-th key. These keys are called a representants.
 //  - A representant is the smallest key of the bucket it represents. A bucket holds ~2^t_bucket_width keys.
 //    Each bucket stores a pointer to its next smaller and next greater bucket.
-// Each node in the xfast-trie contains a pointer and the nodes of the xfast trie are representated by an unordered_map in this way:
+// Each node in the xfast-trie contains a pointer and the nodes of the xfast trie are representated by a map from prefixes to buckets in this way:
 //  - The map contains the prefix <=> the node exists
 //    - The node has two children <=> The prefix is mapped to nullptr
 //    - The node has only a left child <=> The prefix is mapped to the greatest bucket in the left subtree
@@ -28,20 +33,22 @@ namespace dynamic {
 //  - t_value_type is the type of the managed keys.
 //  - t_key_width is the width of the managed keys.
 //  - t_merge_threshhold indicates that a bucket is merged at size <= 2^(t_bucket_width/t_merge_threshold)
+//  - t_xfast is the representation of the xfast_trie's levels, either xfast_map_levels or the more compact xfast_compact_table.
 
-template <class t_bucket,  uint8_t t_key_width>
+template <class t_bucket, uint8_t t_key_width, template <class, uint8_t> class t_xfast = xfast_map_levels>
 class YFastTrie {
 
  private:
-  // The top part of the yfast_trie is the xfast_trie. It contains a unordered_map for every level.
-  // The map for level l contains nodes with prefixes of the representants of length t_key_width-l.
+  // The top part of the yfast_trie is the xfast_trie. It contains a level for every prefix length.
+  // Level l contains nodes with prefixes of the representants of length t_key_width-l.
   // A level maps a node to a bucket in the following way:
-  //  - The map contains the prefix <=> the node exists
+  //  - The level contains the prefix <=> the node exists
   //    - The node has two children <=> The prefix is mapped to nullptr
   //    - The node has only a left child <=> The prefix is mapped to the greatest bucket in the left subtree
   //    - The node has only a right child <=> The prefix is mapped to the smallest bucket in the right subtree
   //    - The node has no children <=> The prefix is mapped to the only bucket whose representant has the same prefix as the node
-  std::array<robin_hood::unordered_map<uint64_t, t_bucket*>, t_key_width + 1> m_xfast;
+  // How the levels are stored is up to t_xfast, either in one hash map per level (xfast_map_levels) or in a single table (xfast_compact_table).
+  t_xfast<t_bucket, t_key_width> m_xfast;
 
   
 
@@ -54,6 +61,11 @@ class YFastTrie {
   // The number of keys stored in this data structure
   size_t m_size = 0;
 
+  // Returns the prefix of key on the given level.
+  static uint64_t prefix_of(const uint64_t key, const size_t level) {
+    return (level >= 64) ? 0 : (key >> level);
+  }
+
   // Insert a representant together with the bucket it represents
   // We traverse the tree from top to bot and update the tree until we find a 0-Node.
   // If there is a sibling, we can simply insert the representant. If the is no sibling, we have
@@ -67,18 +79,17 @@ class YFastTrie {
     uint64_t child_prefix = (prefix << 1) + next_bit;
     uint64_t sibling_prefix = (prefix << 1) + (1 - next_bit);
 
-    auto node = m_xfast[level].find(prefix);
-    auto child = m_xfast[level - 1].find(child_prefix);
-    auto sibling = m_xfast[level - 1].find(sibling_prefix);
+    bool child = m_xfast.contains(level - 1, child_prefix);
+    bool sibling = m_xfast.contains(level - 1, sibling_prefix);
 
     while (level > 0) {
-      if (child == m_xfast[level - 1].end()) {
-        if (sibling == m_xfast[level - 1].end()) {
+      if (!child) {
+        if (!sibling) {
           // Child and sibling do not exist.
           // Here we have to split the node until we find the parent of child and node.
           t_bucket* smaller_bucket;
           t_bucket* greater_bucket;
-          t_bucket* other_b = node->second;
+          t_bucket* other_b = m_xfast.at(level, prefix);
           uint64_t other_key = other_b->get_repr();
           uint64_t other_next_bit = (other_key >> (level - 1)) & 0x1;
           if (key < other_key) {
@@ -90,38 +101,39 @@ class YFastTrie {
           }
           while (next_bit == other_next_bit) {
             if (next_bit == 0) {
-              m_xfast[level][prefix] = greater_bucket;
+              m_xfast.set(level, prefix, greater_bucket);
             } else {
-              m_xfast[level][prefix] = smaller_bucket;
+              m_xfast.set(level, prefix, smaller_bucket);
             }
             --level;
             prefix = (key >> level);
             next_bit = (key >> (level - 1)) & 0x1;
             other_next_bit = (other_key >> (level - 1)) & 0x1;
           }
-          m_xfast[level][prefix] == nullptr;
-          m_xfast[level - 1][prefix << 1] = smaller_bucket;
-          m_xfast[level - 1][(prefix << 1) + 1] = greater_bucket;
+          m_xfast.set(level, prefix, nullptr);
+          m_xfast.set(level - 1, prefix << 1, smaller_bucket);
+          m_xfast.set(level - 1, (prefix << 1) + 1, greater_bucket);
           return;
 
         } else {
           // Child does not exists, but sibling exists.
           // Here we can simply insert the new node and return.
-          m_xfast[level][prefix] = nullptr;
-          m_xfast[level - 1][child_prefix] = b;
+          m_xfast.set(level, prefix, nullptr);
+          m_xfast.set(level - 1, child_prefix, b);
           return;
         }
       } else {
-        if (sibling == m_xfast[level - 1].end()) {
+        if (!sibling) {
           // Child exists, but sibling does not exist
           // Here we may have to update the pointer of node
+          t_bucket* const node_b = m_xfast.at(level, prefix);
           if (next_bit == 0) {
-            if (b->get_repr() > node->second->get_repr()) {
-              m_xfast[level][prefix] = b;
+            if (b->get_repr() > node_b->get_repr()) {
+              m_xfast.set(level, prefix, b);
             }
           } else {
-            if (b->get_repr() < node->second->get_repr()) {
-              m_xfast[level][prefix] = b;
+            if (b->get_repr() < node_b->get_repr()) {
+              m_xfast.set(level, prefix, b);
             }
           }
         } else {
@@ -136,9 +148,10 @@ class YFastTrie {
       child_prefix = (prefix << 1) + next_bit;
       sibling_prefix = (prefix << 1) + (1 - next_bit);
 
-      node = child;
-      child = m_xfast[level - 1].find(child_prefix);
-      sibling = m_xfast[level - 1].find(sibling_prefix);
+      if (level > 0) {
+        child = m_xfast.contains(level - 1, child_prefix);
+        sibling = m_xfast.contains(level - 1, sibling_prefix);
+      }
     }
   }
 
@@ -149,61 +162,57 @@ class YFastTrie {
   // or becomes the root. From here we move to the top and adjust every pointer.
   void remove_repr(uint64_t key) {
     size_t level = find_level(key);
-    uint64_t prefix = (level == 64) ? 0 : (key >> level);
+    uint64_t prefix = prefix_of(key, level);
     uint64_t last_bit = prefix & 0x1;
-    m_xfast[level].erase(prefix);
+    m_xfast.erase(level, prefix);
 
     if (level == t_key_width) {
       return;
     }
     uint64_t sibling_prefix = (last_bit == 0) ? prefix + 1 : prefix - 1;
-    auto sibling = m_xfast[level].find(sibling_prefix);
-    auto sibling_left_child = m_xfast[level - 1].find((sibling_prefix << 1) + 0);
-    auto sibling_right_child = m_xfast[level - 1].find((sibling_prefix << 1) + 1);
+    const bool sibling_left_child = level > 0 && m_xfast.contains(level - 1, (sibling_prefix << 1) + 0);
+    const bool sibling_right_child = level > 0 && m_xfast.contains(level - 1, (sibling_prefix << 1) + 1);
 
-    if (sibling_left_child == m_xfast[level - 1].end() && sibling_right_child == m_xfast[level - 1].end()) {
+    if (!sibling_left_child && !sibling_right_child) {
       // If the sibling does not have children we have to collapse the tree at this point.
-      t_bucket* sift_up_bucket = sibling->second;
-      m_xfast[level].erase(sibling_prefix);
+      t_bucket* sift_up_bucket = m_xfast.at(level, sibling_prefix);
+      m_xfast.erase(level, sibling_prefix);
 
       ++level;
       prefix >>= 1;
       last_bit = prefix & 0x1;
       sibling_prefix = (last_bit == 0) ? prefix + 1 : prefix - 1;
-      sibling = m_xfast[level].find(sibling_prefix);
 
-      while (sibling == m_xfast[level].end() && (level < t_key_width)) {
-        m_xfast[level].erase(prefix);
+      while (level < t_key_width && !m_xfast.contains(level, sibling_prefix)) {
+        m_xfast.erase(level, prefix);
         ++level;
         prefix >>= 1;
         last_bit = prefix & 0x1;
         sibling_prefix = (last_bit == 0) ? prefix + 1 : prefix - 1;
-        sibling = m_xfast[level].find(sibling_prefix);
       }
       if (level == t_key_width) {
-        m_xfast[level][0] = sift_up_bucket;
+        m_xfast.set(level, 0, sift_up_bucket);
         return;
       }
-      m_xfast[level][prefix] = sift_up_bucket;
-      m_xfast[level + 1][prefix >> 1] = nullptr;
+      m_xfast.set(level, prefix, sift_up_bucket);
+      m_xfast.set(level + 1, prefix >> 1, nullptr);
     } else {
       // If the sibling has children we do not have to collapse the tree.
       ++level;
       last_bit = prefix & 0x1;
       prefix >>= 1;
-      m_xfast[level][prefix] = (last_bit == 0) ? min_repr(level - 1, sibling_prefix) : max_repr(level - 1, sibling_prefix);
+      m_xfast.set(level, prefix, (last_bit == 0) ? min_repr(level - 1, sibling_prefix) : max_repr(level - 1, sibling_prefix));
     }
     ++level;
     last_bit = prefix & 0x1;
-    prefix = (level == 64) ? 0 : (key >> level);
+    prefix = prefix_of(key, level);
 
     // From here on we traverse the tree up to the root any update pointers when a node only has one child.
     while (level <= t_key_width) {
       uint64_t child_prefix = (prefix << 1) + last_bit;
       uint64_t other_child_prefix = (prefix << 1) + (1 - last_bit);
-      auto other_child = m_xfast[level - 1].find(other_child_prefix);
-      if (other_child == m_xfast[level - 1].end()) {
-        m_xfast[level][prefix] = (last_bit == 0) ? max_repr(level - 1, child_prefix) : min_repr(level - 1, child_prefix);
+      if (!m_xfast.contains(level - 1, other_child_prefix)) {
+        m_xfast.set(level, prefix, (last_bit == 0) ? max_repr(level - 1, child_prefix) : min_repr(level - 1, child_prefix));
       }
       ++level;
       last_bit = prefix & 0x1;
@@ -212,18 +221,18 @@ class YFastTrie {
   }
 
   void update_after_insertion() {
-    while ((m_lowest_complete_level > 0) && (m_xfast[m_lowest_complete_level - 1].size() == (1ULL << 1 << (64 - m_lowest_complete_level)))) {
+    while ((m_lowest_complete_level > 0) && (m_xfast.level_size(m_lowest_complete_level - 1) == (1ULL << 1 << (64 - m_lowest_complete_level)))) {
       --m_lowest_complete_level;
     }
-    while (m_lowest_non_empty_level > 0 && (m_xfast[m_lowest_non_empty_level - 1].size() > 0)) {
+    while (m_lowest_non_empty_level > 0 && (m_xfast.level_size(m_lowest_non_empty_level - 1) > 0)) {
       --m_lowest_non_empty_level;
     }
   }
   void update_after_deletion() {
-    while ((m_lowest_complete_level < t_key_width) && (m_xfast[m_lowest_complete_level].size() < (1ULL << (64 - m_lowest_complete_level)))) {
+    while ((m_lowest_complete_level < t_key_width) && (m_xfast.level_size(m_lowest_complete_level) < (1ULL << (64 - m_lowest_complete_level)))) {
       ++m_lowest_complete_level;
     }
-    while ((m_lowest_non_empty_level < t_key_width) && (m_xfast[m_lowest_non_empty_level].size() == 0)) {
+    while ((m_lowest_non_empty_level < t_key_width) && (m_xfast.level_size(m_lowest_non_empty_level) == 0)) {
       ++m_lowest_non_empty_level;
     }
   }
@@ -232,27 +241,27 @@ class YFastTrie {
   // that corrospondents to (level, key).
   t_bucket* min_repr(uint64_t level, uint64_t key) const {
     while (level > 0) {
-      if (m_xfast[level - 1].find(key << 1) == m_xfast[level - 1].end()) {
+      if (!m_xfast.contains(level - 1, key << 1)) {
         // Shortcut if there already is a pointer to the smallest representant.
-        return m_xfast[level].at(key);
+        return m_xfast.at(level, key);
       }
       --level;
       key <<= 1;
     }
-    return m_xfast[0].at(key);
+    return m_xfast.at(0, key);
   }
   // Returns the bucket with the biggest representant in the subtree from the node
   // that corrospondents to (level, key)
   t_bucket* max_repr(uint64_t level, uint64_t key) const {
     while (level > 0) {
-      if (m_xfast[level - 1].find((key << 1) + 1) == m_xfast[level - 1].end()) {
+      if (!m_xfast.contains(level - 1, (key << 1) + 1)) {
         // Shortcut if there already is a pointer to the biggest representant.
-        return m_xfast[level].at(key);
+        return m_xfast.at(level, key);
       }
       --level;
       key = (key << 1) + 1;
     }
-    return m_xfast[0].at(key);
+    return m_xfast.at(0, key);
   }
 
   // Return the lowest level at which a node representates a prefix of the key.
@@ -264,8 +273,11 @@ class YFastTrie {
 
     // The borders l and r meet at the lowest level in which a node with a prefix of key exist.
     while (l != r) {
-      auto mapped = m_xfast[m].find(key >> m);
-      if (mapped != m_xfast[m].end()) {
+      // Whatever the outcome of this probe, one of the two levels in the middle of the remaining halves is probed next.
+      // Prefetching both hides the latency of the next probe behind this one.
+      m_xfast.prefetch((l + m) / 2, key >> ((l + m) / 2));
+      m_xfast.prefetch((m + 1 + r) / 2, prefix_of(key, (m + 1 + r) / 2));
+      if (m_xfast.contains(m, key >> m)) {
         r = m;
       } else {
         l = m + 1;
@@ -281,7 +293,7 @@ class YFastTrie {
   // next greater bucket.
   t_bucket* pred_bucket(uint64_t key) const {
     size_t first1 = find_level(key);
-    t_bucket* b = m_xfast[first1].at((key >> 1) >> (first1 - 1));
+    t_bucket* b = m_xfast.at(first1, prefix_of(key, first1));
     if (b->get_repr() <= key) {
       return b;
     } else {
@@ -289,13 +301,46 @@ class YFastTrie {
     }
   }
 
+  // The maximum number of buckets we walk along the bucket list before searching the xfast_trie instead.
+  static constexpr size_t c_finger_steps = 4;
+
+  // Batches are only sorted and processed using a finger if they contain at least one key per this many stored keys.
+  // Sparser batches rarely hit the same bucket twice, so sorting them does not pay off.
+  static constexpr size_t c_finger_density = 64;
+
+  // Returns the bucket in which key belongs, starting the search at the finger bucket b whose representant is at most key.
+  t_bucket* finger_bucket(t_bucket* b, const uint64_t key) const {
+    if (b == nullptr) {
+      return pred_bucket(key);
+    }
+    assert(static_cast<uint64_t>(b->get_repr()) <= key);
+    for (size_t i = 0; i < c_finger_steps; ++i) {
+      t_bucket* const next = b->get_next();
+      if (next == nullptr || static_cast<uint64_t>(next->get_repr()) > key) {
+        return b;
+      }
+      b = next;
+    }
+    return pred_bucket(key);
+  }
+
+  template <typename key_t>
+  static std::vector<uint64_t> sorted_batch(const key_t* keys, const size_t num) {
+    std::vector<uint64_t> batch(num);
+    for (size_t i = 0; i < num; ++i) {
+      batch[i] = static_cast<uint64_t>(keys[i]);
+    }
+    std::sort(batch.begin(), batch.end());
+    return batch;
+  }
+
  public:
   YFastTrie() {
-    m_xfast[t_key_width][0] = new t_bucket(0, false, nullptr, nullptr);
+    m_xfast.set(t_key_width, 0, new t_bucket(0, false, nullptr, nullptr));
   };
   // Inserts the first num keys from keys into the yfast_trie.
   YFastTrie(const uint64_t* keys, const size_t num) {
-    m_xfast[t_key_width][0] = new t_bucket(0, false, nullptr, nullptr);
+    m_xfast.set(t_key_width, 0, new t_bucket(0, false, nullptr, nullptr));
     for (size_t i = 0; i < num; ++i) {
       insert(keys[i]);
     }
@@ -348,10 +393,124 @@ class YFastTrie {
       update_after_insertion();
     }
     if(update.bucket_to_delete != nullptr) {
+      m_xfast.release(update.bucket_to_delete);
       delete update.bucket_to_delete;
     }
   }
 
+  // Inserts a batch of keys, none of which must be contained.
+  // A dense batch is sorted and we keep a finger on the bucket of the last inserted key. As long as the next key
+  // falls into that bucket or one of the few following ones, we walk along the bucket list instead of searching the xfast_trie.
+  template <typename key_t>
+  void insert_batch(const key_t* keys, const size_t num) {
+    if (num * c_finger_density < m_size) {
+      for (size_t i = 0; i < num; ++i) {
+        insert(static_cast<uint64_t>(keys[i]));
+      }
+      return;
+    }
+    const std::vector<uint64_t> batch = sorted_batch(keys, num);
+    t_bucket* b = nullptr;
+    for (const uint64_t key : batch) {
+      ++m_size;
+      b = finger_bucket(b, key);
+      t_bucket* new_bucket = b->insert(key);
+      if (new_bucket != nullptr) {
+        insert_repr(new_bucket);
+        update_after_insertion();
+      }
+    }
+  }
+
+  // Constructs the yfast_trie from the given keys, which must be unique and in ascending order. The yfast_trie must be empty before.
+  // The keys are distributed over the bucket list from left to right, so that every bucket receives bulk_size keys,
+  // and only the representants of the buckets are inserted into the xfast_trie.
+  template <typename key_t>
+  void bulk_load(const key_t* keys, const size_t num) {
+    assert(m_size == 0);
+    const size_t bulk_size = t_bucket::bulk_size;
+
+    // the first bucket has the representant 0, which is activated if 0 is contained
+    t_bucket* b = m_xfast.at(t_key_width, 0);
+    size_t i = 0;
+    for (; i < std::min(num, bulk_size); ++i) {
+      b->insert(static_cast<uint64_t>(keys[i]));
+    }
+    while (i < num) {
+      assert(static_cast<uint64_t>(keys[i - 1]) < static_cast<uint64_t>(keys[i]));
+      const size_t end = std::min(num, i + bulk_size);
+      b = b->append(static_cast<uint64_t>(keys[i]));
+      for (++i; i < end; ++i) {
+        b->insert(static_cast<uint64_t>(keys[i]));
+      }
+      insert_repr(b);
+    }
+    update_after_insertion();
+    m_size = num;
+  }
+
+  // Writes a snapshot of the yfast_trie, see snapshot.hpp.
+  // Rather than iterating using successor queries, we walk along the bucket list and write the keys of every bucket.
+  void snapshot(std::ostream& out) const {
+    snapshot::write_header<uint64_t>(out, m_size);
+    std::vector<uint64_t> keys;
+    for (t_bucket const* b = min_repr(t_key_width, 0); b != nullptr; b = b->get_next()) {
+      keys.clear();
+      b->collect(keys);
+      out.write((const char*)keys.data(), keys.size() * sizeof(uint64_t));
+    }
+  }
+
+  // Restores a snapshot using bulk_load. Throws std::logic_error unless the yfast_trie is empty.
+  void restore(std::istream& in) {
+    if (m_size != 0) {
+      throw std::logic_error("a snapshot can only be restored into an empty yfast trie");
+    }
+    snapshot::read<uint64_t>(in, [&](const uint64_t* keys, const size_t num) { bulk_load(keys, num); });
+  }
+
+  // Restores a snapshot in memory, e.g., a memory mapped file, using bulk_load. Throws std::logic_error unless the yfast_trie is empty.
+  void restore(const void* data, const size_t size) {
+    if (m_size != 0) {
+      throw std::logic_error("a snapshot can only be restored into an empty yfast trie");
+    }
+    snapshot::read<uint64_t>(data, size, [&](const uint64_t* keys, const size_t num) { bulk_load(keys, num); });
+  }
+
+  // Removes a batch of keys, all of which must be contained. Like insert_batch, this uses a finger into the bucket list.
+  template <typename key_t>
+  void remove_batch(const key_t* keys, const size_t num) {
+    if (num * c_finger_density < m_size) {
+      for (size_t i = 0; i < num; ++i) {
+        remove(static_cast<uint64_t>(keys[i]));
+      }
+      return;
+    }
+    const std::vector<uint64_t> batch = sorted_batch(keys, num);
+    t_bucket* b = nullptr;
+    for (const uint64_t key : batch) {
+      --m_size;
+      b = finger_bucket(b, key);
+      xfast_update update = b->remove(key);
+      if (update.repr_to_remove != 0) {
+        remove_repr(update.repr_to_remove);
+        update_after_deletion();
+      }
+      if (update.repr_to_insert != nullptr) {
+        insert_repr(update.repr_to_insert);
+        update_after_insertion();
+      }
+      if (update.bucket_to_delete != nullptr) {
+        // the finger's bucket was merged into its predecessor
+        if (update.bucket_to_delete == b) {
+          b = b->get_prev();
+        }
+        m_xfast.release(update.bucket_to_delete);
+        delete update.bucket_to_delete;
+      }
+    }
+  }
+
   // Return the predecessor of key. If there are no keys {false, 0} is returned.
   // If there is no predecessor {false, 1} is returned.
   KeyResult<uint64_t> predecessor(uint64_t key) const {
@@ -360,6 +519,43 @@ class YFastTrie {
     // Search for the predecessor in the bucket and return it.
     return search_bucket->predecessor(key);
   }
+
+  // Return the successor of key. If there is no successor {false, 0} is returned.
+  KeyResult<uint64_t> successor(uint64_t key) const {
+    // The successor is either in the bucket that contains the predecessor, or in one of the following buckets.
+    t_bucket const* const search_bucket = pred_bucket(key);
+    return search_bucket->successor(key);
+  }
+
+  using iterator = SuccessorIterator<YFastTrie>;
+
+  // Returns an iterator pointing to the smallest key greater than or equal to x.
+  iterator lower_bound(uint64_t x) const {
+    return iterator(*this, x);
+  }
+
+  // Returns an iterator pointing to the smallest key.
+  iterator begin() const {
+    return lower_bound(0);
+  }
+
+  // Returns an iterator pointing to the end.
+  iterator end() const {
+    return iterator();
+  }
+
+  // Returns the number of keys in the range [a, b].
+  // We locate the bucket containing a and then scan the buckets until we pass b.
+  size_t count_range(uint64_t a, uint64_t b) const {
+    if (a > b) {
+      return 0;
+    }
+    size_t count = 0;
+    for (t_bucket const* bucket = pred_bucket(a); bucket != nullptr && static_cast<uint64_t>(bucket->get_repr()) <= b; bucket = bucket->get_next()) {
+      count += bucket->count_range(a, b);
+    }
+    return count;
+  }
 };
 
 }  // namespace dynamic
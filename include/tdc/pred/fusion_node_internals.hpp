@@ -6,6 +6,9 @@
 #include <cstring>
 #include <limits>
 #include <tuple>
+#include <type_traits>
+
+#include <immintrin.h>
 
 #include <tdc/intrisics/lzcnt.hpp>
 #include <tdc/intrisics/pcmp.hpp>
@@ -20,6 +23,11 @@
 
 /// \cond INTERNAL
 
+// with AVX-512, nodes with 16 and 32 keys match and rank compressed keys in vector registers
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VL__)
+#define TDC_FUSION_NODE_AVX512
+#endif
+
 namespace tdc {
 namespace pred {
 namespace internal {
@@ -102,7 +110,16 @@ public:
     // compress a key using a mask (PEXT)
     template<typename key_t>
     static ckey_t compress(const key_t& key, const key_t& mask) {
+#ifdef __BMI2__
+        if constexpr(std::numeric_limits<key_t>::digits <= 64) {
+            // inline the instruction for keys that fit into a machine word
+            return (ckey_t)_pext_u64((uint64_t)key, (uint64_t)mask);
+        } else {
+            return (ckey_t)intrisics::pext(key, mask);
+        }
+#else
         return (ckey_t)intrisics::pext(key, mask);
+#endif
     }
     
     // find the rank of a repeated value in a packed array of eight bytes
@@ -124,8 +141,46 @@ public:
         return ctz - 1;
     }
     
+#ifdef TDC_FUSION_NODE_AVX512
+    // the match operation using AVX-512
+    // the matching array is computed and compared against the repeated compressed key in vector registers,
+    // and the comparison directly yields a bit mask with one bit per compressed key
+    static size_t match_avx512(const ckey_t& cx, const matrix_t& branch, const matrix_t& free) {
+        static constexpr int BRANCH_OR_FREE_AND_X = 0xF8; // ternary logic truth table for a | (b & c)
+
+        uint64_t gt;
+        if constexpr(std::is_same<ckey_t, uint16_t>::value) {
+            const __m256i x = _mm256_set1_epi16(cx);
+            const __m256i match_array = _mm256_ternarylogic_epi64(
+                _mm256_loadu_si256((const __m256i*)&branch),
+                _mm256_loadu_si256((const __m256i*)&free),
+                x, BRANCH_OR_FREE_AND_X);
+            gt = _mm256_cmpgt_epu16_mask(match_array, x);
+        } else {
+            static_assert(std::is_same<ckey_t, uint32_t>::value);
+            const __m512i x = _mm512_set1_epi32(cx);
+            const uint8_t* pbranch = (const uint8_t*)&branch;
+            const uint8_t* pfree = (const uint8_t*)&free;
+            const __m512i match_lo = _mm512_ternarylogic_epi64(_mm512_loadu_si512(pbranch), _mm512_loadu_si512(pfree), x, BRANCH_OR_FREE_AND_X);
+            const __m512i match_hi = _mm512_ternarylogic_epi64(_mm512_loadu_si512(pbranch + 64), _mm512_loadu_si512(pfree + 64), x, BRANCH_OR_FREE_AND_X);
+            gt = uint64_t(_mm512_cmpgt_epu32_mask(match_lo, x)) | (uint64_t(_mm512_cmpgt_epu32_mask(match_hi, x)) << 16);
+        }
+
+        // the rank is the position before the first key greater than the compressed key (see rank)
+        const size_t ctz = __builtin_ctzll(gt | (1ULL << ckey_matrix<ckey_t>::MAX_NUM));
+        assert(ctz > 0);
+        return ctz - 1;
+    }
+#endif
+
     // the match operation from Patrascu & Thorup, 2014
     static size_t match_compressed(const ckey_t& cx, const matrix_t& branch, const matrix_t& free) {
+#ifdef TDC_FUSION_NODE_AVX512
+        if constexpr(!linear_rank && sizeof(ckey_t) >= 2) {
+            return match_avx512(cx, branch, free);
+        }
+#endif
+
         // repeat the compressed key
         const matrix_t cx_repeat = repeat(cx);
         
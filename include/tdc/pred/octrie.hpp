@@ -42,7 +42,8 @@ protected:
     /// \param keys a pointer to the keys, that must be in ascending order
     /// \param num the number of keys
     /// \param height the maximum height of the octrie
-    Octrie(const uint64_t* keys, const size_t num, const size_t max_height);
+    /// \param num_threads the number of threads used to construct the nodes of each level
+    Octrie(const uint64_t* keys, const size_t num, const size_t max_height, const size_t num_threads);
 
 public:
     /// \brief Constructs an empty octrie.
@@ -50,9 +51,14 @@ public:
     }
 
     /// \brief Constructs an octrie for the given keys.
+    ///
+    /// The nodes of each level are independent of each other and can be constructed in parallel.
+    /// The resulting octrie is the same regardless of the number of threads.
+    ///
     /// \param keys a pointer to the keys, that must be in ascending order
     /// \param num the number of keys
-    Octrie(const uint64_t* keys, const size_t num);
+    /// \param num_threads the number of threads used to construct the nodes of each level
+    Octrie(const uint64_t* keys, const size_t num, const size_t num_threads = 1);
     
     Octrie(const Octrie& other) = default;
     Octrie(Octrie&& other) = default;
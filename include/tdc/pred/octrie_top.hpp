@@ -22,7 +22,8 @@ public:
     /// \param keys a pointer to the keys, that must be in ascending order
     /// \param num the number of keys
     /// \param cut_levels the number of bottom levels to cut off
-    OctrieTop(const uint64_t* keys, const size_t num, const size_t cut_levels);
+    /// \param num_threads the number of threads used to construct the nodes of each level
+    OctrieTop(const uint64_t* keys, const size_t num, const size_t cut_levels, const size_t num_threads = 1);
     
     OctrieTop(const OctrieTop& other) = default;
     OctrieTop(OctrieTop&& other) = default;
@@ -41,4 +41,27 @@ struct KeyResult {
     }
 };
 
+/// \brief The result of a predecessor or successor query in a map, wrapping the located key and its associated value.
+/// \tparam key_t the key type
+/// \tparam value_t the value type
+template<typename key_t, typename value_t>
+struct KeyValueResult {
+    /// \brief Whether the predecessor or successor exists.
+    bool exists;
+    
+    /// \brief The predecessor or successor, only meaningful if \ref exists is \c true.
+    key_t key;
+
+    /// \brief The value associated to the predecessor or successor, only meaningful if \ref exists is \c true.
+    value_t value;
+    
+    inline operator bool() const {
+        return exists;
+    }
+
+    inline operator KeyResult<key_t>() const {
+        return { exists, key };
+    }
+};
+
 }} // namespace tdc::pred
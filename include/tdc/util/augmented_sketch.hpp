@@ -1,5 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include <robin_hood.h>
 
 #include <tdc/util/count_min_sketch.hpp>
@@ -11,9 +18,13 @@ namespace tdc {
 ///
 /// Frequent keys will have an associated value, while non-frequent keys will not.
 ///
+/// Sketches that counted different parts of a stream can be merged, e.g., to count a stream using multiple threads (see \ref count_parallel).
+/// Merging retains the error bounds of the count-min sketch with respect to the combined stream, see \ref merge.
+///
 /// \tparam Key key type
 /// \tparam Value value type
-template<typename Key, typename Value>
+/// \tparam Sketch the count-min sketch type used for non-frequent keys
+template<typename Key, typename Value, typename Sketch = CountMinSketch<Key>>
 class AugmentedSketch {
 private:
     struct FilterEntry {
@@ -24,12 +35,12 @@ private:
 
     robin_hood::unordered_map<Key, FilterEntry> filter_;
     MinInc<Key>                                 min_;
-    CountMinSketch<Key>                         sketch_;
+    Sketch                                      sketch_;
 
     size_t max_filter_size_;
     
 public:
-    AugmentedSketch(size_t max_filter_size, size_t sketch_width, size_t sketch_height) : max_filter_size_(max_filter_size), sketch_(sketch_width, sketch_height) {
+    AugmentedSketch(size_t max_filter_size, size_t sketch_width, size_t sketch_height) : sketch_(sketch_width, sketch_height), max_filter_size_(max_filter_size) {
     }
 
     /// \brief Counts the specified key in the sketch once and updates its value.
@@ -44,9 +55,11 @@ public:
         } else {
             // non-frequent
             if(filter_.size() < max_filter_size_) {
-                // filter is not yet full, directly insert here with a count of one
-                const auto handle = min_.insert(key, 1);
-                filter_.emplace(key, FilterEntry { value, 0, handle });
+                // filter is not yet full, directly insert here
+                // the count is one unless another sketch has been merged, in which case the sketch may already hold counts for the key
+                const auto est = sketch_.estimate(key);
+                const auto handle = min_.insert(key, est + 1);
+                filter_.emplace(key, FilterEntry { value, est, handle });
             } else {
                 // count key in sketch
                 const auto est = sketch_.count_and_estimate(key, 1);
@@ -88,6 +101,96 @@ public:
             return false;
         }
     }
+
+    /// \brief Estimates the frequency of the specified key.
+    ///
+    /// For frequent keys, this is the count in the filter, otherwise it is the estimate of the count-min sketch.
+    /// In either case, it is an upper bound for the true frequency.
+    ///
+    /// \param key the key in question
+    index_t estimate(const Key& key) const {
+        auto it = filter_.find(key);
+        return (it != filter_.end()) ? min_.key(it->second.min_handle) : sketch_.estimate(key);
+    }
+
+    /// \brief Merges another sketch into this sketch.
+    ///
+    /// The other sketch is treated as the continuation of the stream counted by this sketch, i.e., the value associated to a frequent key
+    /// is taken from the other sketch if the key is frequent there.
+    ///
+    /// First, the counts that the filters gathered on top of the count-min sketches are added to this sketch's count-min sketch,
+    /// along with the counters of the other sketch's count-min sketch.
+    /// The result is a count-min sketch of the combined stream, so for every key, the estimate is at least its frequency \c f
+    /// and, with probability at least <tt>1 - e^(-height)</tt>, at most <tt>f + (e / width) * N</tt>, where \c N is the total count of both streams.
+    /// Then, the filter is rebuilt from the keys in both filters with the highest estimates. Since the filter counts start from these estimates,
+    /// the same bounds hold for all estimates after merging.
+    ///
+    /// \param other the sketch to merge, whose count-min sketch must have the same dimensions
+    void merge(const AugmentedSketch& other) {
+        assert(&other != this);
+        sketch_.merge(other.sketch_);
+
+        // collect the keys of both filters and flush their counts to the sketch
+        robin_hood::unordered_map<Key, Value> candidates;
+        for(const auto& [key, e] : filter_) {
+            sketch_.count(key, min_.key(e.min_handle) - e.old_count);
+            candidates[key] = e.value;
+        }
+        for(const auto& [key, e] : other.filter_) {
+            sketch_.count(key, other.min_.key(e.min_handle) - e.old_count);
+            candidates[key] = e.value;
+        }
+
+        // clear the filter
+        for(size_t i = 0; i < filter_.size(); i++) min_.extract_min();
+        filter_.clear();
+
+        // rebuild the filter from the candidates with the highest estimates
+        std::vector<std::pair<index_t, Key>> ranking;
+        ranking.reserve(candidates.size());
+        for(const auto& [key, value] : candidates) ranking.emplace_back(sketch_.estimate(key), key);
+
+        const size_t num = std::min(ranking.size(), max_filter_size_);
+        std::partial_sort(ranking.begin(), ranking.begin() + num, ranking.end(), [](const auto& a, const auto& b){ return a.first > b.first; });
+        for(size_t i = 0; i < num; i++) {
+            const auto [est, key] = ranking[i];
+            const auto handle = min_.insert(key, est);
+            filter_.emplace(key, FilterEntry { candidates[key], est, handle });
+        }
+    }
+
+    /// \brief Counts a sequence of keys using multiple threads.
+    ///
+    /// The sequence is split into contiguous parts, each of which is counted by a separate thread in a sketch of the same dimensions as this one.
+    /// The resulting sketches are then merged into this sketch in the order of the sequence.
+    ///
+    /// \tparam item_func_t the type of the item function
+    /// \param n the length of the sequence
+    /// \param item a function that, given an index less than \c n, returns the key and value at that position of the sequence as a \c std::pair
+    /// \param num_threads the number of threads to use, must be greater than zero
+    template<typename item_func_t>
+    void count_parallel(const size_t n, item_func_t item, const size_t num_threads) {
+        // sketches cannot be moved once they contain keys, because the handles point into the minimum data structure
+        std::vector<std::unique_ptr<AugmentedSketch>> parts;
+        for(size_t t = 0; t < num_threads; t++) {
+            parts.emplace_back(std::make_unique<AugmentedSketch>(max_filter_size_, sketch_.width(), sketch_.height()));
+        }
+
+        std::vector<std::thread> threads;
+        for(size_t t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t](){
+                const size_t begin = t * n / num_threads;
+                const size_t end = (t + 1) * n / num_threads;
+                for(size_t i = begin; i < end; i++) {
+                    const auto [key, value] = item(i);
+                    parts[t]->count(key, value);
+                }
+            });
+        }
+        for(auto& thread : threads) thread.join();
+
+        for(const auto& part : parts) merge(*part);
+    }
 };
 
 } // namespace tdc
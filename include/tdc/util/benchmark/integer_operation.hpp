@@ -22,6 +22,11 @@ constexpr opcode_t OPCODE_DELETE = 'D';
 /// \brief An operation code for \em query operations.
 constexpr opcode_t OPCODE_QUERY = 'Q';
 
+/// \brief An operation code for \em range query operations.
+///
+/// The keys of a range query batch are pairs of an inclusive lower and upper bound.
+constexpr opcode_t OPCODE_RANGE = 'R';
+
 template<typename key_t>
 class IntegerOperationBatch {
 private:
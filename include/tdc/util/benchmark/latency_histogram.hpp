@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tdc {
+namespace benchmark {
+
+/// \brief A histogram of operation latencies that supports percentile queries.
+///
+/// Latencies below <tt>2^SUB_BITS</tt> nanoseconds are counted exactly.
+/// Larger latencies are grouped by their most significant bit, and each such group is split into <tt>2^SUB_BITS</tt> equally wide buckets,
+/// so that the relative error of a reported percentile is below <tt>2^-SUB_BITS</tt>.
+/// The histogram has a fixed size and recording a latency takes constant time, which keeps the measurement overhead low.
+class LatencyHistogram {
+private:
+    static constexpr size_t SUB_BITS = 5;
+    static constexpr size_t SUB_BUCKETS = 1ULL << SUB_BITS;
+    static constexpr size_t NUM_BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    static size_t bucket(const uint64_t x) {
+        if(x < SUB_BUCKETS) return x;
+
+        const size_t shift = 63 - __builtin_clzll(x) - SUB_BITS;
+        return ((shift + 1) << SUB_BITS) + ((x >> shift) - SUB_BUCKETS);
+    }
+
+    // the middle of the range of latencies counted in the given bucket
+    static uint64_t value(const size_t b) {
+        if(b < SUB_BUCKETS) return b;
+
+        const size_t shift = (b >> SUB_BITS) - 1;
+        const uint64_t lo = (uint64_t)(SUB_BUCKETS + (b & (SUB_BUCKETS - 1))) << shift;
+        return lo + ((1ULL << shift) >> 1);
+    }
+
+    std::vector<uint64_t> m_counts;
+    uint64_t m_num;
+    uint64_t m_sum;
+    uint64_t m_max;
+
+public:
+    /// \brief Gets the current timestamp of a monotonic clock in nanoseconds, used to measure latencies.
+    static uint64_t now() {
+        using namespace std::chrono;
+        return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+    /// \brief Constructs an empty histogram.
+    LatencyHistogram() : m_counts(NUM_BUCKETS, 0), m_num(0), m_sum(0), m_max(0) {
+    }
+
+    /// \brief Records a latency.
+    /// \param nanos the latency in nanoseconds
+    void add(const uint64_t nanos) {
+        ++m_counts[bucket(nanos)];
+        ++m_num;
+        m_sum += nanos;
+        m_max = std::max(m_max, nanos);
+    }
+
+    /// \brief Adds all latencies recorded in another histogram.
+    /// \param other the other histogram
+    void merge(const LatencyHistogram& other) {
+        for(size_t b = 0; b < NUM_BUCKETS; b++) {
+            m_counts[b] += other.m_counts[b];
+        }
+        m_num += other.m_num;
+        m_sum += other.m_sum;
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    /// \brief Computes a percentile of the recorded latencies.
+    ///
+    /// The result is the middle of the bucket containing the percentile, but never exceeds the maximum recorded latency.
+    ///
+    /// \param q the percentile as a fraction between 0 and 1, e.g., 0.99 for the 99th percentile
+    /// \return the latency in nanoseconds, or zero if no latencies have been recorded
+    uint64_t percentile(const double q) const {
+        if(m_num == 0) return 0;
+
+        const uint64_t rank = std::max(uint64_t(1), (uint64_t)std::ceil(q * (double)m_num));
+        uint64_t cum = 0;
+        for(size_t b = 0; b < NUM_BUCKETS; b++) {
+            cum += m_counts[b];
+            if(cum >= rank) return std::min(value(b), m_max);
+        }
+        return m_max;
+    }
+
+    /// \brief Reports the number of recorded latencies.
+    uint64_t count() const {
+        return m_num;
+    }
+
+    /// \brief Reports the mean recorded latency in nanoseconds.
+    double mean() const {
+        return m_num ? (double)m_sum / (double)m_num : 0.0;
+    }
+
+    /// \brief Reports the maximum recorded latency in nanoseconds.
+    uint64_t max() const {
+        return m_max;
+    }
+};
+
+}} // namespace tdc::benchmark
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <concepts>
 #include <cstdint>
 #include <cstddef>
 #include <limits>
 #include <random>
+#include <stdexcept>
+#include <vector>
 
 #include <tdc/math/bit_mask.hpp>
 #include <tdc/math/ilog2.hpp>
@@ -14,31 +18,80 @@
 namespace tdc {
 
 /// \brief Generic count-min sketch.
+///
+/// The counters are stored in a single row-major array, so a sketch of moderate size fits into the cache.
+/// The row hashes of a key are computed for a fixed number of rows at a time in a loop that the compiler vectorizes.
+///
+/// Counters saturate at their maximum value rather than overflowing, so narrow counter types can be used to save space.
+/// In conservative update mode, counting a key only increases the counters that are below the new estimate,
+/// which reduces the overestimation of keys sharing counters with frequent keys.
+///
 /// \tparam Key key type
-template<typename Key>
+/// \tparam Counter the counter type
+/// \tparam t_conservative whether to use conservative update
+template<typename Key, std::unsigned_integral Counter = index_t, bool t_conservative = false>
 class CountMinSketch {
 private:
     using HalfKey = uint_half_t<Key>;
 
+    static constexpr size_t LANES = 4; // the number of rows hashed at once
+    static constexpr Counter COUNTER_MAX = std::numeric_limits<Counter>::max();
+
+    static Counter saturated_add(const Counter a, const index_t b) {
+        Counter sum;
+        const bool overflow = __builtin_add_overflow(a, Counter(std::min(b, index_t(COUNTER_MAX))), &sum);
+        return overflow ? COUNTER_MAX : sum;
+    }
+
     index_t width_mask_;
+    size_t  width_bits_;
     index_t height_;
 
-    std::vector<HalfKey>              hash_mul_;
-    std::vector<std::vector<index_t>> count_;
+    std::vector<HalfKey> hash_mul_; // padded to a multiple of LANES
+    std::vector<Counter> count_;
+    std::vector<size_t> pos_; // scratch space for the counter positions of a key in conservative update mode
 
-    index_t hash(const size_t j, const Key& key) const {
+    // computes the hashes of the key for rows j0 to j0 + LANES - 1
+    void hash(const size_t j0, const Key& key, index_t* h) const {
         constexpr size_t KEY_HALF_BITS = std::numeric_limits<Key>::digits / 2;
-        index_t h = ((HalfKey)key * hash_mul_[j]) ^ ((HalfKey)(key >> KEY_HALF_BITS) * hash_mul_[j]);
+        const HalfKey lo = (HalfKey)key;
+        const HalfKey hi = (HalfKey)(key >> KEY_HALF_BITS);
+        const HalfKey* mul = hash_mul_.data() + j0;
 
-        // modulo 2^19 - 1 (Mersenne prime)
-        {
-            constexpr index_t MERSENNE19 = (1U << 19) - 1;
-            const auto v = h + 1;
-            const auto z = ((v >> 19) + v) >> 19;
-            h = (h + z) & MERSENNE19;
+        for(size_t k = 0; k < LANES; k++) {
+            uint64_t x = HalfKey(lo * mul[k]) ^ HalfKey(hi * mul[k]);
+
+            // modulo 2^19 - 1 (Mersenne prime)
+            {
+                constexpr uint64_t MERSENNE19 = (1U << 19) - 1;
+                const auto v = x + 1;
+                const auto z = ((v >> 19) + v) >> 19;
+                x = (x + z) & MERSENNE19;
+            }
+
+            h[k] = index_t(x) & width_mask_;
+        }
+    }
+
+    // calls f with the position of the counter of the key in each row, and returns the minimum of the values returned by f
+    template<typename F>
+    index_t for_each_counter(const Key& key, F f) const {
+        index_t h[LANES];
+        index_t values[LANES];
+        index_t min = INDEX_MAX;
+        for(size_t j0 = 0; j0 < height_; j0 += LANES) {
+            hash(j0, key, h);
+
+            const size_t num = std::min(LANES, size_t(height_ - j0));
+            for(size_t k = 0; k < num; k++) {
+                values[k] = f(((j0 + k) << width_bits_) + h[k]);
+            }
+
+            // the row that holds the minimum is unpredictable, so the minimum is computed without branches
+            for(size_t k = num; k < LANES; k++) values[k] = INDEX_MAX;
+            for(size_t k = 0; k < LANES; k++) min = std::min(min, values[k]);
         }
-        
-        return h & width_mask_;
+        return min;
     }
 
 public:
@@ -46,25 +99,22 @@ public:
     /// \param width the width of the sketch (will be rounded to the next power of two)
     /// \param height the height of the sketch
     CountMinSketch(const size_t width, const size_t height) : height_(height) {
-        const auto wbits = math::ilog2_ceil(width - 1);
-        width_mask_ = math::bit_mask<index_t>(wbits);
+        width_bits_ = math::ilog2_ceil(width - 1);
+        width_mask_ = math::bit_mask<index_t>(width_bits_);
+        count_ = std::vector<Counter>(height_ << width_bits_, Counter(0));
 
-        count_.reserve(height_);
-        for(size_t j = 0; j < height_; j++) {
-            count_.emplace_back(1ULL << wbits, index_t(0));
-        }
-        
-        hash_mul_.reserve(height);
+        const size_t padded_height = (height_ + LANES - 1) / LANES * LANES;
+        hash_mul_.reserve(padded_height);
 
         {
             /*
              * generate random multipliers such that all nibbles are non-zero
              */
             static constexpr size_t num_nibbles = (std::numeric_limits<HalfKey>::digits / 4);
-            
+
             std::default_random_engine gen(random::DEFAULT_SEED);
             std::uniform_int_distribution<HalfKey> random_nibble(0x1, 0xF); // random
-            
+
             for(size_t j = 0; j < height_; j++) {
                 HalfKey mul = 0;
                 for(size_t i = 0; i < num_nibbles; i++) {
@@ -73,15 +123,25 @@ public:
                 hash_mul_.push_back(mul);
             }
         }
+
+        // the padding rows are hashed, but never used
+        hash_mul_.resize(padded_height, HalfKey(1));
+
+        if constexpr(t_conservative) pos_.resize(height_);
+    }
+
+    /// \brief Estimates the frequency of the specified key.
+    /// \param key the key in question
+    /// \return the estimated frequency of the key in the sketch
+    index_t estimate(const Key& key) const {
+        return for_each_counter(key, [&](const size_t i){ return index_t(count_[i]); });
     }
 
     /// \brief Counts the specified key in the sketch.
     /// \param key the key to count
     /// \param times the amount of times to count the key
     void count(const Key& key, index_t times) {
-        for(size_t j = 0; j < height_; j++) {
-            count_[j][hash(j, key)] += times;
-        }
+        count_and_estimate(key, times);
     }
 
     /// \brief Counts the specified key in the sketch and computes a new estimate.
@@ -89,14 +149,57 @@ public:
     /// \param times the amount of times to count the key
     /// \return the estimated frequency of the key in the sketch
     index_t count_and_estimate(const Key& key, index_t times) {
-        index_t est = INDEX_MAX;
-        for(size_t j = 0; j < height_; j++) {
-            auto& row = count_[j];
-            const auto h = hash(j, key);
-            row[h] += times;
-            est = std::min(est, row[h]);
+        if constexpr(t_conservative) {
+            // the counter positions are needed for both the estimate and the update, so they are only computed once
+            size_t j = 0;
+            const index_t min = for_each_counter(key, [&](const size_t i){
+                pos_[j++] = i;
+                return index_t(count_[i]);
+            });
+
+            const Counter est = saturated_add(Counter(min), times);
+            for(j = 0; j < height_; j++) {
+                count_[pos_[j]] = std::max(count_[pos_[j]], est);
+            }
+            return est;
+        } else {
+            return for_each_counter(key, [&](const size_t i){
+                count_[i] = saturated_add(count_[i], times);
+                return index_t(count_[i]);
+            });
+        }
+    }
+
+    /// \brief Adds the counters of another sketch to this sketch.
+    ///
+    /// Afterwards, this sketch is equivalent to a sketch that counted the keys counted by both sketches,
+    /// i.e., the estimates are upper bounds for the combined frequencies and the error is bounded relative to the combined number of counts.
+    /// This also holds in conservative update mode, even though the counters are not necessarily the same as if the keys had been counted in one sketch.
+    ///
+    /// \param other the sketch to merge, must have the same width and height
+    void merge(const CountMinSketch& other) {
+        if(other.width_bits_ != width_bits_ || other.height_ != height_) {
+            throw std::invalid_argument("sketches of different dimensions cannot be merged");
         }
-        return est;
+
+        for(size_t i = 0; i < count_.size(); i++) {
+            count_[i] = saturated_add(count_[i], other.count_[i]);
+        }
+    }
+
+    /// \brief Reports the width of the sketch.
+    size_t width() const {
+        return size_t(width_mask_) + 1;
+    }
+
+    /// \brief Reports the height of the sketch.
+    size_t height() const {
+        return height_;
+    }
+
+    /// \brief Reports the size of the counter array in bytes.
+    size_t size_bytes() const {
+        return count_.size() * sizeof(Counter);
     }
 };
 
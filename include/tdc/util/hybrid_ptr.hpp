@@ -147,7 +147,7 @@ public:
     /// If that is not the case, the pointer is invalid.
     std::unique_ptr<second_t> release_as_second() {
         assert(m_ptr);
-        assert(is_first());
+        assert(is_second());
         
         std::unique_ptr<second_t> ptr(as_second());
         m_ptr = 0;
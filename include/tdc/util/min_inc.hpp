@@ -81,6 +81,12 @@ public:
         return Handle { bucket, bucket->emplace_front(item) };
     }
 
+    /// \brief Reports the key of an item.
+    /// \param h the item handle
+    Key key(const Handle& h) const {
+        return h.bucket->key;
+    }
+
     /// \brief Reports the current minimum key.
     Key min() const {
         assert(!buckets_.empty());
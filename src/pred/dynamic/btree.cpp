@@ -1,5 +1,6 @@
 #include <tdc/pred/dynamic/btree.hpp>
 #include <tdc/pred/dynamic/btree/dynamic_fusion_node.hpp>
+#include <tdc/pred/dynamic/btree/node_allocator.hpp>
 #include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
 
 using namespace tdc::pred::dynamic;
@@ -8,3 +9,4 @@ using namespace tdc::pred::dynamic;
 class BTree<uint64_t, 9, DynamicFusionNode<uint64_t, 8>>;
 class BTree<uint64_t, 9, SortedArrayNode<uint64_t, 8>>;
 class BTree<uint64_t, 65, SortedArrayNode<uint64_t, 64>>;
+class BTree<uint64_t, 65, SortedArrayNode<uint64_t, 64>, PoolNodeAllocator>;
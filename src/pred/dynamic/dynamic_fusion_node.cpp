@@ -1,3 +1,5 @@
 #include <tdc/pred/dynamic/btree/dynamic_fusion_node.hpp>
 
 class tdc::pred::dynamic::DynamicFusionNode<>;
+class tdc::pred::dynamic::DynamicFusionNode<uint64_t, 16>;
+class tdc::pred::dynamic::DynamicFusionNode<uint64_t, 32>;
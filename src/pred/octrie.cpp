@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <iostream> // FIXME: DEBUG
+#include <thread>
 
 #include <tdc/math/idiv.hpp>
 #include <tdc/util/assert.hpp>
@@ -9,8 +10,9 @@
 
 using namespace tdc::pred;
 
-Octrie::Octrie(const uint64_t* keys, const size_t num, const size_t max_height) {
+Octrie::Octrie(const uint64_t* keys, const size_t num, const size_t max_height, const size_t num_threads) {
     assert(num > 0);
+    assert(num_threads > 0);
     assert_sorted_ascending(keys, num);
     
     // allocate memory for octree
@@ -33,30 +35,49 @@ Octrie::Octrie(const uint64_t* keys, const size_t num, const size_t max_height)
         
         auto& octree_level = m_octree[level];
         octree_level.first_node = (level > 0) ? octree_size(level) : 0;
-        octree_level.nodes.reserve(math::idiv_ceil(num, 8 * k));
 
-        // scan keys
-        size_t i = 0;
-        while(i < num) {
-            // (virtually) sample the next at most 8 keys
-            const size_t j = std::min(math::idiv_ceil(num - i, k), uint64_t(8));
+        // the p-th node of this level samples the (at most) 8 keys starting at position p * 8k
+        const size_t num_nodes = math::idiv_ceil(num, 8 * k);
+        octree_level.nodes.resize(num_nodes);
+
+        auto construct_nodes = [&](const size_t first, const size_t last){
+            for(size_t p = first; p < last; p++) {
+                const size_t i = p * 8 * k;
+                
+                // (virtually) sample the next at most 8 keys
+                const size_t j = std::min(math::idiv_ceil(num - i, k), uint64_t(8));
+                SkipAccessor<uint64_t> sample(keys, k, i);
+                
+                // construct a compressed trie for the sample and put it in the octree
+                octree_level.nodes[p] = FusionNode<>(sample, j);
+            }
+        };
+
+        // distribute the nodes in contiguous chunks over the threads
+        const size_t num_chunks = std::min(num_threads, num_nodes);
+        if(num_chunks > 1) {
+            const size_t chunk_size = math::idiv_ceil(num_nodes, num_chunks);
             
-            SkipAccessor<uint64_t> sample(keys, k, i);
-            i += j * k;
+            std::vector<std::thread> threads;
+            threads.reserve(num_chunks - 1);
+            for(size_t t = 1; t < num_chunks; t++) {
+                const size_t first = t * chunk_size;
+                const size_t last = std::min(first + chunk_size, num_nodes);
+                if(first < last) threads.emplace_back(construct_nodes, first, last);
+            }
             
-            // construct a compressed trie for the sample and put it in the octree
-            assert(octree_level.nodes.size() < octree_level.nodes.capacity());
-            octree_level.nodes.emplace_back(sample, j);
+            construct_nodes(0, chunk_size);
+            for(auto& thread : threads) thread.join();
+        } else {
+            construct_nodes(0, num_nodes);
         }
-
-        assert(octree_level.nodes.size() == octree_level.nodes.capacity());
     }
     
     m_root = &m_octree[0].nodes[0];
     assert(m_root);
 }
 
-Octrie::Octrie(const uint64_t* keys, const size_t num) : Octrie(keys, num, log8_ceil(num)) {
+Octrie::Octrie(const uint64_t* keys, const size_t num, const size_t num_threads) : Octrie(keys, num, log8_ceil(num), num_threads) {
 }
 
 PosResult Octrie::predecessor(const uint64_t* keys, const size_t num, const uint64_t x) const {
@@ -7,8 +7,8 @@
 
 using namespace tdc::pred;
 
-OctrieTop::OctrieTop(const uint64_t* keys, const size_t num, const size_t cut_levels)
-    : Octrie(keys, num, std::max(log8_ceil(num), size_t(cut_levels + 1)) - cut_levels) {
+OctrieTop::OctrieTop(const uint64_t* keys, const size_t num, const size_t cut_levels, const size_t num_threads)
+    : Octrie(keys, num, std::max(log8_ceil(num), size_t(cut_levels + 1)) - cut_levels, num_threads) {
 
     m_cut_levels = cut_levels;
     m_full_octree_size_ub = octree_size(m_full_octree_height);
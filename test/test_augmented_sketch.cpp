@@ -0,0 +1,105 @@
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <tdc/util/augmented_sketch.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+using Sketch = tdc::AugmentedSketch<Key, size_t>;
+
+constexpr size_t FILTER = 32;
+constexpr size_t WIDTH = 1024;
+constexpr size_t HEIGHT = 4;
+
+// a skewed stream, where key 0 is the most frequent
+std::vector<Key> stream(const size_t n) {
+    std::vector<Key> keys(n);
+    std::mt19937_64 gen(n);
+    std::geometric_distribution<Key> dist(0.01);
+    for(auto& k : keys) k = dist(gen);
+    return keys;
+}
+
+// checks that all estimates are upper bounds and that the count-min error bound holds for almost all keys
+void check_estimates(const Sketch& sketch, const std::vector<Key>& keys) {
+    std::unordered_map<Key, size_t> freq;
+    for(const Key k : keys) ++freq[k];
+
+    const double eps = std::exp(1.0) / WIDTH;
+    size_t violations = 0;
+    for(const auto& [key, f] : freq) {
+        const auto est = sketch.estimate(key);
+        const bool upper_bound = (est >= f);
+        ASSERT_TRUE(upper_bound);
+        if(est > f + eps * keys.size()) ++violations;
+    }
+    const bool few_violations = (violations <= freq.size() / 20);
+    ASSERT_TRUE(few_violations);
+}
+
+// counts a stream sequentially, in parallel, and by merging sketches of its halves
+void test_merge(const size_t n) {
+    const auto keys = stream(n);
+
+    Sketch sequential(FILTER, WIDTH, HEIGHT);
+    for(size_t i = 0; i < n; i++) sequential.count(keys[i], i);
+    check_estimates(sequential, keys);
+
+    Sketch left(FILTER, WIDTH, HEIGHT);
+    Sketch right(FILTER, WIDTH, HEIGHT);
+    for(size_t i = 0; i < n / 2; i++) left.count(keys[i], i);
+    for(size_t i = n / 2; i < n; i++) right.count(keys[i], i);
+    left.merge(right);
+    check_estimates(left, keys);
+
+    Sketch parallel(FILTER, WIDTH, HEIGHT);
+    parallel.count_parallel(n, [&](const size_t i){ return std::make_pair(keys[i], i); }, 4);
+    check_estimates(parallel, keys);
+
+    // the most frequent key must be frequent and associated with one of its occurrences
+    for(Sketch* sketch : { &sequential, &left, &parallel }) {
+        size_t value;
+        const bool frequent = sketch->is_frequent(0, value);
+        ASSERT_TRUE(frequent);
+        ASSERT_EQ(keys[value], Key(0));
+    }
+
+    // if it is frequent in every part, the value stems from its last occurrence, as if the stream had been counted sequentially
+    if(n >= 100000) {
+        size_t last = 0;
+        for(size_t i = 0; i < n; i++) if(keys[i] == 0) last = i;
+
+        size_t value;
+        parallel.is_frequent(0, value);
+        ASSERT_EQ(value, last);
+    }
+
+    // counting continues normally after merging
+    parallel.count(0, n);
+    size_t value;
+    parallel.is_frequent(0, value);
+    ASSERT_EQ(value, n);
+}
+
+void test_dimensions() {
+    Sketch a(FILTER, WIDTH, HEIGHT);
+    Sketch b(FILTER, WIDTH / 2, HEIGHT);
+
+    bool thrown = false;
+    try {
+        a.merge(b);
+    } catch(const std::invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT_TRUE(thrown);
+}
+
+int main(int argc, char** argv) {
+    test_merge(100000);
+    test_merge(1000);
+    test_dimensions();
+}
@@ -0,0 +1,164 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include <tdc/hash/bbhash.hpp>
+#include <tdc/io/mmap_file.hpp>
+#include <tdc/test/assert.hpp>
+
+using namespace tdc;
+
+std::vector<uint64_t> random_keys(const size_t n, const uint64_t universe, const uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    std::unordered_set<uint64_t> set;
+    while(set.size() < n) set.insert(universe ? gen() % universe : gen());
+    return std::vector<uint64_t>(set.begin(), set.end());
+}
+
+// the function must map the keys bijectively to [0, n)
+void check(const hash::BBHash& f, const std::vector<uint64_t>& keys) {
+    ASSERT_EQ(f.size(), keys.size());
+
+    std::vector<bool> hit(keys.size());
+    for(const uint64_t x : keys) {
+        const uint64_t v = f(x);
+        const bool in_range = v < keys.size();
+        ASSERT_TRUE(in_range);
+        ASSERT_FALSE(hit[v]);
+        hit[v] = true;
+    }
+}
+
+void test(const size_t n, const uint64_t universe, const double gamma, const size_t num_threads) {
+    const auto keys = random_keys(n, universe, n);
+    hash::BBHash f(keys.data(), keys.size(), gamma, num_threads);
+    check(f, keys);
+
+    // the result does not depend on the number of threads
+    hash::BBHash g(keys.data(), keys.size(), gamma, 1);
+    for(const uint64_t x : keys) ASSERT_EQ(f(x), g(x));
+}
+
+// with many threads, the number of keys remaining for the last levels drops below the number of threads
+void test_few_remaining(const size_t n, const size_t num_threads, const size_t num_seeds) {
+    for(uint64_t seed = 0; seed < num_seeds; seed++) {
+        const auto keys = random_keys(n, 0, seed);
+        hash::BBHash f(keys.data(), keys.size(), 2.0, num_threads);
+        check(f, keys);
+    }
+}
+
+// a header that claims more data than available must be rejected without overflowing or allocating its claimed size
+void test_corrupt_header(const hash::BBHash& f, const uint64_t num_words, const uint64_t num_fallback) {
+    hash::BBHash::Header header;
+    std::memcpy(&header, f.data(), sizeof(header));
+    header.num_words = num_words;
+    header.num_fallback = num_fallback;
+
+    std::vector<uint64_t> buffer(f.size_bytes() / sizeof(uint64_t));
+    std::memcpy(buffer.data(), f.data(), f.size_bytes());
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    bool thrown = false;
+    try {
+        hash::BBHash::view(buffer.data(), f.size_bytes());
+    } catch(const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT_TRUE(thrown);
+
+    thrown = false;
+    try {
+        std::stringstream ss(std::string((const char*)buffer.data(), f.size_bytes()));
+        hash::BBHash::read(ss);
+    } catch(const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT_TRUE(thrown);
+}
+
+void test_serialize() {
+    const auto keys = random_keys(100000, 0, 1);
+    hash::BBHash f(keys.data(), keys.size());
+
+    // stream
+    {
+        std::stringstream ss;
+        f.write(ss);
+        ASSERT_EQ(ss.str().size(), f.size_bytes());
+
+        auto g = hash::BBHash::read(ss);
+        for(const uint64_t x : keys) ASSERT_EQ(f(x), g(x));
+    }
+
+    // memory mapped file
+    {
+        // the build directory contains the test executable itself, so the file is written to the temporary directory
+        const std::string filename = (std::filesystem::temp_directory_path() / "tdc_test_bbhash.bin").string();
+        {
+            std::ofstream out(filename, std::ios::binary);
+            f.write(out);
+        }
+        {
+            io::MMapReadOnlyFile mapped(filename);
+            auto g = hash::BBHash::view(mapped.data(), mapped.size());
+            ASSERT_EQ(g.data(), mapped.data());
+            for(const uint64_t x : keys) ASSERT_EQ(f(x), g(x));
+        }
+        std::filesystem::remove(filename);
+    }
+
+    // truncated data
+    {
+        std::vector<uint64_t> buffer(f.size_bytes() / sizeof(uint64_t));
+        std::memcpy(buffer.data(), f.data(), f.size_bytes());
+
+        bool thrown = false;
+        try {
+            hash::BBHash::view(buffer.data(), f.size_bytes() - 8);
+        } catch(const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown);
+    }
+
+    // corrupt headers
+    test_corrupt_header(f, 1ULL << 62, 0);
+    test_corrupt_header(f, 0, (1ULL << 63) + 1);
+    test_corrupt_header(f, UINT64_MAX - 8, UINT64_MAX / 2);
+    test_corrupt_header(f, 1ULL << 30, 0);
+}
+
+void test_duplicates() {
+    std::vector<uint64_t> keys = random_keys(1000, 0, 2);
+    keys.push_back(keys[0]);
+
+    bool thrown = false;
+    try {
+        hash::BBHash f(keys.data(), keys.size());
+    } catch(const std::invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT_TRUE(thrown);
+}
+
+int main(int argc, char** argv) {
+    {
+        hash::BBHash f;
+        ASSERT_EQ(f.size(), size_t(0));
+    }
+    test(1, 0, 2.0, 1);
+    test(100, 0, 2.0, 1);
+    test(1000, 1000, 1.0, 2); // the keys form the entire universe
+    test(100000, 0, 1.0, 4);
+    test(1000000, 0, 2.0, 4);
+    test(1000000, 1ULL << 24, 5.0, 3);
+    test_few_remaining(2000, 8, 50);
+    test_serialize();
+    test_duplicates();
+}
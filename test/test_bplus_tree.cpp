@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <tdc/pred/dynamic/bplus_tree.hpp>
+#include <tdc/pred/dynamic/btree/dynamic_fusion_node.hpp>
+#include <tdc/pred/dynamic/btree/node_allocator.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// compares the contents, some queries and the leaf links against a std::set
+template<typename tree_t>
+void check(const tree_t& tree, const std::set<Key>& ref, const Key u, std::mt19937_64& gen) {
+#ifndef NDEBUG
+    tree.verify();
+#endif
+    ASSERT_EQ(tree.size(), ref.size());
+    ASSERT_TRUE(std::equal(tree.begin(), tree.end(), ref.begin(), ref.end()));
+
+    if(!ref.empty()) {
+        ASSERT_EQ(tree.min(), *ref.begin());
+        ASSERT_EQ(tree.max(), *ref.rbegin());
+
+        // walk backwards from the end
+        auto it = tree.lower_bound(*ref.rbegin());
+        for(auto rit = ref.rbegin(); rit != ref.rend(); ++rit) {
+            ASSERT_EQ(*it, *rit);
+            if(std::next(rit) != ref.rend()) --it;
+        }
+    }
+
+    for(size_t q = 0; q < 100; q++) {
+        const Key x = gen() % (u + 2);
+
+        auto it = ref.upper_bound(x);
+        auto r = tree.predecessor(x);
+        if(it != ref.begin()) {
+            ASSERT_TRUE(r.exists);
+            ASSERT_EQ(r.key, *std::prev(it));
+        } else {
+            ASSERT_FALSE(r.exists);
+        }
+
+        it = ref.lower_bound(x);
+        r = tree.successor(x);
+        if(it != ref.end()) {
+            ASSERT_TRUE(r.exists);
+            ASSERT_EQ(r.key, *it);
+            ASSERT_EQ(*tree.lower_bound(x), *it);
+        } else {
+            ASSERT_FALSE(r.exists);
+            ASSERT_EQ(tree.lower_bound(x), tree.end());
+        }
+
+        const Key y = x + gen() % (u / 16);
+        const size_t count = std::distance(ref.lower_bound(x), ref.upper_bound(y));
+        ASSERT_EQ(tree.count_range(x, y), count);
+    }
+}
+
+template<typename tree_t>
+void test(const Key u, const size_t num) {
+    std::mt19937_64 gen(num);
+
+    tree_t tree;
+    std::set<Key> ref;
+    check(tree, ref, u, gen);
+
+    // random insertions
+    while(ref.size() < num) {
+        const Key x = gen() % u;
+        if(ref.insert(x).second) tree.insert(x);
+    }
+    check(tree, ref, u, gen);
+
+    // mixed insertions and removals, including keys that are not contained
+    for(size_t i = 0; i < 2 * num; i++) {
+        const Key x = gen() % u;
+        if(gen() % 2) {
+            if(ref.insert(x).second) tree.insert(x);
+        } else {
+            ASSERT_EQ(tree.remove(x), (ref.erase(x) > 0));
+        }
+    }
+    check(tree, ref, u, gen);
+
+    // bulk load the current contents and remove everything in random order
+    {
+        std::vector<Key> keys(ref.begin(), ref.end());
+        tree.bulk_load(keys.data(), keys.size());
+        check(tree, ref, u, gen);
+
+        std::shuffle(keys.begin(), keys.end(), gen);
+        for(size_t i = 0; i < keys.size(); i++) {
+            ASSERT_TRUE(tree.remove(keys[i]));
+            ref.erase(keys[i]);
+            if(i % (keys.size() / 8 + 1) == 0) check(tree, ref, u, gen);
+        }
+    }
+    check(tree, ref, u, gen);
+    ASSERT_EQ(tree.height(), size_t(0));
+    ASSERT_FALSE(tree.remove(0));
+
+    // ascending insertions, then removals in ascending order
+    for(Key x = 0; x < num; x++) {
+        tree.insert(x);
+        ref.insert(x);
+    }
+    check(tree, ref, u, gen);
+    for(Key x = 0; x < num; x++) {
+        ASSERT_TRUE(tree.remove(x));
+        ref.erase(x);
+    }
+    check(tree, ref, u, gen);
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+
+    constexpr Key u = (1ULL << 24) - 1;
+    for(const size_t num : { 10, 1000, 100000 }) {
+        test<BPlusTree<Key, 4, SortedArrayNode<Key, 3>, 2>>(u, num);
+        test<BPlusTree<Key, 5, SortedArrayNode<Key, 4>, 3>>(u, num);
+        test<BPlusTree<Key, 9, SortedArrayNode<Key, 8>>>(u, num);
+        test<BPlusTree<Key, 9, DynamicFusionNode<Key, 8>, 64>>(u, num);
+        test<BPlusTree<Key, 17, SortedArrayNode<Key, 16>, 16, PoolNodeAllocator>>(u, num);
+        test<BPlusTree<Key, 65, SortedArrayNode<Key, 64, true>, 256>>(u, num);
+    }
+}
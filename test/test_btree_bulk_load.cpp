@@ -0,0 +1,102 @@
+#include <vector>
+
+#include <tdc/pred/dynamic/btree.hpp>
+#include <tdc/pred/dynamic/btree/btree_min_observer.hpp>
+#include <tdc/pred/dynamic/btree/dynamic_fusion_node.hpp>
+#include <tdc/pred/dynamic/btree/node_allocator.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+template<typename btree_t>
+void check_predecessors(const btree_t& btree, const std::vector<Key>& keys) {
+    ASSERT_EQ(btree.size(), keys.size());
+    
+    // keys are pairwise at least two apart, query the keys and their neighbours
+    for(size_t i = 0; i < keys.size(); i++) {
+        auto r = btree.predecessor(keys[i]);
+        ASSERT_TRUE(r.exists);
+        ASSERT_EQ(r.key, keys[i]);
+        
+        r = btree.predecessor(keys[i] + 1);
+        ASSERT_TRUE(r.exists);
+        ASSERT_EQ(r.key, keys[i]);
+        
+        r = btree.predecessor(keys[i] - 1);
+        if(i > 0) {
+            ASSERT_TRUE(r.exists);
+            ASSERT_EQ(r.key, keys[i-1]);
+        } else {
+            ASSERT_FALSE(r.exists);
+        }
+    }
+}
+
+template<typename btree_t>
+void test(const size_t num, const double fill_factor, const size_t num_threads) {
+    std::vector<Key> keys;
+    for(size_t i = 0; i < num; i++) keys.push_back(4 * (i + 1));
+    
+    btree_t btree;
+    btree.bulk_load(keys.data(), keys.size(), fill_factor, num_threads);
+#ifndef NDEBUG
+    btree.verify();
+#endif
+    check_predecessors(btree, keys);
+    
+    // the tree must remain fully functional
+    std::vector<Key> keys2;
+    for(size_t i = 0; i < num; i++) {
+        if(i % 2) {
+            btree.insert(keys[i] + 2);
+            keys2.push_back(keys[i]);
+            keys2.push_back(keys[i] + 2);
+        } else {
+            btree.remove(keys[i]);
+        }
+    }
+#ifndef NDEBUG
+    btree.verify();
+#endif
+    check_predecessors(btree, keys2);
+}
+
+template<typename btree_t>
+void test() {
+    for(const size_t num : { 0, 1, 2, 7, 8, 9, 10, 100, 1000, 12345 }) {
+        for(const double fill_factor : { 1.0, 0.75, 0.5, 0.1 }) {
+            for(const size_t num_threads : { 1, 4 }) {
+                test<btree_t>(num, fill_factor, num_threads);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+    
+    test<BTree<Key, 5, SortedArrayNode<Key, 4>>>();
+    test<BTree<Key, 9, SortedArrayNode<Key, 8>>>();
+    test<BTree<Key, 65, SortedArrayNode<Key, 64>>>();
+    test<BTree<Key, 9, DynamicFusionNode<Key, 8>>>();
+    test<BTree<Key, 17, DynamicFusionNode<Key, 16>>>();
+    test<BTree<Key, 33, DynamicFusionNode<Key, 32>>>();
+    test<BTree<Key, 9, DynamicFusionNode<Key, 8>, PoolNodeAllocator>>();
+    
+    // observers are notified about bulk loaded keys
+    {
+        using btree_t = BTree<Key, 9, SortedArrayNode<Key, 8>>;
+        btree_t btree;
+        BTreeMinObserver<btree_t> obs(btree);
+        btree.set_observer(&obs);
+        
+        std::vector<Key> keys;
+        for(Key x = 100; x < 1000; x++) keys.push_back(x);
+        btree.bulk_load(keys.data(), keys.size(), 0.5);
+        ASSERT_EQ(obs.min(), Key(100));
+        
+        btree.remove(100);
+        ASSERT_EQ(obs.min(), Key(101));
+    }
+}
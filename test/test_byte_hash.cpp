@@ -0,0 +1,84 @@
+#include <cstring>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <tdc/hash/crc32.hpp>
+#include <tdc/hash/mum64.hpp>
+#include <tdc/test/assert.hpp>
+
+using namespace tdc;
+
+const Byte* check_input = (const Byte*)"123456789";
+
+void test_crc32c(const std::vector<Byte>& buffer) {
+    using hash::CRC32C;
+
+    // standard check values
+    ASSERT_EQ(hash::CRC32()(check_input, 9), uint32_t(0xCBF43926));
+    ASSERT_EQ(CRC32C()(check_input, 9), uint32_t(0xE3069283));
+    ASSERT_EQ(CRC32C()(check_input, 0), uint32_t(0));
+
+    // all methods agree for all lengths and alignments
+    for(size_t n = 0; n < 10000; n += (n < 300) ? 1 : 37) {
+        for(size_t offs = 0; offs < 8; offs += 3) {
+            const Byte* s = buffer.data() + offs;
+            const uint32_t ref = CRC32C::update_table(0xFFFFFFFF, s, n);
+            ASSERT_EQ(CRC32C::update(0xFFFFFFFF, s, n), ref);
+            #ifdef __SSE4_2__
+            ASSERT_EQ(CRC32C::update_sse42(0xFFFFFFFF, s, n), ref);
+            ASSERT_EQ(CRC32C::update_interleaved(0xFFFFFFFF, s, n), ref);
+            #endif
+            #if defined(__SSE4_2__) && defined(__PCLMUL__)
+            ASSERT_EQ(CRC32C::update_pclmul(0xFFFFFFFF, s, n), ref);
+            #endif
+        }
+    }
+
+    // checksums can be extended
+    const uint32_t crc = CRC32C()(buffer.data(), buffer.size());
+    const uint32_t first = CRC32C()(buffer.data(), 1000);
+    ASSERT_EQ(~CRC32C::update(~first, buffer.data() + 1000, buffer.size() - 1000), crc);
+}
+
+void test_mum64(const std::vector<Byte>& buffer) {
+    const hash::Mum64 h;
+
+    // the hash value only depends on the contents
+    for(size_t n = 0; n < 200; n++) {
+        std::vector<Byte> copy(buffer.begin() + 1, buffer.begin() + 1 + n);
+        ASSERT_EQ(h(copy.data(), n), h(buffer.data() + 1, n));
+    }
+
+    // no collisions among prefixes, substrings and strings differing in a single bit
+    std::unordered_set<uint64_t> values;
+    size_t num = 0;
+    values.insert(h(buffer.data(), 0));
+    ++num;
+    for(size_t n = 1; n <= 1000; n++) {
+        values.insert(h(buffer.data(), n));
+        values.insert(h(buffer.data() + 1, n));
+        num += 2;
+    }
+    std::vector<Byte> s(buffer.begin(), buffer.begin() + 100);
+    for(size_t i = 0; i < 8 * s.size(); i++) {
+        s[i / 8] ^= Byte(1) << (i % 8);
+        values.insert(h(s.data(), s.size()));
+        ++num;
+        s[i / 8] ^= Byte(1) << (i % 8);
+    }
+    ASSERT_EQ(values.size(), num);
+
+    // seeds lead to different values
+    const hash::Mum64 g(1);
+    ASSERT_NEQ(h(buffer.data(), 100), g(buffer.data(), 100));
+}
+
+int main(int argc, char** argv) {
+    std::vector<Byte> buffer(20000);
+    std::mt19937 gen(1);
+    for(auto& b : buffer) b = Byte(gen());
+
+    test_crc32c(buffer);
+    test_mum64(buffer);
+}
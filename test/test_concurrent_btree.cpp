@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <tdc/pred/dynamic/concurrent_btree.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// stable keys are multiples of 4 and never removed, writers insert and remove keys of the form 4i+1 and 4i+2
+template<typename btree_t>
+void test(const size_t num_stable, const size_t num_writers, const size_t num_readers, const size_t num_updates) {
+    btree_t btree;
+
+    std::vector<Key> stable(num_stable);
+    for(size_t i = 0; i < num_stable; i++) stable[i] = 4 * (i + 1);
+
+    {
+        // insert stable keys concurrently in random order
+        std::vector<Key> perm(stable);
+        std::shuffle(perm.begin(), perm.end(), std::mt19937_64(num_stable));
+
+        std::vector<std::thread> threads;
+        for(size_t t = 0; t < num_writers; t++) {
+            threads.emplace_back([&, t](){
+                for(size_t i = t; i < perm.size(); i += num_writers) {
+                    ASSERT_TRUE(btree.insert(perm[i]));
+                }
+            });
+        }
+        for(auto& thread : threads) thread.join();
+    }
+    ASSERT_EQ(btree.size(), num_stable);
+
+    std::atomic<bool> done = false;
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < num_writers; t++) {
+        threads.emplace_back([&, t](){
+            // writers partition the keys by offset and stable interval, so no two writers touch the same key
+            const Key offs = 1 + (t % 2);
+            const size_t groups = (num_writers + 1) / 2;
+            std::mt19937_64 gen(t);
+            std::vector<Key> inserted;
+            for(size_t i = 0; i < num_updates; i++) {
+                if(inserted.empty() || gen() % 2) {
+                    const Key x = 4 * ((gen() % (num_stable / groups)) * groups + t / 2) + offs;
+                    if(std::find(inserted.begin(), inserted.end(), x) == inserted.end()) {
+                        ASSERT_TRUE(btree.insert(x));
+                        inserted.push_back(x);
+                    }
+                } else {
+                    const size_t j = gen() % inserted.size();
+                    ASSERT_TRUE(btree.remove(inserted[j]));
+                    inserted[j] = inserted.back();
+                    inserted.pop_back();
+                }
+            }
+            for(const Key x : inserted) ASSERT_TRUE(btree.remove(x));
+        });
+    }
+    for(size_t t = 0; t < num_readers; t++) {
+        threads.emplace_back([&, t](){
+            std::mt19937_64 gen(num_writers + t);
+            while(!done) {
+                const size_t i = gen() % num_stable;
+
+                auto r = btree.predecessor(stable[i]);
+                ASSERT_TRUE(r.exists);
+                ASSERT_EQ(r.key, stable[i]);
+
+                // the predecessor of 4i+3 is either the stable key 4i or a key inserted by a writer
+                r = btree.predecessor(stable[i] + 3);
+                const bool in_range = r.exists && r.key >= stable[i] && r.key <= stable[i] + 2;
+                ASSERT_TRUE(in_range);
+
+                r = btree.predecessor(stable[i] - 1);
+                const bool prev_in_range = (i == 0) ? (!r.exists || r.key < stable[0]) : (r.exists && r.key >= stable[i-1] && r.key <= stable[i-1] + 2);
+                ASSERT_TRUE(prev_in_range);
+            }
+        });
+    }
+    for(size_t t = 0; t < num_writers; t++) threads[t].join();
+    done = true;
+    for(size_t t = num_writers; t < threads.size(); t++) threads[t].join();
+
+    // only the stable keys remain
+    ASSERT_EQ(btree.size(), num_stable);
+    for(size_t i = 0; i < num_stable; i++) {
+        ASSERT_TRUE(btree.contains(stable[i]));
+        ASSERT_FALSE(btree.contains(stable[i] + 1));
+        ASSERT_FALSE(btree.contains(stable[i] + 2));
+    }
+    ASSERT_FALSE(btree.insert(stable[0]));
+    ASSERT_FALSE(btree.remove(stable[0] + 1));
+}
+
+// writers fill disjoint key ranges and empty them again, so whole leaves become empty while readers query predecessors
+template<typename btree_t>
+void test_empty_leaves(const size_t num_writers, const size_t num_readers, const size_t keys_per_writer, const size_t num_rounds) {
+    btree_t btree;
+
+    // a single stable key below all others, which is the predecessor of every key not inserted by a writer
+    const Key stable = 1;
+    btree.insert(stable);
+
+    std::atomic<bool> done = false;
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < num_writers; t++) {
+        threads.emplace_back([&, t](){
+            const Key base = 2 + t * keys_per_writer;
+            for(size_t r = 0; r < num_rounds; r++) {
+                for(size_t i = 0; i < keys_per_writer; i++) ASSERT_TRUE(btree.insert(base + i));
+                for(size_t i = 0; i < keys_per_writer; i++) ASSERT_TRUE(btree.remove(base + i));
+            }
+        });
+    }
+    for(size_t t = 0; t < num_readers; t++) {
+        threads.emplace_back([&, t](){
+            std::mt19937_64 gen(num_writers + t);
+            while(!done) {
+                const Key x = 2 + gen() % (num_writers * keys_per_writer);
+                const auto r = btree.predecessor(x);
+                const bool in_range = r.exists && r.key >= stable && r.key <= x;
+                ASSERT_TRUE(in_range);
+            }
+        });
+    }
+    for(size_t t = 0; t < num_writers; t++) threads[t].join();
+    done = true;
+    for(size_t t = num_writers; t < threads.size(); t++) threads[t].join();
+
+    ASSERT_EQ(btree.size(), size_t(1));
+    const auto r = btree.predecessor(std::numeric_limits<Key>::max());
+    ASSERT_TRUE(r.exists);
+    ASSERT_EQ(r.key, stable);
+
+    // empty leaves are unlinked unless they are the only child of their parent, so only a fraction of the leaves of the full tree remain
+    for(Key x = 2; x < 2 + num_writers * keys_per_writer; x++) btree.insert(x);
+    const size_t full_leaves = btree.num_leaves();
+    for(Key x = 2; x < 2 + num_writers * keys_per_writer; x++) btree.remove(x);
+    const bool few_leaves = 2 * btree.num_leaves() <= full_leaves;
+    ASSERT_TRUE(few_leaves);
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+
+    test<ConcurrentBTree<Key, 3>>(1000, 2, 2, 10000);
+    test<ConcurrentBTree<Key, 9>>(10000, 2, 2, 20000);
+    test<ConcurrentBTree<Key, 65>>(100000, 4, 4, 50000);
+
+    test_empty_leaves<ConcurrentBTree<Key, 9>>(4, 2, 5000, 5);
+    test_empty_leaves<ConcurrentBTree<Key, 65>>(4, 2, 50000, 3);
+}
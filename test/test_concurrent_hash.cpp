@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <tdc/hash/concurrent_table.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// every thread inserts all keys in a different random order, so every key must be inserted by exactly one thread
+// meanwhile, a reader looks up keys that have already been inserted by the thread that runs first
+template<bool t_growable>
+void test_set(const size_t num, const size_t num_threads, const size_t capacity) {
+    tdc::hash::ConcurrentTable<void, t_growable> table(capacity);
+
+    std::vector<Key> keys(num);
+    for(size_t i = 0; i < num; i++) keys[i] = (i * 0x9E3779B97F4A7C15ULL) >> 4;
+
+    std::atomic<size_t> num_inserted = 0;
+    std::atomic<size_t> progress = 0; // number of keys inserted in order by thread 0
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t](){
+            std::vector<Key> perm(keys);
+            if(t > 0) std::shuffle(perm.begin(), perm.end(), std::mt19937_64(t));
+
+            size_t inserted = 0;
+            for(size_t i = 0; i < num; i++) {
+                if(table.insert(perm[i])) ++inserted;
+                if(t == 0) progress.store(i + 1, std::memory_order_release);
+            }
+            num_inserted += inserted;
+        });
+    }
+    threads.emplace_back([&](){
+        std::mt19937_64 gen(num);
+        size_t p;
+        while((p = progress.load(std::memory_order_acquire)) < num) {
+            if(p > 0) ASSERT_TRUE(table.contains(keys[gen() % p]));
+        }
+    });
+    for(auto& thread : threads) thread.join();
+
+    ASSERT_EQ(num_inserted.load(), num);
+    ASSERT_EQ(table.size(), num);
+    for(size_t i = 0; i < num; i++) {
+        ASSERT_TRUE(table.contains(keys[i]));
+        ASSERT_FALSE(table.contains(keys[i] + 1));
+    }
+    ASSERT_FALSE(table.insert(keys[0]));
+}
+
+// threads insert disjoint key ranges into a map along with a value derived from the key
+void test_map(const size_t num, const size_t num_threads) {
+    tdc::hash::ConcurrentTable<uint64_t> table;
+
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t](){
+            for(Key x = t; x < num; x += num_threads) {
+                ASSERT_TRUE(table.insert(x, 3 * x + 1));
+
+                uint64_t v;
+                const bool found = table.find(x, v);
+                ASSERT_TRUE(found);
+                ASSERT_EQ(v, 3 * x + 1);
+            }
+        });
+    }
+    for(auto& thread : threads) thread.join();
+
+    ASSERT_EQ(table.size(), num);
+    for(Key x = 0; x < num; x++) {
+        uint64_t v;
+        const bool found = table.find(x, v);
+        ASSERT_TRUE(found);
+        ASSERT_EQ(v, 3 * x + 1);
+        ASSERT_FALSE(table.insert(x, 0));
+    }
+    uint64_t v;
+    const bool found = table.find(num, v);
+    ASSERT_FALSE(found);
+}
+
+void test_full() {
+    tdc::hash::ConcurrentTable<void, false> table(100, 1.0);
+    const size_t cap = table.capacity();
+    for(Key x = 0; x < cap; x++) ASSERT_TRUE(table.insert(x));
+
+    bool thrown = false;
+    try {
+        table.insert(cap);
+    } catch(const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT_TRUE(thrown);
+}
+
+int main(int argc, char** argv) {
+    test_set<true>(100000, 4, 0);
+    test_set<true>(200000, 2, 1000);
+    test_set<false>(100000, 4, 100000);
+    test_map(100000, 4);
+    test_full();
+}
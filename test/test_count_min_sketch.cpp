@@ -0,0 +1,58 @@
+#include <random>
+#include <unordered_map>
+
+#include <tdc/util/count_min_sketch.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// counts skewed random keys in a standard and a conservative sketch and compares the estimates against the true frequencies
+template<typename Counter>
+void test_estimates(const size_t width, const size_t height, const size_t num) {
+    tdc::CountMinSketch<Key, Counter> standard(width, height);
+    tdc::CountMinSketch<Key, Counter, true> conservative(width, height);
+    ASSERT_EQ(standard.height(), height);
+    ASSERT_EQ(standard.size_bytes(), standard.width() * height * sizeof(Counter));
+
+    std::unordered_map<Key, size_t> freq;
+    std::mt19937_64 gen(num);
+    for(size_t i = 0; i < num; i++) {
+        const Key key = (gen() % 64) * (gen() % 64) * 0x9E3779B97F4A7C15ULL;
+        ++freq[key];
+
+        const auto est_standard = standard.count_and_estimate(key, 1);
+        const auto est_conservative = conservative.count_and_estimate(key, 1);
+        ASSERT_EQ(est_standard, standard.estimate(key));
+        ASSERT_EQ(est_conservative, conservative.estimate(key));
+    }
+
+    for(const auto& [key, f] : freq) {
+        const auto est_standard = standard.estimate(key);
+        const auto est_conservative = conservative.estimate(key);
+        const bool no_underestimate = (est_conservative >= f);
+        const bool tighter = (est_conservative <= est_standard);
+        ASSERT_TRUE(no_underestimate);
+        ASSERT_TRUE(tighter);
+    }
+}
+
+// counters must saturate rather than overflow
+template<bool t_conservative>
+void test_saturation() {
+    tdc::CountMinSketch<Key, uint16_t, t_conservative> sketch(16, 3);
+    sketch.count(1, 60000);
+    ASSERT_EQ(sketch.estimate(1), 60000ULL);
+    sketch.count(1, 60000);
+    ASSERT_EQ(sketch.estimate(1), 65535ULL);
+    ASSERT_EQ(sketch.count_and_estimate(1, 1), 65535ULL);
+    sketch.count(2, 1ULL << 40);
+    ASSERT_EQ(sketch.estimate(2), 65535ULL);
+}
+
+int main(int argc, char** argv) {
+    test_estimates<uint64_t>(256, 3, 100000);
+    test_estimates<uint32_t>(1024, 9, 100000);
+    test_estimates<uint16_t>(64, 4, 10000);
+    test_saturation<false>();
+    test_saturation<true>();
+}
@@ -0,0 +1,173 @@
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <tdc/hash/batch.hpp>
+#include <tdc/hash/bijective.hpp>
+#include <tdc/hash/function.hpp>
+#include <tdc/hash/linear_probing.hpp>
+#include <tdc/hash/quadratic_probing.hpp>
+#include <tdc/hash/quotient_set.hpp>
+#include <tdc/hash/swiss_table.hpp>
+#include <tdc/hash/table.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// performs random insertions, lookups and deletions and compares against a std::unordered_set
+// keys are multiples of the given stride, so that weak hash functions produce many collisions
+template<typename table_t>
+void test(table_t table, const size_t num_ops, const Key universe, const Key stride) {
+    std::mt19937_64 gen(num_ops ^ universe);
+    std::unordered_set<Key> ref;
+
+    for(size_t i = 0; i < num_ops; i++) {
+        const Key x = (gen() % universe) * stride;
+        const auto op = gen() % 3;
+        if(op == 0) {
+            // hash::Table does not check for duplicates
+            if(!table.contains(x)) table.insert(x);
+            ref.insert(x);
+        } else if(op == 1) {
+            const bool erased = table.erase(x);
+            const bool ref_erased = ref.erase(x) > 0;
+            ASSERT_EQ(erased, ref_erased);
+        } else {
+            auto a = table.find(x);
+            const bool found = a.exists();
+            const bool ref_found = ref.contains(x);
+            ASSERT_EQ(found, ref_found);
+            if(found) {
+                const Key y = a.key();
+                ASSERT_EQ(y, x);
+            }
+        }
+        ASSERT_EQ(table.size(), ref.size());
+    }
+
+    // all remaining keys must be found
+    for(const Key x : ref) {
+        ASSERT_TRUE(table.contains(x));
+    }
+    const bool nonempty = (table.begin() != table.end());
+    ASSERT_EQ(nonempty, !ref.empty());
+
+    // batched lookups of contained and random keys
+    std::vector<Key> keys(ref.begin(), ref.end());
+    {
+        std::vector<Key> queries(keys);
+        for(size_t i = 0; i < 1000; i++) queries.push_back((gen() % universe) * stride);
+
+        std::vector<decltype(table.find(0))> results(queries.size());
+        tdc::hash::find_batch(table, queries.data(), queries.size(), results.data());
+        for(size_t i = 0; i < queries.size(); i++) {
+            const bool found = results[i].exists();
+            const bool ref_found = ref.contains(queries[i]);
+            ASSERT_EQ(found, ref_found);
+            if(found) {
+                const Key y = results[i].key();
+                ASSERT_EQ(y, queries[i]);
+            }
+        }
+    }
+
+    // erase everything
+    for(const Key x : keys) {
+        ASSERT_TRUE(table.erase(x));
+    }
+    ASSERT_EQ(table.size(), size_t(0));
+    const bool empty = (table.begin() == table.end());
+    ASSERT_TRUE(empty);
+}
+
+template<size_t group_size>
+void test_swiss() {
+    using namespace tdc::hash;
+
+    for(const Key universe : { 10ULL, 1000ULL, 100000ULL, 1ULL << 40 }) {
+        test(SwissTable<Key, KeyEntry<Key>, Multiplicative, LinearProbing<>, group_size>(), 200000, universe, 1);
+        test(SwissTable<Key, KeyEntry<Key>, Identity, LinearProbing<>, group_size>(), 200000, universe, 1024);
+        test(SwissTable<Key, KeyEntry<Key>, Multiplicative, LinearProbing<>, group_size>(Multiplicative(), 1000, 0.95), 200000, universe, 1);
+        test(SwissTable<Key, KeyEntry<Key>, Multiplicative, QuadraticProbing<>, group_size>(), 200000, universe, 1);
+    }
+}
+
+template<bool robin_hood>
+void test_table() {
+    using namespace tdc::hash;
+    using table_t = Table<Key, KeyEntry<Key>, robin_hood>;
+
+    // without Robin Hood insertion, lookups become slow after many erasures
+    const size_t num_ops = robin_hood ? 200000 : 20000;
+    for(const Key universe : { 10ULL, 1000ULL, 100000ULL, 1ULL << 40 }) {
+        test(table_t(Multiplicative(), 16), num_ops, universe, 1);
+        test(table_t(Identity(), 1000, 0.95), num_ops, universe, 1000);
+        test(table_t(Multiplicative(), 1000, 1.0), num_ops, universe, 1);
+    }
+}
+
+void test_bijective() {
+    using namespace tdc::hash;
+
+    // small universes are permuted completely
+    for(size_t bits = 1; bits <= 12; bits++) {
+        MultiplyXorShift h(bits, bits);
+        std::vector<bool> hit(1ULL << bits);
+        for(uint64_t x = 0; x < (1ULL << bits); x++) {
+            const uint64_t y = h(x);
+            const bool in_universe = y < (1ULL << bits);
+            ASSERT_TRUE(in_universe);
+            ASSERT_FALSE(hit[y]);
+            hit[y] = true;
+            ASSERT_EQ(h.inverse(y), x);
+        }
+    }
+
+    std::mt19937_64 gen(64);
+    for(size_t bits = 13; bits <= 64; bits++) {
+        MultiplyXorShift h(bits);
+        for(size_t i = 0; i < 10000; i++) {
+            const uint64_t x = (bits == 64) ? gen() : gen() % (1ULL << bits);
+            ASSERT_EQ(h.inverse(h(x)), x);
+        }
+    }
+}
+
+template<size_t disp_bits>
+void test_quotient() {
+    using namespace tdc::hash;
+    using set_t = QuotientSet<disp_bits>;
+
+    for(const Key universe : { 10ULL, 1000ULL, 100000ULL, 1ULL << 40 }) {
+        test(set_t(), 200000, universe, 1);
+        test(set_t(41, 1000), 200000, universe, 1);
+        test(set_t(64, 1000, 0.95), 200000, universe, 1000);
+    }
+    test(set_t(10, 0, 0.99), 200000, 1024, 1); // the table covers the whole universe
+
+    // all keys are restored
+    set_t set(32, 0);
+    std::unordered_set<Key> ref;
+    std::mt19937_64 gen(32);
+    for(size_t i = 0; i < 100000; i++) {
+        const Key x = gen() & UINT32_MAX;
+        set.insert(x);
+        ref.insert(x);
+    }
+    size_t num = 0;
+    set.for_each([&](const Key x){
+        ASSERT_TRUE(ref.contains(x));
+        ++num;
+    });
+    ASSERT_EQ(num, ref.size());
+}
+
+int main(int argc, char** argv) {
+    test_bijective();
+    test_quotient<2>();
+    test_quotient<4>();
+    test_table<false>();
+    test_table<true>();
+    test_swiss<16>();
+    test_swiss<32>();
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <tdc/pred/dynamic/adaptive.hpp>
+#include <tdc/pred/dynamic/btree.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/pred/dynamic/dynamic_index.hpp>
+#include <tdc/pred/dynamic/yfast.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// compares queries against a std::set
+template<typename ds_t>
+void check(const ds_t& ds, const std::set<Key>& ref, const Key u, std::mt19937_64& gen) {
+    ASSERT_EQ(ds.size(), ref.size());
+
+    for(size_t q = 0; q < 200; q++) {
+        const Key x = gen() % u;
+
+        auto it = ref.upper_bound(x);
+        auto r = ds.predecessor(x);
+        const bool has_pred = (it != ref.begin());
+        ASSERT_EQ(r.exists, has_pred);
+        if(has_pred) ASSERT_EQ(r.key, *std::prev(it));
+
+        it = ref.lower_bound(x);
+        r = ds.successor(x);
+        const bool has_succ = (it != ref.end());
+        ASSERT_EQ(r.exists, has_succ);
+        if(has_succ) ASSERT_EQ(r.key, *it);
+
+        const Key y = x + gen() % (u / 64);
+        ASSERT_EQ(ds.count_range(x, y), (size_t)std::distance(ref.lower_bound(x), ref.upper_bound(y)));
+    }
+}
+
+template<typename ds_t>
+void insert_random(ds_t& ds, std::set<Key>& ref, const Key lo, const Key hi, const size_t num, std::mt19937_64& gen) {
+    for(size_t i = 0; i < num;) {
+        const Key x = lo + gen() % (hi - lo);
+        if(ref.insert(x).second) {
+            ds.insert(x);
+            ++i;
+        }
+    }
+}
+
+template<typename ds_t>
+void remove_range(ds_t& ds, std::set<Key>& ref, const Key lo, const Key hi, std::mt19937_64& gen) {
+    std::vector<Key> keys(ref.lower_bound(lo), ref.lower_bound(hi));
+    std::shuffle(keys.begin(), keys.end(), gen);
+    for(size_t i = 0; i < keys.size(); i++) {
+        ds.remove(keys[i]);
+        ref.erase(keys[i]);
+        if(i % 4096 == 0) check(ds, ref, hi, gen);
+    }
+}
+
+// drifts between sparse and dense key sets
+template<typename ds_t>
+void test(const size_t num) {
+    constexpr Key u_dense = 1ULL << 20;
+    constexpr Key u_sparse = 1ULL << 40;
+
+    std::mt19937_64 gen(num);
+    ds_t ds;
+    std::set<Key> ref;
+
+    // sparse keys spread over a large universe
+    insert_random(ds, ref, u_dense, u_sparse, num / 16, gen);
+    check(ds, ref, u_sparse, gen);
+    ASSERT_FALSE(ds.is_dense());
+
+    // add dense keys, then remove the sparse ones so that the span shrinks
+    insert_random(ds, ref, 0, u_dense, num, gen);
+    check(ds, ref, u_sparse, gen);
+    remove_range(ds, ref, u_dense, u_sparse, gen);
+    insert_random(ds, ref, 0, u_dense, num / 16, gen);
+    check(ds, ref, u_dense, gen);
+    ASSERT_TRUE(ds.is_dense());
+    ASSERT_EQ(ds.num_migrations(), size_t(1));
+
+    // thin out the dense keys and add sparse ones again
+    remove_range(ds, ref, 0, u_dense - u_dense / 64, gen);
+    insert_random(ds, ref, u_dense, u_sparse, num / 16, gen);
+    check(ds, ref, u_sparse, gen);
+    ASSERT_FALSE(ds.is_dense());
+    ASSERT_EQ(ds.num_migrations(), size_t(2));
+
+    ds.finish_migration();
+    ASSERT_FALSE(ds.is_migrating());
+    check(ds, ref, u_sparse, gen);
+
+    remove_range(ds, ref, 0, u_sparse, gen);
+    check(ds, ref, u_sparse, gen);
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+
+    using btree_t = BTree<Key, 65, SortedArrayNode<Key, 64>>;
+    using yfast_t = YFastTrie<yfast_bucket<Key, 6>, 64>;
+    using index_t = DynIndex<Key, 12, bucket_bv<Key, 12>, paged_top<bucket_bv<Key, 12>, 4>>;
+    using index_hybrid_t = DynIndex<Key, 14, bucket_hybrid<Key, 14, 255>, paged_top<bucket_hybrid<Key, 14, 255>, 4>>;
+
+    for(const size_t num : { 50000, 200000 }) {
+        test<Adaptive<btree_t, index_t>>(num);
+        test<Adaptive<btree_t, index_hybrid_t, 256, 1>>(num);
+        test<Adaptive<yfast_t, index_t, 64>>(num);
+    }
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <tdc/pred/dynamic/btree.hpp>
+#include <tdc/pred/dynamic/btree/btree_min_observer.hpp>
+#include <tdc/pred/dynamic/btree/dynamic_fusion_node.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/pred/dynamic/dynamic_index.hpp>
+#include <tdc/pred/dynamic/yfast.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// compares the contents and some predecessor queries against a std::set
+template<typename ds_t>
+void check(const ds_t& ds, const std::set<Key>& ref, const Key u, std::mt19937_64& gen) {
+    ASSERT_EQ(ds.size(), ref.size());
+    ASSERT_TRUE(std::equal(ds.begin(), ds.end(), ref.begin(), ref.end()));
+
+    for(size_t q = 0; q < 100; q++) {
+        const Key x = gen() % (u + 2);
+        auto it = ref.upper_bound(x);
+        if(it != ref.begin()) {
+            auto r = ds.predecessor(x);
+            ASSERT_TRUE(r.exists);
+            ASSERT_EQ(r.key, *(--it));
+        }
+    }
+}
+
+template<typename ds_t>
+void test(const Key u, const size_t num_batches, const size_t batch_size) {
+    std::mt19937_64 gen(batch_size);
+
+    ds_t ds;
+    std::set<Key> ref;
+
+    for(size_t b = 0; b < num_batches; b++) {
+        // insert a batch of new keys, in random order
+        std::vector<Key> batch;
+        while(batch.size() < batch_size) {
+            const Key x = 1 + gen() % u;
+            if(ref.insert(x).second) batch.push_back(x);
+        }
+        ds.insert_batch(batch.data(), batch.size());
+        check(ds, ref, u, gen);
+
+        // remove a batch of random contained keys, alternating between small and large batches
+        std::vector<Key> keys(ref.begin(), ref.end());
+        std::shuffle(keys.begin(), keys.end(), gen);
+        keys.resize((b % 2) ? keys.size() / 2 : batch_size / 4);
+        ds.remove_batch(keys.data(), keys.size());
+        for(const Key x : keys) ref.erase(x);
+        check(ds, ref, u, gen);
+    }
+
+    // remove everything
+    std::vector<Key> keys(ref.begin(), ref.end());
+    std::shuffle(keys.begin(), keys.end(), gen);
+    ds.remove_batch(keys.data(), keys.size());
+    ref.clear();
+    check(ds, ref, u, gen);
+}
+
+template<typename btree_t>
+void test_observer(const Key u, const size_t batch_size) {
+    std::mt19937_64 gen(batch_size);
+
+    btree_t btree;
+    tdc::pred::dynamic::BTreeMinObserver<btree_t> obs(btree);
+    btree.set_observer(&obs);
+
+    std::set<Key> ref;
+    for(size_t b = 0; b < 8; b++) {
+        std::vector<Key> batch;
+        while(batch.size() < batch_size) {
+            const Key x = 1 + gen() % u;
+            if(ref.insert(x).second) batch.push_back(x);
+        }
+        btree.insert_batch(batch.data(), batch.size());
+        ASSERT_EQ(obs.min(), *ref.begin());
+
+        std::vector<Key> keys(ref.begin(), std::next(ref.begin(), batch_size / 2));
+        btree.remove_batch(keys.data(), keys.size());
+        for(const Key x : keys) ref.erase(x);
+        ASSERT_EQ(obs.min(), *ref.begin());
+    }
+#ifndef NDEBUG
+    btree.verify();
+#endif
+}
+
+// records whether every inserted key is reported with the node that holds it
+template<typename btree_t>
+class HolderObserver : public btree_t::Observer {
+public:
+    using btree_key_t = btree_t::Observer::btree_key_t;
+    using btree_node_t = btree_t::Observer::btree_node_t;
+
+    size_t num_inserted = 0;
+    bool holders_correct = true;
+
+    virtual void key_inserted(const btree_key_t& key, const btree_node_t& node) override {
+        ++num_inserted;
+        const auto& impl = node.impl();
+        bool held = false;
+        for(size_t i = 0; i < node.size(); i++) held = held || (impl[i] == key);
+        holders_correct = holders_correct && held;
+    }
+};
+
+template<typename btree_t>
+void test_observer_holder(const Key u, const size_t batch_size) {
+    std::mt19937_64 gen(batch_size);
+
+    btree_t btree;
+    HolderObserver<btree_t> obs;
+    btree.set_observer(&obs);
+
+    // every batch after the first splits leaves, moving keys to new siblings and up into inner nodes
+    std::set<Key> ref;
+    for(size_t b = 0; b < 8; b++) {
+        std::vector<Key> batch;
+        while(batch.size() < batch_size) {
+            const Key x = 1 + gen() % u;
+            if(ref.insert(x).second) batch.push_back(x);
+        }
+        btree.insert_batch(batch.data(), batch.size());
+        ASSERT_EQ(obs.num_inserted, ref.size());
+        ASSERT_TRUE(obs.holders_correct);
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+
+    constexpr Key u = (1ULL << 24) - 1;
+    for(const size_t batch_size : { 1, 10, 1000, 10000 }) {
+        test<BTree<Key, 9, SortedArrayNode<Key, 8>>>(u, 8, batch_size);
+        test<BTree<Key, 65, SortedArrayNode<Key, 64, true>>>(u, 8, batch_size);
+        test<BTree<Key, 9, DynamicFusionNode<Key, 8>>>(u, 8, batch_size);
+        test<YFastTrie<yfast_bucket<Key, 4>, 64>>(u, 8, batch_size);
+        test<YFastTrie<yfast_bucket_sl<Key, 4>, 64>>(u, 8, batch_size);
+        test<YFastTrie<yfast_bucket<Key, 4>, 64, xfast_compact_table>>(u, 8, batch_size);
+        test<DynIndex<Key, 10, bucket_list<Key, 10>>>(u, 8, batch_size);
+        test<DynIndex<Key, 12, bucket_bv<Key, 12>>>(u, 8, batch_size);
+        test<DynIndex<Key, 12, bucket_hybrid<Key, 12, 63>>>(u, 8, batch_size);
+        test<DynIndex<Key, 10, bucket_list<Key, 10>, paged_top<bucket_list<Key, 10>, 4>>>(u, 8, batch_size);
+        test<DynIndex<Key, 12, bucket_hybrid<Key, 12, 63>, paged_top<bucket_hybrid<Key, 12, 63>, 2>>>(u, 8, batch_size);
+        test_observer<BTree<Key, 9, SortedArrayNode<Key, 8>>>(u, batch_size + 1);
+        test_observer_holder<BTree<Key, 9, SortedArrayNode<Key, 8>>>(u, batch_size);
+    }
+}
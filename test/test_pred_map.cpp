@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <tdc/pred/dynamic/bplus_tree.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/pred/dynamic/buckets/buckets.hpp>
+#include <tdc/pred/dynamic/dynamic_index.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+using Value = uint32_t;
+
+// compares predecessor and successor entries and value lookups against a std::map
+template<typename ds_t>
+void check(ds_t& ds, const std::map<Key, Value>& ref, const Key u, std::mt19937_64& gen) {
+    ASSERT_EQ(ds.size(), ref.size());
+
+    for(size_t q = 0; q < 200; q++) {
+        const Key x = gen() % (u + 2);
+
+        auto it = ref.upper_bound(x);
+        auto r = ds.predecessor_entry(x);
+        const bool has_pred = (it != ref.begin());
+        ASSERT_EQ(r.exists, has_pred);
+        if(has_pred) {
+            --it;
+            ASSERT_EQ(r.key, it->first);
+            ASSERT_EQ(r.value, it->second);
+        }
+
+        it = ref.lower_bound(x);
+        r = ds.successor_entry(x);
+        const bool has_succ = (it != ref.end());
+        ASSERT_EQ(r.exists, has_succ);
+        if(has_succ) {
+            ASSERT_EQ(r.key, it->first);
+            ASSERT_EQ(r.value, it->second);
+        }
+
+        it = ref.find(x);
+        const Value* v = ds.find(x);
+        const bool found = (v != nullptr);
+        const bool contained = (it != ref.end());
+        ASSERT_EQ(found, contained);
+        if(found) ASSERT_EQ(*v, it->second);
+    }
+}
+
+template<typename ds_t>
+void test(const Key u, const size_t num) {
+    std::mt19937_64 gen(num);
+
+    ds_t ds;
+    std::map<Key, Value> ref;
+    check(ds, ref, u, gen);
+
+    // random insertions
+    while(ref.size() < num) {
+        const Key x = gen() % u;
+        const Value v = gen();
+        if(ref.emplace(x, v).second) ds.insert(x, v);
+    }
+    check(ds, ref, u, gen);
+
+    // update some values in place
+    for(auto& e : ref) {
+        if(gen() % 4 == 0) {
+            e.second = gen();
+            *ds.find(e.first) = e.second;
+        }
+    }
+    check(ds, ref, u, gen);
+
+    // remove in random order
+    std::vector<Key> keys;
+    for(const auto& e : ref) keys.push_back(e.first);
+    std::shuffle(keys.begin(), keys.end(), gen);
+    for(size_t i = 0; i < keys.size(); i++) {
+        ds.remove(keys[i]);
+        ref.erase(keys[i]);
+        if(i % 1024 == 0) check(ds, ref, u, gen);
+    }
+    check(ds, ref, u, gen);
+}
+
+// tests bulk loading and iteration over entries
+template<typename tree_t>
+void test_bulk_load(const Key u, const size_t num) {
+    std::mt19937_64 gen(num);
+
+    std::map<Key, Value> ref;
+    while(ref.size() < num) ref.emplace(gen() % u, gen());
+
+    std::vector<Key> keys;
+    std::vector<Value> values;
+    for(const auto& e : ref) {
+        keys.push_back(e.first);
+        values.push_back(e.second);
+    }
+
+    tree_t tree;
+    tree.bulk_load(keys.data(), values.data(), keys.size());
+    check(tree, ref, u, gen);
+
+    auto it = tree.begin();
+    for(const auto& e : ref) {
+        ASSERT_EQ(*it, e.first);
+        ASSERT_EQ(it.value(), e.second);
+        ++it;
+    }
+    ASSERT_EQ(it, tree.end());
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+
+    constexpr Key u = (1ULL << 24) - 1;
+    for(const size_t num : { 10, 1000, 10000 }) {
+        test<BPlusTreeMap<Key, Value, 5, SortedArrayNode<Key, 4>, 3>>(u, num);
+        test<BPlusTreeMap<Key, Value, 65, SortedArrayNode<Key, 64, true>, 64>>(u, num);
+        test<DynIndex<Key, 10, bucket_list_kv<Key, 10, Value>>>(u, num);
+        test<DynIndex<Key, 12, bucket_list_kv<Key, 12, Value>, paged_top<bucket_list_kv<Key, 12, Value>, 4>>>(u, num);
+        test_bulk_load<BPlusTreeMap<Key, Value, 9, SortedArrayNode<Key, 8>>>(u, num);
+    }
+}
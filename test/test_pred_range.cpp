@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <tdc/pred/dynamic/btree.hpp>
+#include <tdc/pred/dynamic/btree/dynamic_fusion_node.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/pred/dynamic/dynamic_index.hpp>
+#include <tdc/pred/dynamic/dynamic_index_map.hpp>
+#include <tdc/pred/dynamic/yfast.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// compares successor queries, iteration and range counts against a std::set
+template<typename ds_t>
+void check_ranges(const ds_t& ds, const std::set<Key>& ref, const Key u, std::mt19937_64& gen) {
+    ASSERT_EQ(ds.size(), ref.size());
+
+    for(size_t q = 0; q < 200; q++) {
+        const Key a = gen() % (u + 2);
+        const Key b = a + gen() % (u / 64 + 1);
+
+        auto it = ref.lower_bound(a);
+        auto r = ds.successor(a);
+        const bool exists = (it != ref.end());
+        ASSERT_EQ(r.exists, exists);
+        if(r.exists) ASSERT_EQ(r.key, *it);
+
+        ASSERT_EQ(ds.count_range(a, b), (size_t)std::distance(ref.lower_bound(a), ref.upper_bound(b)));
+        ASSERT_EQ(ds.count_range(b + 1, a), size_t(0));
+
+        // short ranges within a single bucket
+        const Key c = a + gen() % 100;
+        ASSERT_EQ(ds.count_range(a, c), (size_t)std::distance(ref.lower_bound(a), ref.upper_bound(c)));
+
+        // iterate a few keys
+        auto ds_it = ds.lower_bound(a);
+        for(size_t i = 0; i < 16 && it != ref.end(); i++, ++it, ++ds_it) {
+            ASSERT_NEQ(ds_it, ds.end());
+            ASSERT_EQ(*ds_it, *it);
+        }
+        if(it == ref.end()) ASSERT_EQ(ds_it, ds.end());
+    }
+
+    // full iteration
+    ASSERT_TRUE(std::equal(ds.begin(), ds.end(), ref.begin(), ref.end()));
+}
+
+template<typename ds_t>
+void test(const Key u, const size_t num) {
+    std::mt19937_64 gen(num);
+
+    ds_t ds;
+    std::set<Key> ref;
+    check_ranges(ds, ref, u, gen);
+
+    // insert
+    for(size_t i = 0; i < num; i++) {
+        const Key x = 1 + gen() % u;
+        if(ref.insert(x).second) ds.insert(x);
+        if(i % 1024 == 0) check_ranges(ds, ref, u, gen);
+    }
+    check_ranges(ds, ref, u, gen);
+
+    // remove in random order
+    std::vector<Key> keys(ref.begin(), ref.end());
+    std::shuffle(keys.begin(), keys.end(), gen);
+    for(size_t i = 0; i < keys.size(); i++) {
+        ds.remove(keys[i]);
+        ref.erase(keys[i]);
+        if(i % 1024 == 0) check_ranges(ds, ref, u, gen);
+    }
+    check_ranges(ds, ref, u, gen);
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+
+    constexpr Key u = (1ULL << 24) - 1;
+    for(const size_t num : { 10, 1000, 10000 }) {
+        test<BTree<Key, 9, SortedArrayNode<Key, 8>>>(u, num);
+        test<BTree<Key, 65, SortedArrayNode<Key, 64, true>>>(u, num);
+        test<BTree<Key, 9, DynamicFusionNode<Key, 8>>>(u, num);
+        test<BTree<Key, 17, DynamicFusionNode<Key, 16>>>(u, num);
+        test<BTree<Key, 33, DynamicFusionNode<Key, 32>>>(u, num);
+        test<YFastTrie<yfast_bucket<Key, 4>, 64>>(u, num);
+        test<YFastTrie<yfast_bucket_sl<Key, 4>, 64>>(u, num);
+        test<YFastTrie<yfast_bucket<Key, 4>, 64, xfast_compact_table>>(u, num);
+        test<YFastTrie<yfast_bucket_sl<Key, 4>, 64, xfast_compact_table>>(u, num);
+        test<DynIndex<Key, 10, bucket_list<Key, 10>>>(u, num);
+        test<DynIndex<Key, 12, bucket_bv<Key, 12>>>(u, num);
+        test<DynIndex<Key, 12, bucket_hybrid<Key, 12, 63>>>(u, num);
+        test<DynIndex<Key, 10, bucket_list<Key, 10>, paged_top<bucket_list<Key, 10>, 4>>>(u, num);
+        test<DynIndex<Key, 12, bucket_hybrid<Key, 12, 63>, paged_top<bucket_hybrid<Key, 12, 63>, 2>>>(u, num);
+        test<DynIndexMap<Key, 10, map_bucket_slist<Key, 10>>>(u, num);
+        test<DynIndexMap<Key, 12, map_bucket_bv<Key, 12>>>(u, num);
+        test<DynIndexMap<Key, 12, map_bucket_hybrid<Key, 12, 63>>>(u, num);
+    }
+}
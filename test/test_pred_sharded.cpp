@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <tdc/pred/dynamic/btree.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/pred/dynamic/dynamic_index.hpp>
+#include <tdc/pred/dynamic/sharded.hpp>
+#include <tdc/pred/dynamic/yfast.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// compares predecessor queries and range counts against a std::set
+template<typename ds_t>
+void check(const ds_t& ds, const std::set<Key>& ref, std::mt19937_64& gen) {
+    ASSERT_EQ(ds.size(), ref.size());
+
+    for(size_t q = 0; q < 200; q++) {
+        // also query the keys themselves and their neighbours
+        Key x = gen();
+        if(!ref.empty() && q % 2 == 0) {
+            auto it = ref.lower_bound(x);
+            if(it == ref.end()) --it;
+            x = *it + (q % 3) - 1;
+        }
+
+        auto it = ref.upper_bound(x);
+        auto r = ds.predecessor(x);
+        const bool exists = (it != ref.begin());
+        ASSERT_EQ(r.exists, exists);
+        if(exists) ASSERT_EQ(r.key, *std::prev(it));
+
+        const Key y = x + (gen() >> 4);
+        if(y >= x) {
+            ASSERT_EQ(ds.count_range(x, y), (size_t)std::distance(ref.lower_bound(x), ref.upper_bound(y)));
+        }
+    }
+}
+
+template<typename ds_t>
+void test(const size_t num) {
+    std::mt19937_64 gen(num);
+
+    ds_t ds;
+    std::set<Key> ref;
+    check(ds, ref, gen);
+
+    // random insertions, most shards remain empty for small inputs
+    while(ref.size() < num) {
+        const Key x = gen();
+        if(ref.insert(x).second) ds.insert(x);
+    }
+    check(ds, ref, gen);
+
+    // remove in random order, emptying shards
+    std::vector<Key> keys(ref.begin(), ref.end());
+    std::shuffle(keys.begin(), keys.end(), gen);
+    for(size_t i = 0; i < keys.size(); i++) {
+        ds.remove(keys[i]);
+        ref.erase(keys[i]);
+        if(i % 256 == 0) check(ds, ref, gen);
+    }
+    check(ds, ref, gen);
+}
+
+// concurrent insertions, queries and removals of disjoint key sets
+template<typename ds_t>
+void test_mt(const size_t num_threads, const size_t num_per_thread) {
+    std::mt19937_64 gen(num_threads);
+    std::set<Key> all;
+    while(all.size() < num_threads * num_per_thread) all.insert(gen());
+
+    std::vector<std::vector<Key>> keys(num_threads);
+    {
+        size_t i = 0;
+        for(const Key x : all) keys[i++ % num_threads].push_back(x);
+    }
+
+    ds_t ds;
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t](){
+            // there is always a predecessor for the thread's own keys after they have been inserted
+            for(const Key x : keys[t]) ds.insert(x);
+            for(const Key x : keys[t]) {
+                const auto r = ds.predecessor(x);
+                ASSERT_TRUE(r.exists);
+                ASSERT_EQ(r.key, x);
+            }
+            // remove every other key
+            for(size_t i = 0; i < keys[t].size(); i += 2) ds.remove(keys[t][i]);
+        });
+    }
+    for(auto& thread : threads) thread.join();
+
+    std::set<Key> ref;
+    for(size_t t = 0; t < num_threads; t++) {
+        for(size_t i = 1; i < keys[t].size(); i += 2) ref.insert(keys[t][i]);
+    }
+    check(ds, ref, gen);
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+
+    using btree_t = BTree<Key, 65, SortedArrayNode<Key, 64>>;
+    using index_t = DynIndex<Key, 16, bucket_list<Key, 16>, paged_top<bucket_list<Key, 16>, 4>>;
+    using yfast_t = YFastTrie<yfast_bucket<Key, 4>, 64>;
+
+    for(const size_t num : { 10, 1000, 10000 }) {
+        test<Sharded<Key, btree_t, 1>>(num);
+        test<Sharded<Key, btree_t, 6>>(num);
+        test<Sharded<Key, btree_t, 8, std::mutex>>(num);
+        test<Sharded<Key, index_t, 6>>(num);
+        test<Sharded<Key, yfast_t, 6>>(num);
+    }
+
+    for(const size_t num_threads : { 2, 4, 8 }) {
+        test_mt<Sharded<Key, btree_t, 6>>(num_threads, 10000);
+        test_mt<Sharded<Key, index_t, 4>>(num_threads, 10000);
+    }
+}
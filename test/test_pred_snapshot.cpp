@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <tdc/pred/dynamic/btree.hpp>
+#include <tdc/pred/dynamic/btree/dynamic_fusion_node.hpp>
+#include <tdc/pred/dynamic/btree/sorted_array_node.hpp>
+#include <tdc/pred/dynamic/dynamic_index.hpp>
+#include <tdc/pred/dynamic/yfast.hpp>
+#include <tdc/test/assert.hpp>
+
+using Key = uint64_t;
+
+// compares predecessor queries and iteration against a std::set
+template<typename ds_t>
+void check(const ds_t& ds, const std::set<Key>& ref, const Key u, std::mt19937_64& gen) {
+    ASSERT_EQ(ds.size(), ref.size());
+    ASSERT_TRUE(std::equal(ds.begin(), ds.end(), ref.begin(), ref.end()));
+
+    if(ref.empty()) return;
+    for(size_t q = 0; q < 1000; q++) {
+        const Key x = gen() % (u + 1);
+        auto it = ref.upper_bound(x);
+        if(it != ref.begin()) {
+            const auto r = ds.predecessor(x);
+            ASSERT_TRUE(r.exists);
+            ASSERT_EQ(Key(r.key), *std::prev(it));
+        }
+    }
+}
+
+// restores a snapshot from a stream and from memory, and continues to update the restored data structures
+template<typename ds_t>
+void test(const Key u, const size_t num) {
+    std::mt19937_64 gen(num);
+
+    std::set<Key> ref;
+    ds_t ds;
+    while(ref.size() < num) {
+        const Key x = gen() % (u + 1);
+        if(ref.insert(x).second) ds.insert(x);
+    }
+
+    std::stringstream ss;
+    ds.snapshot(ss);
+    const std::string data = ss.str();
+    ASSERT_EQ(data.size(), sizeof(tdc::pred::dynamic::snapshot::Header) + num * sizeof(Key));
+
+    ds_t from_stream;
+    from_stream.restore(ss);
+    check(from_stream, ref, u, gen);
+
+    ds_t from_memory;
+    from_memory.restore(data.data(), data.size());
+    check(from_memory, ref, u, gen);
+
+    // the restored data structure must support further updates
+    {
+        std::vector<Key> keys(ref.begin(), ref.end());
+        std::shuffle(keys.begin(), keys.end(), gen);
+        for(size_t i = 0; i < num / 2; i++) {
+            from_memory.remove(keys[i]);
+            ref.erase(keys[i]);
+        }
+    }
+    for(size_t i = 0; i < num / 2; i++) {
+        const Key x = gen() % (u + 1);
+        if(ref.insert(x).second) from_memory.insert(x);
+    }
+    check(from_memory, ref, u, gen);
+}
+
+// corrupted or truncated snapshots are rejected
+template<typename ds_t>
+void test_invalid() {
+    ds_t ds;
+    for(Key x = 1; x <= 100; x++) ds.insert(x * 7);
+
+    std::stringstream ss;
+    ds.snapshot(ss);
+    const std::string data = ss.str();
+
+    auto rejects = [](const std::string& s){
+        bool from_memory = false, from_stream = false;
+        try {
+            ds_t restored;
+            restored.restore(s.data(), s.size());
+        } catch(const std::runtime_error&) {
+            from_memory = true;
+        }
+        try {
+            ds_t restored;
+            std::stringstream in(s);
+            restored.restore(in);
+        } catch(const std::runtime_error&) {
+            from_stream = true;
+        }
+        return from_memory && from_stream;
+    };
+
+    std::string bad_magic = data;
+    bad_magic[0] = 'X';
+    ASSERT_TRUE(rejects(bad_magic));
+
+    std::string bad_version = data;
+    bad_version[4] = char(0xFF);
+    ASSERT_TRUE(rejects(bad_version));
+
+    ASSERT_TRUE(rejects(data.substr(0, data.size() - 1)));
+    ASSERT_TRUE(rejects(data.substr(0, 8)));
+    ASSERT_FALSE(rejects(data));
+
+    // a header claiming more keys than the size can hold, such that computing their size in bytes overflows
+    std::string huge = data.substr(0, sizeof(tdc::pred::dynamic::snapshot::Header) + 8);
+    const uint64_t huge_num = (1ULL << 61) + 1;
+    std::memcpy(huge.data() + 8, &huge_num, sizeof(huge_num));
+    ASSERT_TRUE(rejects(huge));
+
+    // keys that are not strictly ascending
+    {
+        constexpr size_t header_size = sizeof(tdc::pred::dynamic::snapshot::Header);
+
+        std::string swapped = data;
+        std::swap_ranges(swapped.begin() + header_size, swapped.begin() + header_size + sizeof(Key), swapped.begin() + header_size + sizeof(Key));
+        ASSERT_TRUE(rejects(swapped));
+
+        std::string duplicate = data;
+        std::copy(data.begin() + header_size, data.begin() + header_size + sizeof(Key), duplicate.begin() + header_size + sizeof(Key));
+        ASSERT_TRUE(rejects(duplicate));
+
+        // a duplicate across the blocks in which streams are read
+        const size_t num = (1ULL << 16) + 1;
+        std::vector<Key> keys(num);
+        for(size_t i = 0; i < num; i++) keys[i] = i + 1;
+        keys[num - 1] = keys[num - 2];
+
+        std::stringstream out;
+        tdc::pred::dynamic::snapshot::write_header<Key>(out, num);
+        out.write((const char*)keys.data(), num * sizeof(Key));
+        ASSERT_TRUE(rejects(out.str()));
+    }
+
+    // the B-tree replaces its contents when restoring, the others must be empty
+    ds_t other;
+    other.insert(1);
+    if constexpr(requires(std::istream& in) { other.restore(in, 1.0); }) {
+        other.restore(data.data(), data.size());
+        ASSERT_TRUE(std::equal(other.begin(), other.end(), ds.begin(), ds.end()));
+    } else {
+        bool thrown = false;
+        try {
+            other.restore(data.data(), data.size());
+        } catch(const std::logic_error&) {
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown);
+    }
+}
+
+int main(int argc, char** argv) {
+    using namespace tdc::pred::dynamic;
+
+    using btree_t = BTree<Key, 65, SortedArrayNode<Key, 64>>;
+    using fusion_btree_t = BTree<Key, 9, DynamicFusionNode<Key, 8>>;
+    using yfast_t = YFastTrie<yfast_bucket<Key, 4>, 64>;
+    using yfast_sl_t = YFastTrie<yfast_bucket_sl<Key, 4>, 64, xfast_compact_table>;
+    using index_t = DynIndex<Key, 12, bucket_hybrid<Key, 12, 63>>;
+    using index_paged_t = DynIndex<Key, 10, bucket_list<Key, 10>, paged_top<bucket_list<Key, 10>, 4>>;
+
+    for(const Key u : { (1ULL << 24) - 1, (1ULL << 32) - 1 }) {
+        for(const size_t num : { 0, 1, 10, 1000, 100000 }) {
+            test<btree_t>(u, num);
+            test<fusion_btree_t>(u, num);
+            test<yfast_t>(u, num);
+            test<yfast_sl_t>(u, num);
+            test<index_paged_t>(u, num);
+            if(u < (1ULL << 24)) test<index_t>(u, num); // the dense top directory spans the universe
+        }
+    }
+
+    test_invalid<btree_t>();
+    test_invalid<yfast_t>();
+    test_invalid<index_t>();
+}
@@ -1,46 +1,98 @@
 #include <iostream>
+#include <random>
+#include <vector>
 
 #include <tdc/hash/rolling.hpp>
 #include <tdc/test/assert.hpp>
 
-using RollingHash = tdc::hash::RollingKarpRabinFingerprint<unsigned char>;
+using RollingHash = tdc::hash::RollingKarpRabinFingerprint;
+using MultiWindowHash = tdc::hash::MultiWindowKarpRabinFingerprint;
+
+constexpr uint64_t BASE = 0x1234567;
 
 void test(const size_t w) {
     assert(w % 2 == 0); // must be even for this test
     std::cout << "test w=" << w << std::endl;
     
     // create RH for w symbols
-    RollingHash h(w);
+    RollingHash h(w, BASE);
+    uint64_t fp = 0;
 
     // insert w symbols
     for(size_t i = 0; i < w; i++) {
-        h.advance('a' + i, 0);
+        fp = h.roll(fp, 0, 'a' + i);
     }
     
     // save fingerprint
-    const auto first = h.fingerprint();
+    const auto first = fp;
     std::cout << "\tfirst=" << first << std::endl;
 
     // insert w/2 first symbols again
     for(size_t i = 0; i < w/2; i++) {
-        h.advance('a' + i, 'a' + i);
+        fp = h.roll(fp, 'a' + i, 'a' + i);
     }
-    ASSERT_NEQ(first, h.fingerprint());
+    ASSERT_NEQ(first, fp);
 
     // insert next w/2 symbols again
     for(size_t i = 0; i < w/2; i++) {
-        h.advance('a' + w/2 + i, 'a' + w/2 + i);
+        fp = h.roll(fp, 'a' + w/2 + i, 'a' + w/2 + i);
     }
-    std::cout << "\th1=" << h.fingerprint() << std::endl;
-    ASSERT_EQ(first, h.fingerprint());
+    std::cout << "\th1=" << fp << std::endl;
+    ASSERT_EQ(first, fp);
 
     // insert symbols into a new instance
-    RollingHash h2(w);
+    RollingHash h2(w, BASE);
+    uint64_t fp2 = 0;
     for(size_t i = 0; i < w; i++) {
-        h2.advance('a' + i, 0);
+        fp2 = h2.roll(fp2, 0, 'a' + i);
+    }
+    std::cout << "\th2=" << fp2 << std::endl;
+    ASSERT_EQ(fp, fp2);
+}
+
+// rolls windows of the given sizes over a random text, comparing block rolling and multiple windows against single rolls
+template<typename char_t = unsigned char>
+void test_block(const std::vector<uint64_t>& windows, const size_t n) {
+    std::mt19937_64 gen(n);
+    std::vector<char_t> text(n);
+    for(auto& c : text) c = (char_t)gen();
+
+    // the characters leaving the windows, which are zero for the first characters
+    auto out = [&](const uint64_t w, const size_t i){ return (i >= w) ? text[i - w] : (char_t)0; };
+
+    std::vector<std::vector<uint64_t>> multi_fps(windows.size(), std::vector<uint64_t>(n));
+    std::vector<uint64_t*> multi_out;
+    for(auto& v : multi_fps) multi_out.push_back(v.data());
+
+    // feed the text to the multi-window fingerprint in chunks of varying sizes
+    MultiWindowHash multi(windows, BASE);
+    for(size_t i = 0; i < n;) {
+        const size_t len = std::min(n - i, size_t(gen() % 50));
+        std::vector<uint64_t*> chunk_out;
+        for(auto* p : multi_out) chunk_out.push_back(p + i);
+        multi.roll_block(text.data() + i, len, chunk_out.data());
+        i += len;
+    }
+
+    for(size_t l = 0; l < windows.size(); l++) {
+        const uint64_t w = windows[l];
+        RollingHash h(w, BASE);
+
+        std::vector<char_t> pop(n);
+        for(size_t i = 0; i < n; i++) pop[i] = out(w, i);
+
+        std::vector<uint64_t> block_fps(n);
+        const uint64_t last = h.roll_block(uint64_t(0), pop.data(), text.data(), n, block_fps.data());
+
+        uint64_t fp = 0;
+        for(size_t i = 0; i < n; i++) {
+            fp = h.roll(fp, pop[i], text[i]);
+            ASSERT_EQ(block_fps[i], fp);
+            ASSERT_EQ(multi_fps[l][i], fp);
+        }
+        ASSERT_EQ(last, fp);
+        ASSERT_EQ(multi.fingerprint(l), fp);
     }
-    std::cout << "\th2=" << h2.fingerprint() << std::endl;
-    ASSERT_EQ(h.fingerprint(), h2.fingerprint());
 }
 
 int main(int argc, char** argv) {
@@ -49,4 +101,10 @@ int main(int argc, char** argv) {
     test(32);
     test(64);
     test(128);
+
+    test_block({ 1 }, 100);
+    test_block({ 8 }, 7);
+    test_block({ 64, 32, 16, 8, 4 }, 10000);
+    test_block({ 1000, 3, 17 }, 5000);
+    test_block<uint32_t>({ 100, 7 }, 5000);
 }
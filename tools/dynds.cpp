@@ -31,6 +31,8 @@ struct {
     double p_base = 0.3;
     double p_range = 0.5;
     double p_query = 0.9;
+    double p_range_query = 0.0;
+    size_t range_keys = 100;
     double hold = 0.25;
     bool hold_query_only = false;
     std::string distr = "uniform";
@@ -50,10 +52,11 @@ struct {
     size_t count_insert = 0;
     size_t count_delete = 0;
     size_t count_query = 0;
+    size_t count_range = 0;
     size_t failed_inserts = 0;
     
     inline size_t count_total() const {
-        return count_insert + count_delete + count_query;
+        return count_insert + count_delete + count_query + count_range;
     }
 } stats;
 
@@ -131,6 +134,23 @@ void generate(const key_t& u, mpf::random::Engine& gen_val, key_distribution_t&&
         return (key_t)random_range(gen_val);
     };
     
+    auto generate_range = [&](benchmark::IntegerOperationBatch<key_t>& batch){
+        assert(cur_num > 0);
+        ++stats.count_range;
+        
+        mpf::random::UniformDistribution<KEY_BITS> random_range(cur_min, cur_max);
+        const key_t lo = (key_t)random_range(gen_val);
+        
+        // choose the width so that the range covers the desired number of keys on average
+        const key_t width = (options.range_keys >= cur_num)
+            ? cur_max - cur_min
+            : (cur_max - cur_min) / key_t(cur_num) * key_t(options.range_keys);
+        const key_t hi = (u - lo < width) ? u : lo + width;
+        
+        batch.add_key(key_t(lo));
+        batch.add_key(key_t(hi));
+    };
+    
     auto generate_delete = [&](){
         assert(cur_num > 0);
         ++stats.count_delete;
@@ -166,12 +186,21 @@ void generate(const key_t& u, mpf::random::Engine& gen_val, key_distribution_t&&
         return generate_batch<key_t>(benchmark::OPCODE_DELETE, generate_delete);
     };
     
+    auto generate_range_batch = [&](){
+        benchmark::IntegerOperationBatch<key_t> batch(benchmark::OPCODE_RANGE, 2 * options.batch);
+        for(size_t i = 0; i < options.batch; i++) {
+            generate_range(batch);
+        }
+        return batch;
+    };
+    
     auto generate_and_output = [&](const benchmark::opcode_t opcode){
         if(options.simulate) {
             switch(opcode) {
                 case benchmark::OPCODE_INSERT: cur_num += options.batch; stats.count_insert += options.batch; break;
                 case benchmark::OPCODE_QUERY: stats.count_query += options.batch; break;
                 case benchmark::OPCODE_DELETE: cur_num -= options.batch; stats.count_delete += options.batch; break;
+                case benchmark::OPCODE_RANGE: stats.count_range += options.batch; break;
                 default: std::abort(); break;
             }
         } else {
@@ -179,6 +208,7 @@ void generate(const key_t& u, mpf::random::Engine& gen_val, key_distribution_t&&
                 case benchmark::OPCODE_INSERT: output_batch(out, generate_insert_batch()); break;
                 case benchmark::OPCODE_QUERY: output_batch(out, generate_query_batch()); break;
                 case benchmark::OPCODE_DELETE: output_batch(out, generate_delete_batch()); break;
+                case benchmark::OPCODE_RANGE: output_batch(out, generate_range_batch()); break;
                 default: std::abort(); break;
             }
         }
@@ -193,7 +223,12 @@ void generate(const key_t& u, mpf::random::Engine& gen_val, key_distribution_t&&
     };
 
     auto output_query_batch = [&](){
-        generate_and_output(benchmark::OPCODE_QUERY);
+        // only draw if range queries are enabled, so that operation sequences remain the same otherwise
+        if(options.p_range_query > 0 && random_op(gen_op) < options.p_range_query) {
+            generate_and_output(benchmark::OPCODE_RANGE);
+        } else {
+            generate_and_output(benchmark::OPCODE_QUERY);
+        }
     };
 
     auto output_delete_batch = [&](){
@@ -272,8 +307,9 @@ void generate(const key_t& u, mpf::random::Engine& gen_val, key_distribution_t&&
         << options.op_seed << ", "
         << stats.failed_inserts << " duplicates prevented): "
         << stats.count_insert << " inserts, "
-        << stats.count_delete << " deletes and "
-        << stats.count_query << " queries"
+        << stats.count_delete << " deletes, "
+        << stats.count_query << " queries and "
+        << stats.count_range << " range queries"
         << std::endl;
 
     // clean up
@@ -313,6 +349,8 @@ int main(int argc, char** argv) {
     cp.add_double('p', "p-base", options.p_base, "The base probability for inserts/deletes in the corresponding phase (default: 0.3)");
     cp.add_double('r', "p-range", options.p_range, "The probability range for inserts/deletes in the corresponding phase (default: 0.5)");
     cp.add_double('q', "p-query", options.p_query, "The probability for queries, if not the phase's primary operation (default: 0.9)");
+    cp.add_double("p-range-query", options.p_range_query, "The probability for a query batch to consist of range queries (default: 0)");
+    cp.add_size_t("range-keys", options.range_keys, "The expected number of keys covered by a range query (default: 100)");
     cp.add_string('d', "distribution", options.distr, "The distribution of inserted keys in the universe -- 'uniform' or 'normal' (default: uniform)");
     cp.add_size_t("mean", options.n_mean, "The mean for a normal distribution will be U/mean (default: 2)");
     cp.add_size_t("stddev", options.n_stddev, "The standard deviation for a normal distribution will be U/stddev (default: 8)");
@@ -339,6 +377,11 @@ int main(int argc, char** argv) {
         std::cerr << "p_query must be less than one" << std::endl;
         return -4;
     }
+    
+    if(options.p_range_query > 1) {
+        std::cerr << "p_range_query must be at most one" << std::endl;
+        return -4;
+    }
 
     if(options.universe <= 32) {
         return generate<uint32_t>();